@@ -0,0 +1,112 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "color_write_plan.hpp"
+#include "fixture.hpp"
+#include "fixture_batch.hpp"
+#include "precision_helpers.hpp"
+#include "triple_buffer.hpp"
+
+namespace lxmax
+{
+	/// @brief Fixture patched to a channel range which publishes its state through a triple buffer, as the Max objects do
+	///
+	template <typename State>
+	class bench_fixture : public fixture
+	{
+	protected:
+		triple_buffer<State> _state;
+		bool _is_batched { true };
+
+	public:
+		void patch(universe_address universe, int channel, int channel_count)
+		{
+			set_patch_info(fixture_patch_info("Bench Fixture", false, dmx_channel_range(universe, channel, channel_count)));
+		}
+
+		/// @brief Sets whether the fixture is written in a batch or through write_to_buffer, must be called before patch
+		void set_batched(bool is_batched)
+		{
+			_is_batched = is_batched;
+		}
+	};
+
+	/// @brief 16-bit dimmer
+	///
+	class bench_dimmer : public bench_fixture<double>
+	{
+	public:
+		static const int k_channel_count = 2;
+
+		void set_value(double value)
+		{
+			_state.write_buffer() = value;
+			_state.publish();
+			set_updated();
+		}
+
+		bool write_to_buffer(const fixture_patch_info& patch_info, universe_buffer_map& buffer_map,
+		                     universe_updated_list& updated_universes, bool is_force) override
+		{
+			return write_universe_fixture(*this, patch_info, buffer_map, updated_universes, is_force);
+		}
+
+		fixture_batch_writer batch_writer() const override
+		{
+			return _is_batched ? &write_universe_fixture_batch<bench_dimmer> : nullptr;
+		}
+
+		void write_to_universe(const fixture_patch_info& patch_info, universe_buffer& buffer)
+		{
+			clear_updated();
+			_state.update();
+
+			write_with_precision_ltp(_state.read_buffer(), 1., &buffer[patch_info.channel_range.start_local()], value_precision::_16bit);
+		}
+	};
+
+	struct bench_color_state
+	{
+		color_processor processor;
+		color_write_plan write_plan { color_personality_presets::k_rgb };
+	};
+
+	/// @brief 8-bit RGB fixture written through a color write plan
+	///
+	class bench_color_fixture : public bench_fixture<bench_color_state>
+	{
+	public:
+		static const int k_channel_count = 3;
+
+		void set_rgb(double r, double g, double b)
+		{
+			_state.write_buffer().processor.set_rgb(r, g, b);
+			_state.publish();
+			set_updated();
+		}
+
+		bool write_to_buffer(const fixture_patch_info& patch_info, universe_buffer_map& buffer_map,
+		                     universe_updated_list& updated_universes, bool is_force) override
+		{
+			return write_universe_fixture(*this, patch_info, buffer_map, updated_universes, is_force);
+		}
+
+		fixture_batch_writer batch_writer() const override
+		{
+			return _is_batched ? &write_universe_fixture_batch<bench_color_fixture> : nullptr;
+		}
+
+		void write_to_universe(const fixture_patch_info& patch_info, universe_buffer& buffer)
+		{
+			clear_updated();
+			_state.update();
+
+			bench_color_state& state = _state.read_buffer();
+			state.write_plan.write(state.processor, 1., &buffer[patch_info.channel_range.start_local()], k_channel_count);
+		}
+	};
+}
@@ -0,0 +1,386 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <Poco/File.h>
+#include <Poco/JSON/Array.h>
+#include <Poco/JSON/Object.h>
+#include <Poco/Logger.h>
+#include <Poco/Path.h>
+
+#include "allocation_counter.hpp"
+#include "bench_fixtures.hpp"
+#include "dmx_output_service.hpp"
+#include "instrumented_mutex.hpp"
+
+using namespace lxmax;
+
+namespace
+{
+	struct bench_options
+	{
+		int dimmer_count { 1000 };
+		int color_count { 1000 };
+		int universe_count { 16 };
+		int compose_thread_count { 1 };
+		int compose_frames { 2000 };
+		double output_seconds { 5. };
+		dmx_protocol protocol { dmx_protocol::sacn };
+	};
+
+	void print_usage()
+	{
+		std::cerr << "Usage: lxmax-bench [options]\n"
+			<< "  --dimmers N     number of 16-bit dimmers (default 1000)\n"
+			<< "  --colors N      number of RGB fixtures (default 1000)\n"
+			<< "  --universes N   number of universes to patch fixtures across (default 16)\n"
+			<< "  --threads N     number of threads to compose fixtures on (default 1)\n"
+			<< "  --frames N      number of frames to compose without output (default 2000)\n"
+			<< "  --seconds S     time to run the output service for (default 5)\n"
+			<< "  --protocol P    sacn or artnet (default sacn)\n"
+			<< "Results are written to stdout as JSON." << std::endl;
+	}
+
+	bool parse_options(int argc, char** argv, bench_options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string name = argv[i];
+
+			if (i + 1 >= argc)
+				return false;
+
+			const std::string value = argv[++i];
+
+			try
+			{
+				if (name == "--dimmers")
+					options.dimmer_count = std::stoi(value);
+				else if (name == "--colors")
+					options.color_count = std::stoi(value);
+				else if (name == "--universes")
+					options.universe_count = std::stoi(value);
+				else if (name == "--threads")
+					options.compose_thread_count = std::stoi(value);
+				else if (name == "--frames")
+					options.compose_frames = std::stoi(value);
+				else if (name == "--seconds")
+					options.output_seconds = std::stod(value);
+				else if (name == "--protocol" && (value == "sacn" || value == "artnet"))
+					options.protocol = value == "artnet" ? dmx_protocol::artnet : dmx_protocol::sacn;
+				else
+					return false;
+			}
+			catch (const std::exception&)
+			{
+				return false;
+			}
+		}
+
+		return options.dimmer_count >= 0 && options.color_count >= 0 && options.universe_count > 0
+			&& options.compose_thread_count > 0 && options.compose_frames > 0 && options.output_seconds > 0;
+	}
+
+	double to_microseconds(clock::duration d)
+	{
+		return std::chrono::duration<double, std::micro>(d).count();
+	}
+
+	/// @brief Gets the mean and percentiles of a set of frame times in microseconds
+	Poco::JSON::Object::Ptr summarize(std::vector<clock::duration> times)
+	{
+		Poco::JSON::Object::Ptr summary = new Poco::JSON::Object(Poco::JSON_PRESERVE_KEY_ORDER);
+
+		std::sort(std::begin(times), std::end(times));
+
+		clock::duration total { 0 };
+		for (const auto& t : times)
+			total += t;
+
+		const auto percentile = [&](double p) { return to_microseconds(times[static_cast<size_t>(p * (times.size() - 1))]); };
+
+		summary->set("mean_us", to_microseconds(total) / times.size());
+		summary->set("p50_us", percentile(0.5));
+		summary->set("p99_us", percentile(0.99));
+		summary->set("max_us", to_microseconds(times.back()));
+
+		return summary;
+	}
+
+	/// @brief Output service sending synthetic fixtures to loopback
+	///
+	class bench_rig
+	{
+		const std::string _preferences_path { Poco::Path::temp() + "lxmax-bench.json" };
+
+		std::shared_ptr<dmx_buffer_manager> _buffer_manager;
+		std::shared_ptr<lxmax::fixture_manager> _fixture_manager;
+		preferences_manager _preferences;
+
+		std::vector<std::unique_ptr<bench_dimmer>> _dimmers;
+		std::vector<std::unique_ptr<bench_color_fixture>> _colors;
+
+		std::vector<int> _next_channels;
+		size_t _next_universe_index { 0 };
+
+		template <typename T>
+		void add_fixtures(std::vector<std::unique_ptr<T>>& fixtures, int count)
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				auto f = std::make_unique<T>();
+				f->set_manager(_fixture_manager);
+
+				const auto patch = next_patch(T::k_channel_count);
+				f->patch(patch.first, patch.second, T::k_channel_count);
+
+				fixtures.push_back(std::move(f));
+			}
+		}
+
+		/// @brief Finds space for a fixture, spreading fixtures across universes in turn
+		std::pair<universe_address, int> next_patch(int channel_count)
+		{
+			for (size_t i = 0; i < _next_channels.size(); ++i)
+			{
+				const size_t index = _next_universe_index++ % _next_channels.size();
+				const int channel = _next_channels[index];
+
+				if (channel + channel_count - 1 > k_universe_length)
+					continue;
+
+				// Leave a gap between fixtures so none of them overlap
+				_next_channels[index] += channel_count + 1;
+
+				return { static_cast<universe_address>(index) + 1, channel };
+			}
+
+			throw std::runtime_error("Not enough universes to patch all fixtures");
+		}
+
+	public:
+		dmx_output_service output;
+
+		bench_rig(const bench_options& options, Poco::Logger& log)
+			: _buffer_manager(std::make_shared<dmx_buffer_manager>(log)),
+			_fixture_manager(std::make_shared<lxmax::fixture_manager>(log, _buffer_manager)),
+			_preferences(log, _preferences_path),
+			_next_channels(options.universe_count, 1),
+			output(log, _fixture_manager, _buffer_manager)
+		{
+			global_config config;
+			config.is_force_output_at_framerate = true;
+			config.is_artnet_global_destination_broadcast = false;
+			config.artnet_global_destination_unicast_addresses = { Poco::Net::IPAddress("127.0.0.1") };
+			config.is_send_artnet_sync_packets = false;
+			config.is_sacn_global_destination_multicast = false;
+			config.sacn_global_destination_unicast_addresses = { Poco::Net::IPAddress("127.0.0.1") };
+			config.compose_thread_count = options.compose_thread_count;
+			_preferences.set_global_config(config);
+
+			for (int u = 1; u <= options.universe_count; ++u)
+			{
+				auto universe = std::make_unique<dmx_output_universe_config>();
+				universe->protocol = options.protocol;
+				universe->internal_universe = u;
+				universe->protocol_universe = u;
+				_preferences.add_universe(u, std::move(universe));
+			}
+
+			_buffer_manager->update_universe_configs(&_preferences);
+			output.update_global_config(&_preferences);
+			output.update_universe_configs(&_preferences);
+
+			add_fixtures(_dimmers, options.dimmer_count);
+			add_fixtures(_colors, options.color_count);
+
+			// Publish the whole patch now rather than waiting for it to settle, so the first frames measured include it
+			_fixture_manager->flush_registrations();
+		}
+
+		~bench_rig()
+		{
+			output.stop();
+
+			// Fixtures unregister from the manager, so must go before it
+			_dimmers.clear();
+			_colors.clear();
+
+			Poco::File(_preferences_path).remove();
+		}
+
+		fixture_manager& manager()
+		{
+			return *_fixture_manager;
+		}
+
+		/// @brief Gives every fixture a new value, as a patch driving all fixtures from a metro would
+		void update_fixtures(int frame)
+		{
+			for (size_t i = 0; i < _dimmers.size(); ++i)
+				_dimmers[i]->set_value(static_cast<double>((frame + i) % 256) / 255.);
+
+			for (size_t i = 0; i < _colors.size(); ++i)
+			{
+				const double v = static_cast<double>((frame + i) % 256) / 255.;
+				_colors[i]->set_rgb(v, 1. - v, 0.5);
+			}
+		}
+	};
+
+	Poco::JSON::Object::Ptr run_compose_benchmark(bench_rig& rig, int frame_count)
+	{
+		std::vector<clock::duration> frame_times;
+		frame_times.reserve(frame_count);
+
+		uint64_t allocation_count = 0;
+		universe_updated_list updated_universes;
+
+		for (int f = 0; f < frame_count; ++f)
+		{
+			rig.update_fixtures(f);
+
+			const uint64_t allocations_before = get_allocation_count();
+			const auto start = clock::now();
+
+			rig.manager().write_to_buffer(updated_universes, false);
+
+			frame_times.push_back(clock::now() - start);
+			allocation_count += get_allocation_count() - allocations_before;
+		}
+
+		Poco::JSON::Object::Ptr result = summarize(frame_times);
+		result->set("frames", frame_count);
+		result->set("allocations_per_frame", static_cast<double>(allocation_count) / frame_count);
+
+		return result;
+	}
+
+	Poco::JSON::Object::Ptr run_output_benchmark(bench_rig& rig, double seconds)
+	{
+		std::atomic<bool> is_running { true };
+
+		const uint64_t allocations_before = get_allocation_count();
+		const auto start = clock::now();
+
+		rig.output.start();
+
+		// Updates every fixture once per DMX frame
+		std::thread driver_thread([&]()
+		{
+			const auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1. / k_dmx_framerate_max));
+			auto next_update = clock::now();
+
+			for (int frame = 0; is_running; ++frame)
+			{
+				rig.update_fixtures(frame);
+
+				next_update += period;
+				std::this_thread::sleep_until(next_update);
+			}
+		});
+
+		std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+
+		is_running = false;
+		driver_thread.join();
+		rig.output.stop();
+
+		const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+		const uint64_t allocation_count = get_allocation_count() - allocations_before;
+		const dmx_output_stats stats = rig.output.get_stats();
+
+		const double frames = std::max<double>(1, static_cast<double>(stats.frames_sent));
+
+		Poco::JSON::Object::Ptr result = new Poco::JSON::Object(Poco::JSON_PRESERVE_KEY_ORDER);
+		result->set("seconds", elapsed);
+		result->set("frames", stats.frames_sent);
+		result->set("packets", stats.packets_sent);
+		result->set("packets_per_second", stats.packets_sent / elapsed);
+		result->set("send_errors", stats.send_errors);
+		result->set("mean_compose_us", stats.compose_nanoseconds / frames / 1000.);
+		result->set("mean_send_us", stats.send_nanoseconds / frames / 1000.);
+		result->set("allocations_per_frame", allocation_count / frames);
+
+		return result;
+	}
+
+	/// @brief Gets the counters for each service mutex, which are only recorded when built with lock stats enabled
+	Poco::JSON::Object::Ptr get_lock_stats_json()
+	{
+		const auto histogram_to_json = [](const lock_histogram& histogram)
+		{
+			Poco::JSON::Array::Ptr array = new Poco::JSON::Array();
+			for (const auto count : histogram)
+				array->add(count);
+
+			return array;
+		};
+
+		Poco::JSON::Object::Ptr locks = new Poco::JSON::Object(Poco::JSON_PRESERVE_KEY_ORDER);
+
+		for (const auto& s : get_all_lock_stats())
+		{
+			Poco::JSON::Object::Ptr lock = new Poco::JSON::Object(Poco::JSON_PRESERVE_KEY_ORDER);
+			lock->set("acquisitions", s.acquisitions);
+			lock->set("contended_acquisitions", s.contended_acquisitions);
+			lock->set("mean_wait_ns", s.acquisitions > 0 ? static_cast<double>(s.wait_nanoseconds) / s.acquisitions : 0.);
+			lock->set("mean_hold_ns", s.acquisitions > 0 ? static_cast<double>(s.hold_nanoseconds) / s.acquisitions : 0.);
+			lock->set("wait_histogram", histogram_to_json(s.wait_histogram));
+			lock->set("hold_histogram", histogram_to_json(s.hold_histogram));
+
+			locks->set(s.name, lock);
+		}
+
+		return locks;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bench_options options;
+
+	if (!parse_options(argc, argv, options))
+	{
+		print_usage();
+		return 1;
+	}
+
+	Poco::Logger& log = Poco::Logger::get("LXMax Bench");
+
+	try
+	{
+		bench_rig rig(options, log);
+
+		Poco::JSON::Object::Ptr config = new Poco::JSON::Object(Poco::JSON_PRESERVE_KEY_ORDER);
+		config->set("dimmers", options.dimmer_count);
+		config->set("color_fixtures", options.color_count);
+		config->set("universes", options.universe_count);
+		config->set("compose_threads", options.compose_thread_count);
+		config->set("protocol", dmx_protocol_to_string(options.protocol));
+
+		Poco::JSON::Object result(Poco::JSON_PRESERVE_KEY_ORDER);
+		result.set("config", config);
+		result.set("compose", run_compose_benchmark(rig, options.compose_frames));
+		result.set("output", run_output_benchmark(rig, options.output_seconds));
+		result.set("locks", get_lock_stats_json());
+
+		result.stringify(std::cout, 2);
+		std::cout << std::endl;
+	}
+	catch (const std::exception& ex)
+	{
+		std::cerr << "lxmax-bench: " << ex.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,481 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <Poco/File.h>
+#include <Poco/JSON/Array.h>
+#include <Poco/JSON/Object.h>
+#include <Poco/Logger.h>
+#include <Poco/Path.h>
+#include <Poco/UUIDGenerator.h>
+
+#include "bench_fixtures.hpp"
+#include "color_personality.hpp"
+#include "color_processor.hpp"
+#include "dmx_buffer_manager.hpp"
+#include "dmx_channel_range.hpp"
+#include "dmx_packet_artnet.hpp"
+#include "dmx_packet_sacn.hpp"
+#include "fixture_manager.hpp"
+#include "microbench.hpp"
+#include "precision_helpers.hpp"
+#include "preferences_manager.hpp"
+
+using namespace lxmax;
+
+namespace
+{
+	universe_buffer make_test_universe()
+	{
+		universe_buffer buffer;
+
+		for (size_t i = 0; i < buffer.size(); ++i)
+			buffer[i] = static_cast<dmx_value>(i * 7);
+
+		return buffer;
+	}
+
+	void add_packet_benchmarks(std::vector<microbenchmark>& benchmarks)
+	{
+		const universe_buffer data = make_test_universe();
+		const Poco::UUID system_id = Poco::UUIDGenerator::defaultGenerator().createRandom();
+
+		const dmx_packet_artnet artnet_packet(1, 1, data);
+		const dmx_packet_sacn sacn_packet(system_id, "LXMax Bench", 100, 0, 1, sacn_options_flags::none, 1, data);
+
+		benchmarks.push_back({ "dmx_packet_artnet::serialize", 3000, [=](uint64_t iterations)
+		{
+			for (uint64_t i = 0; i < iterations; ++i)
+				do_not_optimize(artnet_packet.serialize());
+		}});
+
+		benchmarks.push_back({ "dmx_packet_sacn::serialize", 3000, [=](uint64_t iterations)
+		{
+			for (uint64_t i = 0; i < iterations; ++i)
+				do_not_optimize(sacn_packet.serialize());
+		}});
+
+		benchmarks.push_back({ "dmx_packet_artnet::deserialize", 3000, [=](uint64_t iterations)
+		{
+			std::vector<char> buffer = artnet_packet.serialize();
+			dmx_packet_artnet packet;
+
+			for (uint64_t i = 0; i < iterations; ++i)
+				do_not_optimize(dmx_packet_artnet::deserialize(buffer.data(), buffer.size(), packet));
+		}});
+
+		benchmarks.push_back({ "dmx_packet_sacn::deserialize", 3000, [=](uint64_t iterations)
+		{
+			std::vector<char> buffer = sacn_packet.serialize();
+			dmx_packet_sacn packet = sacn_packet;
+
+			for (uint64_t i = 0; i < iterations; ++i)
+				do_not_optimize(dmx_packet_sacn::deserialize(buffer.data(), buffer.size(), packet));
+		}});
+	}
+
+	void add_precision_benchmarks(std::vector<microbenchmark>& benchmarks)
+	{
+		for (int p = 0; p < static_cast<int>(value_precision::enum_count); ++p)
+		{
+			const auto precision = static_cast<value_precision>(p);
+			const std::string name = precision_helper::to_string(precision);
+
+			// Each operation writes a whole universe's worth of values
+			benchmarks.push_back({ "write_with_precision_ltp " + name, 20000, [=](uint64_t iterations)
+			{
+				const int width = precision_helper::get_width(precision);
+				universe_buffer buffer { };
+
+				for (uint64_t i = 0; i < iterations; ++i)
+				{
+					for (int c = 0; c + width <= k_universe_length; c += width)
+						write_with_precision_ltp(static_cast<double>((i + c) & 0xFF), 255., &buffer[c], precision);
+
+					do_not_optimize(buffer);
+				}
+			}});
+
+			benchmarks.push_back({ "write_with_precision_htp " + name, 20000, [=](uint64_t iterations)
+			{
+				const int width = precision_helper::get_width(precision);
+				universe_buffer buffer { };
+
+				for (uint64_t i = 0; i < iterations; ++i)
+				{
+					for (int c = 0; c + width <= k_universe_length; c += width)
+						write_with_precision_htp(static_cast<double>((i + c) & 0xFF), 255., &buffer[c], precision);
+
+					do_not_optimize(buffer);
+				}
+			}});
+		}
+	}
+
+	void add_channel_range_benchmarks(std::vector<microbenchmark>& benchmarks)
+	{
+		// A large patch of 4 channel fixtures over 100 universes, every pair checked as when updating overlaps
+		std::vector<dmx_channel_range> ranges;
+		for (int u = 1; u <= 100; ++u)
+		{
+			for (int c = 1; c + 3 <= k_universe_length; c += 20)
+				ranges.emplace_back(u, c, 4);
+		}
+
+		benchmarks.push_back({ "dmx_channel_range::is_overlapping_with " + std::to_string(ranges.size()) + " fixtures",
+			50e6, [=](uint64_t iterations)
+		{
+			for (uint64_t i = 0; i < iterations; ++i)
+			{
+				size_t overlap_count = 0;
+
+				for (const auto& a : ranges)
+				{
+					for (const auto& b : ranges)
+						overlap_count += a.is_overlapping_with(b) ? 1 : 0;
+				}
+
+				do_not_optimize(overlap_count);
+			}
+		}});
+	}
+
+	void add_color_benchmarks(std::vector<microbenchmark>& benchmarks)
+	{
+		std::mt19937 generator(1234);
+		std::uniform_real_distribution<double> distribution(0., 1.);
+
+		std::vector<double> inputs(3 * 1024);
+		for (auto& v : inputs)
+			v = distribution(generator);
+
+		const auto add_conversion = [&](const std::string& name, auto&& convert)
+		{
+			benchmarks.push_back({ "color_processor " + name, 250, [=](uint64_t iterations)
+			{
+				color_processor processor;
+
+				for (uint64_t i = 0; i < iterations; ++i)
+				{
+					const size_t index = 3 * (i & 1023);
+					do_not_optimize(convert(processor, inputs[index], inputs[index + 1], inputs[index + 2]));
+				}
+			}});
+		};
+
+		add_conversion("rgb to hsb", [](color_processor& p, double a, double b, double c) { p.set_rgb(a, b, c); return p.get_hsb(); });
+		add_conversion("hsb to rgb", [](color_processor& p, double a, double b, double c) { p.set_hsb(a, b, c); return p.get_rgb(); });
+		add_conversion("rgb to cmy", [](color_processor& p, double a, double b, double c) { p.set_rgb(a, b, c); return p.get_cmy(); });
+		add_conversion("cmy to rgb", [](color_processor& p, double a, double b, double c) { p.set_cmy(a, b, c); return p.get_rgb(); });
+		add_conversion("rgb to rgbw", [](color_processor& p, double a, double b, double c) { p.set_rgb(a, b, c); return p.get_emitters(emitter_set::rgbw); });
+	}
+
+	void add_personality_benchmarks(std::vector<microbenchmark>& benchmarks)
+	{
+		benchmarks.push_back({ "color_personality_element::from_string", 50000, [](uint64_t iterations)
+		{
+			const std::string strings[] = { "R", "G16", "B16!", "Br", "F{200}", "F16{1000}", "_" };
+			color_personality_element element;
+
+			for (uint64_t i = 0; i < iterations; ++i)
+				do_not_optimize(color_personality_element::from_string(strings[i % 7], element));
+		}});
+	}
+
+	struct patch_load_state
+	{
+		std::shared_ptr<fixture_manager> manager;
+		std::vector<std::unique_ptr<bench_dimmer>> fixtures;
+	};
+
+	void add_fixture_registration_benchmarks(std::vector<microbenchmark>& benchmarks)
+	{
+		const int fixture_count = 2000;
+
+		// Opening a patch sets each fixture's universe, channel and other attributes one at a time
+		const int registrations_per_fixture = 5;
+
+		const auto add_patch_load = [&](const std::string& name, double threshold_ns, bool is_flushed_every_registration)
+		{
+			const auto state = std::make_shared<patch_load_state>();
+
+			microbenchmark benchmark { "fixture_manager patch load " + name + " " + std::to_string(fixture_count) + " fixtures",
+				threshold_ns, [=](uint64_t iterations)
+			{
+				fixture_manager& manager = *state->manager;
+
+				for (uint64_t i = 0; i < iterations; ++i)
+				{
+					for (int f = 0; f < fixture_count; ++f)
+					{
+						for (int r = 0; r < registrations_per_fixture; ++r)
+						{
+							// Offset alternate loads so every registration changes the fixture's patch
+							const int channel = 1 + ((f + r + static_cast<int>(i & 1)) % 256) * bench_dimmer::k_channel_count;
+							state->fixtures[f]->patch(1 + f / 256, channel, bench_dimmer::k_channel_count);
+
+							if (is_flushed_every_registration)
+								manager.flush_registrations();
+						}
+					}
+
+					manager.flush_registrations();
+					do_not_optimize(manager.get_patched_channel_count(1));
+				}
+			}};
+
+			benchmark.setup = [=]()
+			{
+				Poco::Logger& log = Poco::Logger::get("LXMax Microbench");
+				state->manager = std::make_shared<fixture_manager>(log, std::make_shared<dmx_buffer_manager>(log));
+
+				for (int i = 0; i < fixture_count; ++i)
+				{
+					state->fixtures.push_back(std::make_unique<bench_dimmer>());
+					state->fixtures.back()->set_manager(state->manager);
+				}
+			};
+
+			benchmark.teardown = [=]()
+			{
+				// Destroy the fixtures while the manager is still alive, as they unregister from it
+				state->fixtures.clear();
+				state->manager.reset();
+			};
+
+			benchmark.is_checked = !is_flushed_every_registration;
+
+			benchmarks.push_back(std::move(benchmark));
+		};
+
+		// The snapshot used by the output thread is rebuilt once the patch settles
+		add_patch_load("deferred", 10e6, false);
+
+		// Rebuilding the snapshot on every registration, as before registrations were deferred. Each load takes seconds,
+		// so this is only run without --check, as the number the deferred load is compared against.
+		add_patch_load("immediate", 20e9, true);
+	}
+
+	struct fixture_write_state
+	{
+		std::shared_ptr<dmx_buffer_manager> buffer_manager;
+		std::shared_ptr<fixture_manager> manager;
+		std::vector<std::unique_ptr<bench_color_fixture>> fixtures;
+		universe_updated_list updated_universes;
+	};
+
+	void add_fixture_write_benchmarks(std::vector<microbenchmark>& benchmarks)
+	{
+		const int universe_count = 4;
+
+		const auto add_patch = [&](const std::string& name, double threshold_ns, int channel_step, bool is_batched)
+		{
+			const int fixtures_per_universe = (k_universe_length - bench_color_fixture::k_channel_count) / channel_step + 1;
+
+			const auto state = std::make_shared<fixture_write_state>();
+
+			microbenchmark benchmark { "fixture_manager::write_to_buffer " + name + " "
+				+ std::to_string(universe_count * fixtures_per_universe) + " fixtures", threshold_ns, [=](uint64_t iterations)
+			{
+				std::vector<std::unique_ptr<bench_color_fixture>>& fixtures = state->fixtures;
+
+				for (uint64_t i = 0; i < iterations; ++i)
+				{
+					// Every fixture is updated each frame, in a different order each time
+					const double value = static_cast<double>(i & 0xFF) / 255.;
+					for (size_t f = 0; f < fixtures.size(); ++f)
+						fixtures[(f * 7 + i) % fixtures.size()]->set_rgb(value, value, value);
+
+					state->manager->write_to_buffer(state->updated_universes);
+					do_not_optimize(state->updated_universes);
+				}
+			}};
+
+			benchmark.setup = [=]()
+			{
+				Poco::Logger& log = Poco::Logger::get("LXMax Microbench");
+
+				const std::string preferences_path = Poco::Path::temp() + "lxmax-microbench-fixtures.json";
+
+				state->buffer_manager = std::make_shared<dmx_buffer_manager>(log);
+				{
+					preferences_manager preferences(log, preferences_path);
+
+					for (int u = 1; u <= universe_count; ++u)
+					{
+						auto universe = std::make_unique<dmx_output_universe_config>();
+						universe->internal_universe = u;
+						preferences.add_universe(u, std::move(universe));
+					}
+
+					state->buffer_manager->update_universe_configs(&preferences);
+				}
+
+				Poco::File(preferences_path).remove();
+
+				state->manager = std::make_shared<fixture_manager>(log, state->buffer_manager);
+
+				for (int u = 1; u <= universe_count; ++u)
+				{
+					for (int i = 0; i < fixtures_per_universe; ++i)
+					{
+						state->fixtures.push_back(std::make_unique<bench_color_fixture>());
+						state->fixtures.back()->set_batched(is_batched);
+						state->fixtures.back()->set_manager(state->manager);
+						state->fixtures.back()->patch(u, 1 + i * channel_step, bench_color_fixture::k_channel_count);
+					}
+				}
+
+				state->manager->flush_registrations();
+			};
+
+			benchmark.teardown = [=]()
+			{
+				state->fixtures.clear();
+				state->manager.reset();
+				state->buffer_manager.reset();
+			};
+
+			benchmarks.push_back(std::move(benchmark));
+		};
+
+		add_patch("separate", 500e3, bench_color_fixture::k_channel_count, true);
+
+		// The same patch written one fixture at a time through the virtual interface, as third-party fixture types are
+		add_patch("separate unbatched", 500e3, bench_color_fixture::k_channel_count, false);
+
+		// Every channel is shared by three fixtures
+		add_patch("dense overlapping", 2e6, 1, true);
+	}
+
+	const std::string k_preferences_path = Poco::Path::temp() + "lxmax-microbench-preferences.json";
+
+	void add_preferences_benchmarks(std::vector<microbenchmark>& benchmarks, int universe_count)
+	{
+		// Each add saves the file, so the config is only built if one of these benchmarks runs
+		auto preferences = std::make_shared<std::unique_ptr<preferences_manager>>();
+
+		const auto get_preferences = [=]() -> preferences_manager&
+		{
+			if (!*preferences)
+			{
+				*preferences = std::make_unique<preferences_manager>(Poco::Logger::get("LXMax Microbench"), k_preferences_path);
+
+				for (int u = 1; u <= universe_count; ++u)
+				{
+					auto universe = std::make_unique<dmx_output_universe_config>();
+					universe->internal_universe = u;
+					universe->protocol_universe = u;
+					(*preferences)->add_universe(u, std::move(universe));
+				}
+			}
+
+			return **preferences;
+		};
+
+		const std::string suffix = " " + std::to_string(universe_count) + " universes";
+
+		benchmarks.push_back({ "preferences_manager::save" + suffix, 2e9, [=](uint64_t iterations)
+		{
+			preferences_manager& p = get_preferences();
+
+			for (uint64_t i = 0; i < iterations; ++i)
+				p.save();
+		}});
+
+		benchmarks.push_back({ "preferences_manager::load" + suffix, 2e9, [=](uint64_t iterations)
+		{
+			preferences_manager& p = get_preferences();
+
+			for (uint64_t i = 0; i < iterations; ++i)
+				p.load();
+		}});
+	}
+
+	void print_usage()
+	{
+		std::cerr << "Usage: lxmax-microbench [--filter TEXT] [--check] [--universes N]\n"
+			<< "  --filter TEXT   only run benchmarks with names containing TEXT\n"
+			<< "  --check         exit with an error if any benchmark is slower than its threshold, skipping those\n"
+			<< "                  only kept for comparison\n"
+			<< "  --universes N   number of universes in the preferences benchmarks (default 2000)\n"
+			<< "Results are written to stdout as JSON." << std::endl;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string filter;
+	bool is_check = false;
+	int universe_count = 2000;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+
+		if (arg == "--check")
+			is_check = true;
+		else if (arg == "--filter" && i + 1 < argc)
+			filter = argv[++i];
+		else if (arg == "--universes" && i + 1 < argc)
+			universe_count = std::max(1, std::atoi(argv[++i]));
+		else
+		{
+			print_usage();
+			return 1;
+		}
+	}
+
+	std::vector<microbenchmark> benchmarks;
+	add_packet_benchmarks(benchmarks);
+	add_precision_benchmarks(benchmarks);
+	add_channel_range_benchmarks(benchmarks);
+	add_color_benchmarks(benchmarks);
+	add_personality_benchmarks(benchmarks);
+	add_fixture_registration_benchmarks(benchmarks);
+	add_preferences_benchmarks(benchmarks, universe_count);
+	add_fixture_write_benchmarks(benchmarks);
+
+	Poco::JSON::Array::Ptr results = new Poco::JSON::Array();
+	int regression_count = 0;
+
+	for (const auto& benchmark : benchmarks)
+	{
+		if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+			continue;
+
+		if (is_check && !benchmark.is_checked)
+			continue;
+
+		const microbenchmark_result result = measure(benchmark);
+
+		Poco::JSON::Object::Ptr entry = new Poco::JSON::Object(Poco::JSON_PRESERVE_KEY_ORDER);
+		entry->set("name", result.name);
+		entry->set("iterations", result.iterations);
+		entry->set("ns_per_op", result.ns_per_op);
+		entry->set("threshold_ns", result.threshold_ns);
+		entry->set("is_regression", result.is_regression());
+		results->add(entry);
+
+		if (result.is_regression())
+		{
+			++regression_count;
+			std::cerr << "Regression: " << result.name << " took " << result.ns_per_op << " ns/op, threshold is "
+				<< result.threshold_ns << " ns/op" << std::endl;
+		}
+	}
+
+	if (Poco::File(k_preferences_path).exists())
+		Poco::File(k_preferences_path).remove();
+
+	results->stringify(std::cout, 2);
+	std::cout << std::endl;
+
+	return is_check && regression_count > 0 ? 1 : 0;
+}
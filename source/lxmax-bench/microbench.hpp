@@ -0,0 +1,103 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace lxmax
+{
+	/// @brief Stops the compiler from optimizing away a value computed by a benchmark
+	template <typename T>
+	inline void do_not_optimize(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const T* sink;
+		sink = &value;
+#endif
+	}
+
+	/// @brief A benchmarked operation and the time per operation above which it counts as a regression
+	///
+	/// Thresholds are deliberately generous, several times the time measured on a typical show machine, so only
+	/// real regressions fail rather than noisy or slower hardware.
+	///
+	/// Benchmarks which need a patch or other state build it in setup and release it in teardown, which run before and
+	/// after every timed run so only run itself is measured.
+	struct microbenchmark
+	{
+		std::string name;
+		double threshold_ns;
+		std::function<void(uint64_t iterations)> run;
+		std::function<void()> setup;
+		std::function<void()> teardown;
+
+		/// @brief False for benchmarks only kept to compare against, which are skipped by --check
+		bool is_checked { true };
+	};
+
+	struct microbenchmark_result
+	{
+		std::string name;
+		uint64_t iterations;
+		double ns_per_op;
+		double threshold_ns;
+
+		bool is_regression() const
+		{
+			return ns_per_op > threshold_ns;
+		}
+	};
+
+	/// @brief Runs a benchmark for enough iterations to fill each sample, giving the fastest sample's time per operation
+	inline microbenchmark_result measure(const microbenchmark& benchmark,
+	                                     std::chrono::milliseconds sample_time = std::chrono::milliseconds(50),
+	                                     int sample_count = 5)
+	{
+		using bench_clock = std::chrono::steady_clock;
+
+		const auto time_iterations = [&](uint64_t iterations)
+		{
+			if (benchmark.setup)
+				benchmark.setup();
+
+			const auto start = bench_clock::now();
+			benchmark.run(iterations);
+			const auto elapsed = std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+
+			if (benchmark.teardown)
+				benchmark.teardown();
+
+			return elapsed;
+		};
+
+		// Double the iterations until a run is long enough to time accurately
+		uint64_t iterations = 1;
+		double elapsed = time_iterations(iterations);
+
+		while (elapsed < std::chrono::duration<double, std::nano>(sample_time).count() / 10 && iterations < (1ull << 40))
+		{
+			iterations *= 2;
+			elapsed = time_iterations(iterations);
+		}
+
+		iterations = std::max<uint64_t>(1, static_cast<uint64_t>(iterations
+			* std::chrono::duration<double, std::nano>(sample_time).count() / std::max(elapsed, 1.)));
+
+		double best = time_iterations(iterations);
+
+		for (int i = 1; i < sample_count; ++i)
+			best = std::min(best, time_iterations(iterations));
+
+		return { benchmark.name, iterations, best / iterations, benchmark.threshold_ns };
+	}
+}
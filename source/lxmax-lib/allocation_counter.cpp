@@ -0,0 +1,63 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "allocation_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<uint64_t> allocation_count { 0 };
+
+	void* counted_allocate(std::size_t size)
+	{
+		++allocation_count;
+
+		if (void* p = std::malloc(size == 0 ? 1 : size))
+			return p;
+
+		throw std::bad_alloc();
+	}
+}
+
+namespace lxmax
+{
+	uint64_t get_allocation_count()
+	{
+		return allocation_count;
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	return counted_allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return counted_allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
@@ -0,0 +1,17 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <cstdint>
+
+namespace lxmax
+{
+	/// @brief Gets the number of calls to global operator new made by any thread since the program started
+	///
+	/// Counted by replacement allocation functions in the lxmax-allocation-counter library, which only the benchmark
+	/// and test executables link.
+	uint64_t get_allocation_count();
+}
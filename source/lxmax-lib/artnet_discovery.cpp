@@ -0,0 +1,197 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "artnet_discovery.hpp"
+
+#include <algorithm>
+#include <Poco/Net/NetException.h>
+
+namespace lxmax
+{
+	void artnet_discovery::start(Poco::Net::DatagramSocket* socket, const Poco::Net::SocketAddress& poll_address)
+	{
+		stop();
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			_socket = socket;
+			_poll_address = poll_address;
+			_last_poll_time = timestamp::min();
+		}
+
+		_timer.start(Poco::TimerCallback<artnet_discovery>(*this, &artnet_discovery::on_timer));
+	}
+
+	void artnet_discovery::stop()
+	{
+		_timer.stop();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_socket = nullptr;
+		_nodes.clear();
+		update_subscribers();
+	}
+
+	void artnet_discovery::poll()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		send_poll();
+	}
+
+	artnet_node_map artnet_discovery::get_nodes() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		return _nodes;
+	}
+
+	std::vector<Poco::Net::IPAddress> artnet_discovery::get_subscribers(universe_address protocol_universe) const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		const auto it = _subscribers.find(protocol_universe);
+		if (it == std::end(_subscribers))
+			return { };
+
+		return it->second;
+	}
+
+	void artnet_discovery::on_timer(Poco::Timer& timer)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (!_socket)
+			return;
+
+		const auto time_now = clock::now();
+
+		if (_last_poll_time == timestamp::min() || time_now - _last_poll_time >= _poll_interval)
+			send_poll();
+
+		bool is_changed = receive_replies(time_now);
+		is_changed |= remove_expired_nodes(time_now);
+
+		if (is_changed)
+			update_subscribers();
+	}
+
+	void artnet_discovery::send_poll()
+	{
+		if (!_socket)
+			return;
+
+		const artpoll_packet packet;
+		const auto packet_buffer = packet.serialize();
+
+		try
+		{
+			_socket->sendTo(packet_buffer.data(), static_cast<int>(packet_buffer.size()), _poll_address);
+		}
+		catch (const Poco::Net::NetException& ex)
+		{
+			// TODO: Can't log to Max from this thread, implement a logging system based off a Max timer
+		}
+
+		_last_poll_time = clock::now();
+	}
+
+	bool artnet_discovery::receive_replies(timestamp time_now)
+	{
+		bool is_changed = false;
+
+		try
+		{
+			while (_socket->poll(Poco::Timespan(0), Poco::Net::Socket::SELECT_READ))
+			{
+				Poco::Net::SocketAddress sender;
+				const int length = _socket->receiveFrom(_receive_buffer.data(), static_cast<int>(_receive_buffer.size()), sender);
+
+				artpollreply_packet reply;
+				if (length <= 0 || !artpollreply_packet::deserialize(_receive_buffer.data(), length, reply))
+					continue;
+
+				Poco::Net::IPAddress address(reply.ip_address, sizeof(reply.ip_address));
+				if (address.isWildcard())
+					address = sender.host();
+
+				artnet_node node;
+				node.address = address;
+				node.bind_index = reply.bind_index;
+				node.short_name = std::string(reply.short_name, strnlen(reply.short_name, sizeof(reply.short_name)));
+				node.long_name = std::string(reply.long_name, strnlen(reply.long_name, sizeof(reply.long_name)));
+				node.last_seen = time_now;
+
+				for (int i = 0; i < 4; ++i)
+				{
+					if (reply.is_output_port(i))
+						node.output_universes.push_back(reply.port_address(i, true));
+				}
+
+				const artnet_node_key key { node.address, node.bind_index };
+				auto it = _nodes.find(key);
+
+				if (it == std::end(_nodes))
+				{
+					_nodes.emplace(key, std::move(node));
+					is_changed = true;
+				}
+				else
+				{
+					if (it->second.output_universes != node.output_universes)
+						is_changed = true;
+
+					it->second = std::move(node);
+				}
+			}
+		}
+		catch (const Poco::Net::NetException& ex)
+		{
+			// TODO: Can't log to Max from this thread, implement a logging system based off a Max timer
+		}
+
+		return is_changed;
+	}
+
+	bool artnet_discovery::remove_expired_nodes(timestamp time_now)
+	{
+		bool is_changed = false;
+
+		for (auto it = std::begin(_nodes); it != std::end(_nodes);)
+		{
+			if (time_now - it->second.last_seen > _node_timeout)
+			{
+				it = _nodes.erase(it);
+				is_changed = true;
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		return is_changed;
+	}
+
+	void artnet_discovery::update_subscribers()
+	{
+		_subscribers.clear();
+
+		for (const auto& entry : _nodes)
+		{
+			for (const universe_address u : entry.second.output_universes)
+			{
+				auto& addresses = _subscribers[u];
+
+				if (std::find(std::begin(addresses), std::end(addresses), entry.second.address) == std::end(addresses))
+					addresses.push_back(entry.second.address);
+			}
+		}
+
+		++_generation;
+	}
+}
@@ -0,0 +1,111 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <Poco/Logger.h>
+#include <Poco/Net/DatagramSocket.h>
+#include <Poco/Timer.h>
+
+#include "common.hpp"
+#include "dmx_packet_artnet.hpp"
+
+namespace lxmax
+{
+	/// @brief An Art-Net node found by polling the network
+	/// 
+	struct artnet_node
+	{
+		Poco::Net::IPAddress address;
+		uint8_t bind_index { 0 };
+		std::string short_name;
+		std::string long_name;
+		std::vector<universe_address> output_universes;
+		timestamp last_seen;
+	};
+
+	using artnet_node_key = std::pair<Poco::Net::IPAddress, uint8_t>;
+	using artnet_node_map = std::map<artnet_node_key, artnet_node>;
+
+	/// @brief Discovers Art-Net nodes using ArtPoll and keeps a table of which nodes subscribe to each Art-Net universe
+	/// 
+	class artnet_discovery
+	{
+		const milliseconds k_receive_interval { 100 };
+
+		Poco::Logger& _log;
+
+		const milliseconds _poll_interval;
+		const milliseconds _node_timeout;
+
+		Poco::Timer _timer;
+
+		mutable std::mutex _mutex;
+		Poco::Net::DatagramSocket* _socket { nullptr };
+		Poco::Net::SocketAddress _poll_address;
+		timestamp _last_poll_time { timestamp::min() };
+
+		artnet_node_map _nodes;
+		std::unordered_map<universe_address, std::vector<Poco::Net::IPAddress>> _subscribers;
+
+		std::atomic<uint64_t> _generation { 0 };
+
+		std::vector<char> _receive_buffer;
+
+	public:
+		artnet_discovery(Poco::Logger& log, milliseconds poll_interval = milliseconds(2500), milliseconds node_timeout = milliseconds(8000))
+			: _log(log),
+			_poll_interval(poll_interval),
+			_node_timeout(node_timeout),
+			_timer(0, static_cast<long>(k_receive_interval.count())),
+			_receive_buffer(1024)
+		{
+			
+		}
+
+		~artnet_discovery()
+		{
+			stop();
+		}
+
+		/// @brief Starts polling for nodes
+		/// @param socket Socket used to send polls and receive replies. Must remain valid until stop is called.
+		/// @param poll_address Address polls are sent to, normally the Art-Net broadcast address
+		void start(Poco::Net::DatagramSocket* socket, const Poco::Net::SocketAddress& poll_address);
+
+		void stop();
+
+		/// @brief Sends a poll immediately rather than waiting for the next poll interval
+		void poll();
+
+		/// @brief Counter which is incremented each time the subscriber table changes
+		uint64_t generation() const
+		{
+			return _generation;
+		}
+
+		artnet_node_map get_nodes() const;
+
+		/// @brief Gets the addresses of all nodes with an output port patched to an Art-Net universe
+		std::vector<Poco::Net::IPAddress> get_subscribers(universe_address protocol_universe) const;
+
+	private:
+		void on_timer(Poco::Timer& timer);
+
+		void send_poll();
+
+		bool receive_replies(timestamp time_now);
+
+		bool remove_expired_nodes(timestamp time_now);
+
+		void update_subscribers();
+	};
+}
@@ -0,0 +1,55 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "channel_image.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace lxmax
+{
+	void write_channel_image(const dmx_channel_range& range, const dmx_value* image, size_t image_size, bool is_htp,
+	                         universe_buffer_map& buffer_map, universe_updated_list& updated_universes)
+	{
+		const channel_address end = range.start() + std::min(range.channel_count(), static_cast<int>(image_size));
+
+		for (universe_address u = range.start_universe(); u * k_universe_length < end; ++u)
+		{
+			const auto it = buffer_map.find(u);
+			if (it == std::end(buffer_map))
+				continue;
+
+			const channel_address first = std::max(range.start(), u * k_universe_length);
+			const channel_address last = std::min(end, (u + 1) * k_universe_length);
+
+			const dmx_value* src = image + (first - range.start());
+			dmx_value* dst = it->second.data() + (first - u * k_universe_length);
+
+			if (is_htp)
+			{
+				for (int i = 0; i < last - first; ++i)
+					dst[i] = std::max(dst[i], src[i]);
+			}
+			else
+			{
+				std::memcpy(dst, src, last - first);
+			}
+
+			updated_universes.push_back(u);
+		}
+	}
+
+	void write_channel_image(const fixture_patch_info& patch_info, const dmx_value* image, size_t image_size,
+	                         universe_buffer_map& buffer_map, universe_updated_list& updated_universes)
+	{
+		patch_info.for_each_span([&](const dmx_channel_range& span)
+		{
+			const size_t offset = static_cast<size_t>(span.start() - patch_info.channel_range.start());
+
+			if (offset < image_size)
+				write_channel_image(span, image + offset, image_size - offset, patch_info.is_htp, buffer_map, updated_universes);
+		});
+	}
+}
@@ -0,0 +1,23 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "common.hpp"
+#include "dmx_channel_range.hpp"
+#include "fixture_patch_info.hpp"
+
+namespace lxmax
+{
+	/// @brief Copies an image of a channel range, which may span several universes, into the universe buffers
+	///
+	/// Each universe is written with a single memcpy, or a per channel maximum for HTP.
+	void write_channel_image(const dmx_channel_range& range, const dmx_value* image, size_t image_size, bool is_htp,
+	                         universe_buffer_map& buffer_map, universe_updated_list& updated_universes);
+
+	/// @brief Copies an image of a fixture's channel range into the buffers, only writing the channels in its spans
+	void write_channel_image(const fixture_patch_info& patch_info, const dmx_value* image, size_t image_size,
+	                         universe_buffer_map& buffer_map, universe_updated_list& updated_universes);
+}
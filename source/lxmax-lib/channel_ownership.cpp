@@ -0,0 +1,175 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "channel_ownership.hpp"
+
+#include <algorithm>
+
+namespace lxmax
+{
+	universe_ownership* channel_ownership::find_universe(universe_address universe)
+	{
+		if (universe == _last_universe)
+			return _last_owners;
+
+		const auto it = _universes.find(universe);
+		if (it == std::end(_universes))
+			return nullptr;
+
+		_last_universe = universe;
+		_last_owners = &it->second;
+
+		return _last_owners;
+	}
+
+	universe_ownership& channel_ownership::get_universe(universe_address universe)
+	{
+		if (universe != _last_universe)
+		{
+			_last_universe = universe;
+			_last_owners = &_universes[universe];
+		}
+
+		return *_last_owners;
+	}
+
+	void channel_ownership::reset()
+	{
+		for (auto& u : _universes)
+			u.second.fill(channel_owner());
+	}
+
+	void channel_ownership::clear_htp_channels(const dmx_channel_range& range, timestamp updated, universe_buffer_map& buffer_map)
+	{
+		for_each_universe(range, [&](universe_address u, local_channel_address first, local_channel_address last)
+		{
+			const auto buffer = buffer_map.find(u);
+			if (buffer == std::end(buffer_map))
+				return;
+
+			const universe_ownership* owners = find_universe(u);
+
+			for (local_channel_address c = first; c < last; ++c)
+			{
+				if (!owners || (*owners)[c].can_write(updated, true))
+					buffer->second[c] = 0;
+			}
+		});
+	}
+
+	void channel_ownership::clear_htp_channels(const fixture_patch_info& patch_info, timestamp updated, universe_buffer_map& buffer_map)
+	{
+		patch_info.for_each_span([&](const dmx_channel_range& span) { clear_htp_channels(span, updated, buffer_map); });
+	}
+
+	void channel_ownership::begin_write(const dmx_channel_range& range, timestamp updated, bool is_htp,
+	                                    const universe_buffer_map& buffer_map)
+	{
+		_protected_channels.clear();
+		save_protected_channels(range, updated, is_htp, buffer_map);
+	}
+
+	void channel_ownership::begin_write(const fixture_patch_info& patch_info, timestamp updated, const universe_buffer_map& buffer_map)
+	{
+		_protected_channels.clear();
+
+		patch_info.for_each_span([&](const dmx_channel_range& span)
+		{
+			save_protected_channels(span, updated, patch_info.is_htp, buffer_map);
+		});
+	}
+
+	void channel_ownership::end_write(const dmx_channel_range& range, timestamp updated, bool is_htp,
+	                                  universe_buffer_map& buffer_map, bool did_write)
+	{
+		restore_protected_channels(buffer_map);
+
+		if (did_write)
+			take_ownership(range, updated, is_htp);
+	}
+
+	void channel_ownership::end_write(const fixture_patch_info& patch_info, timestamp updated, universe_buffer_map& buffer_map,
+	                                  bool did_write)
+	{
+		restore_protected_channels(buffer_map);
+
+		if (did_write)
+			patch_info.for_each_span([&](const dmx_channel_range& span) { take_ownership(span, updated, patch_info.is_htp); });
+	}
+
+	void channel_ownership::save_protected_channels(const dmx_channel_range& range, timestamp updated, bool is_htp,
+	                                                const universe_buffer_map& buffer_map)
+	{
+		for_each_universe(range, [&](universe_address u, local_channel_address first, local_channel_address last)
+		{
+			const universe_ownership* owners = find_universe(u);
+			if (!owners)
+				return;
+
+			// The buffer is only looked up once a channel needs saving, which is rare outside of overlapping patches
+			auto buffer = std::end(buffer_map);
+
+			for (local_channel_address c = first; c < last; ++c)
+			{
+				if ((*owners)[c].can_write(updated, is_htp))
+					continue;
+
+				if (buffer == std::end(buffer_map))
+				{
+					buffer = buffer_map.find(u);
+					if (buffer == std::end(buffer_map))
+						return;
+				}
+
+				_protected_channels.emplace_back(u * k_universe_length + c, buffer->second[c]);
+			}
+		});
+	}
+
+	void channel_ownership::restore_protected_channels(universe_buffer_map& buffer_map)
+	{
+		auto buffer = std::end(buffer_map);
+
+		for (const auto& c : _protected_channels)
+		{
+			const universe_address u = c.first / k_universe_length;
+
+			if (buffer == std::end(buffer_map) || buffer->first != u)
+				buffer = buffer_map.find(u);
+
+			buffer->second[c.first % k_universe_length] = c.second;
+		}
+	}
+
+	void channel_ownership::take_ownership(const dmx_channel_range& range, timestamp updated, bool is_htp)
+	{
+		for_each_universe(range, [&](universe_address u, local_channel_address first, local_channel_address last)
+		{
+			universe_ownership& owners = get_universe(u);
+
+			for (local_channel_address c = first; c < last; ++c)
+			{
+				channel_owner& owner = owners[c];
+
+				if (!owner.can_write(updated, is_htp))
+					continue;
+
+				if (is_htp && owner.is_htp)
+					owner.updated = std::max(owner.updated, updated);
+				else
+					owner = { updated, is_htp };
+			}
+		});
+	}
+
+	channel_owner channel_ownership::get_owner(universe_address universe, local_channel_address channel) const
+	{
+		const auto owners = _universes.find(universe);
+		if (owners == std::end(_universes))
+			return { };
+
+		return owners->second[channel];
+	}
+}
@@ -0,0 +1,104 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "dmx_channel_range.hpp"
+#include "fixture_patch_info.hpp"
+
+namespace lxmax
+{
+	/// @brief The last fixture to write a channel, identified by the time its values were updated
+	struct channel_owner
+	{
+		timestamp updated { timestamp::min() };
+		bool is_htp { false };
+
+		bool is_owned() const
+		{
+			return updated != timestamp::min();
+		}
+
+		/// @brief Checks if a writer may change the channel, HTP writers merge with each other while LTP only replaces older values
+		bool can_write(timestamp writer_updated, bool is_writer_htp) const
+		{
+			return writer_updated >= updated || (is_writer_htp && is_htp);
+		}
+	};
+
+	using universe_ownership = std::array<channel_owner, k_universe_length>;
+
+	/// @brief Per channel record of which writer each universe buffer value came from, used to resolve LTP and HTP
+	///
+	/// Fixtures write their whole channel range, so any channels owned by a newer writer are saved before a fixture
+	/// writes and restored afterwards. Resolving a fixture only touches the channels it's patched to.
+	class channel_ownership
+	{
+		std::unordered_map<universe_address, universe_ownership> _universes;
+
+		// Fixtures are written in channel order, so consecutive lookups are usually for the same universe
+		universe_address _last_universe { -1 };
+		universe_ownership* _last_owners { nullptr };
+
+		// Channels saved by begin_write, kept between writes so they don't allocate
+		std::vector<std::pair<channel_address, dmx_value>> _protected_channels;
+
+		template <typename F>
+		static void for_each_universe(const dmx_channel_range& range, F&& f)
+		{
+			for (universe_address u = range.start_universe(); u * k_universe_length < range.end(); ++u)
+			{
+				const local_channel_address first = std::max(range.start(), u * k_universe_length) - u * k_universe_length;
+				const local_channel_address last = std::min(range.end(), (u + 1) * k_universe_length) - u * k_universe_length;
+
+				f(u, first, last);
+			}
+		}
+
+		/// @returns The owners of a universe's channels, or nullptr if nothing has written to it
+		universe_ownership* find_universe(universe_address universe);
+
+		universe_ownership& get_universe(universe_address universe);
+
+		void save_protected_channels(const dmx_channel_range& range, timestamp updated, bool is_htp, const universe_buffer_map& buffer_map);
+
+		void restore_protected_channels(universe_buffer_map& buffer_map);
+
+		void take_ownership(const dmx_channel_range& range, timestamp updated, bool is_htp);
+
+	public:
+		/// @brief Forgets every channel's owner, keeping the memory used for each universe
+		void reset();
+
+		/// @brief Zeroes the channels an HTP writer is about to merge into, so they can be merged again from scratch
+		///
+		/// Channels written by other HTP writers are cleared too, so they must all write again afterwards. Channels owned
+		/// by a newer LTP writer are left alone.
+		void clear_htp_channels(const dmx_channel_range& range, timestamp updated, universe_buffer_map& buffer_map);
+
+		/// @brief Saves the channels in a range which a writer can't change, must be followed by end_write
+		void begin_write(const dmx_channel_range& range, timestamp updated, bool is_htp, const universe_buffer_map& buffer_map);
+
+		/// @brief Restores the channels saved by begin_write, and if the writer did write, takes ownership of the rest
+		void end_write(const dmx_channel_range& range, timestamp updated, bool is_htp, universe_buffer_map& buffer_map, bool did_write);
+
+		/// @brief clear_htp_channels for each span of a fixture's patch
+		void clear_htp_channels(const fixture_patch_info& patch_info, timestamp updated, universe_buffer_map& buffer_map);
+
+		/// @brief begin_write for each span of a fixture's patch, leaving any gaps between them untouched
+		void begin_write(const fixture_patch_info& patch_info, timestamp updated, const universe_buffer_map& buffer_map);
+
+		/// @brief end_write for each span of a fixture's patch
+		void end_write(const fixture_patch_info& patch_info, timestamp updated, universe_buffer_map& buffer_map, bool did_write);
+
+		/// @returns The owner of a channel, which is unowned if nothing has written to it since the last reset
+		channel_owner get_owner(universe_address universe, local_channel_address channel) const;
+	};
+}
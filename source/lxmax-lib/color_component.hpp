@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <array>
 #include <string>
 #include <unordered_map>
 #include <cassert>
@@ -13,6 +14,8 @@
 
 namespace lxmax
 {
+    using color_values = std::array<double, 3>;
+
     enum class colorspace
 	{
     	none,
@@ -93,8 +96,8 @@ namespace lxmax
         inline std::string to_string(color_component value)
         {
 	        const auto it = k_color_to_string_map.find(value);
-            assert(it != std::end(k_color_to_string_map),
-                            "All valid color components should exist in map");
+            assert(it != std::end(k_color_to_string_map)
+                            && "All valid color components should exist in map");
             
             return it->second;
         }
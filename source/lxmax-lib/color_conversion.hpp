@@ -0,0 +1,123 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+namespace lxmax
+{
+	/// @brief Single color conversions shared by color_processor and the scalar tail of its batch conversions
+	///
+	/// The batch conversions perform the same operations in the same order, so their results are bit-exact with
+	/// these. All components, including hue, are normalized to 0-1.
+	namespace color_conversion
+	{
+		// Adapted from https://www.cs.rit.edu/~ncs/color/t_convert.html
+
+		template<typename T>
+		void rgb_to_hsb(T r, T g, T b, T& h, T& s, T& v)
+		{
+			const T min = std::min(std::min(r, g), b);
+			const T max = std::max(std::max(r, g), b);
+			v = max;
+
+			const T delta = max - min;
+
+			if (max == T(0))
+			{
+				s = T(0);
+				h = T(0);
+				return;
+			}
+
+			s = delta / max;
+
+			// Achromatic (grey), hue is undefined
+			if (delta == T(0))
+			{
+				h = T(0);
+				return;
+			}
+
+			T hue;
+
+			if (r == max)
+				hue = (g - b) / delta;
+			else if (g == max)
+				hue = T(2) + (b - r) / delta;
+			else
+				hue = T(4) + (r - g) / delta;
+
+			hue *= T(60); // degrees
+			if (hue < T(0))
+				hue += T(360);
+
+			h = hue / T(360); // normalize
+		}
+
+		template<typename T>
+		void hsb_to_rgb(T h, T s, T v, T& r, T& g, T& b)
+		{
+			if (s == T(0))
+			{
+				// achromatic (grey)
+				r = v;
+				g = v;
+				b = v;
+				return;
+			}
+
+			T sector = h * T(360); // de-normalize
+			sector /= T(60); // sector 0 to 5
+
+			T i = std::floor(sector);
+			const T f = sector - i; // factorial part of h
+
+			// A hue of exactly 1 is the same as 0
+			if (i >= T(6))
+				i -= T(6);
+
+			const T p = v * (T(1) - s);
+			const T q = v * (T(1) - s * f);
+			const T t = v * (T(1) - s * (T(1) - f));
+
+			switch (static_cast<int>(i))
+			{
+				case 0:
+					r = v;
+					g = t;
+					b = p;
+					break;
+				case 1:
+					r = q;
+					g = v;
+					b = p;
+					break;
+				case 2:
+					r = p;
+					g = v;
+					b = t;
+					break;
+				case 3:
+					r = p;
+					g = q;
+					b = v;
+					break;
+				case 4:
+					r = t;
+					g = p;
+					b = v;
+					break;
+				default: // case 5:
+					r = v;
+					g = p;
+					b = q;
+					break;
+			}
+		}
+	}
+}
@@ -11,9 +11,9 @@
 
 namespace lxmax
 {
-	Poco::RegularExpression color_personality_element::pattern  { "([A-Z][a-z]?)(?:(8|16|24|32|!16|!24|!32)(\{\d+\})?)?"};
+	Poco::RegularExpression color_personality_element::pattern { R"(^([A-Z][a-z]?|_)(8|16|24|32|16!|24!|32!)?(?:\{(\d+)\})?$)" };
 
-	color_personality_element::color_personality_element(color_component component, value_precision precision, int64_t data):
+	color_personality_element::color_personality_element(color_component component, value_precision precision, std::optional<int64_t> data):
 		component(component),
 		precision(precision),
 		data(data)
@@ -27,23 +27,27 @@ namespace lxmax
 		if (pattern.match(string_value, 0, matches) < 2)
 			return false;
 
-		assert(color_component_helper::from_string(string_value.substr(matches[1].offset, matches[1].length), value.
-				component));
+		const auto is_matched = [&](size_t group) { return matches.size() > group && matches[group].offset != std::string::npos; };
+		const auto get_match = [&](size_t group) { return string_value.substr(matches[group].offset, matches[group].length); };
 
-		if (matches.size() >= 4)
+		color_personality_element element;
+
+		if (!color_component_helper::from_string(get_match(1), element.component))
+			return false;
+
+		if (is_matched(2) && !precision_helper::from_string(get_match(2), element.precision))
+			return false;
+
+		if (is_matched(3))
 		{
 			int64_t data_value;
-			assert(Poco::NumberParser::tryParse64(string_value.substr(matches[3].offset, matches[3].length), data_value));
-			value.data = data_value;
-		}
-
-		if (matches.size() >= 3)
-			assert(
-			precision_helper::from_string(string_value.substr(matches[2].offset, matches[2].length), value.precision));
+			if (!Poco::NumberParser::tryParse64(get_match(3), data_value))
+				return false;
 
-		if (matches.size() == 2)
-			value.precision = value_precision::_8bit;
+			element.data = data_value;
+		}
 
+		value = element;
 		return true;
 	}
 
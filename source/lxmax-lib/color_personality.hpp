@@ -15,13 +15,13 @@ namespace lxmax
 	{
 		static Poco::RegularExpression pattern;
 		
-		color_component component;
-		value_precision precision;
+		color_component component { color_component::none };
+		value_precision precision { value_precision::_8bit };
 		std::optional<int64_t> data;
 
 		color_personality_element() = default;
 
-		color_personality_element(color_component component, value_precision precision = value_precision::_8bit, int64_t data = 0);
+		color_personality_element(color_component component, value_precision precision = value_precision::_8bit, std::optional<int64_t> data = std::nullopt);
 
 		static bool from_string(const std::string& string_value, color_personality_element& value);
 
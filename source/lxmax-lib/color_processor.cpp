@@ -5,9 +5,221 @@
 
 #include "color_processor.hpp"
 
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LXMAX_COLOR_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace lxmax
 {
-	// Adapted from https://www.cs.rit.edu/~ncs/color/t_convert.html
+#ifdef LXMAX_COLOR_BATCH_SSE2
+	namespace
+	{
+		template<typename T>
+		struct simd_ops;
+
+		template<>
+		struct simd_ops<float>
+		{
+			using reg = __m128;
+			static const size_t width = 4;
+
+			static reg load(const float* p) { return _mm_loadu_ps(p); }
+			static void store(float* p, reg a) { _mm_storeu_ps(p, a); }
+			static reg set1(float a) { return _mm_set1_ps(a); }
+			static reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+			static reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+			static reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+			static reg div(reg a, reg b) { return _mm_div_ps(a, b); }
+			static reg min(reg a, reg b) { return _mm_min_ps(a, b); }
+			static reg max(reg a, reg b) { return _mm_max_ps(a, b); }
+			static reg cmpeq(reg a, reg b) { return _mm_cmpeq_ps(a, b); }
+			static reg cmplt(reg a, reg b) { return _mm_cmplt_ps(a, b); }
+			static reg cmpge(reg a, reg b) { return _mm_cmpge_ps(a, b); }
+			static reg cmpgt(reg a, reg b) { return _mm_cmpgt_ps(a, b); }
+			static reg bit_and(reg a, reg b) { return _mm_and_ps(a, b); }
+			static reg bit_or(reg a, reg b) { return _mm_or_ps(a, b); }
+			static reg select(reg mask, reg a, reg b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+			static reg trunc(reg a) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a)); }
+		};
+
+		template<>
+		struct simd_ops<double>
+		{
+			using reg = __m128d;
+			static const size_t width = 2;
+
+			static reg load(const double* p) { return _mm_loadu_pd(p); }
+			static void store(double* p, reg a) { _mm_storeu_pd(p, a); }
+			static reg set1(double a) { return _mm_set1_pd(a); }
+			static reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+			static reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+			static reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+			static reg div(reg a, reg b) { return _mm_div_pd(a, b); }
+			static reg min(reg a, reg b) { return _mm_min_pd(a, b); }
+			static reg max(reg a, reg b) { return _mm_max_pd(a, b); }
+			static reg cmpeq(reg a, reg b) { return _mm_cmpeq_pd(a, b); }
+			static reg cmplt(reg a, reg b) { return _mm_cmplt_pd(a, b); }
+			static reg cmpge(reg a, reg b) { return _mm_cmpge_pd(a, b); }
+			static reg cmpgt(reg a, reg b) { return _mm_cmpgt_pd(a, b); }
+			static reg bit_and(reg a, reg b) { return _mm_and_pd(a, b); }
+			static reg bit_or(reg a, reg b) { return _mm_or_pd(a, b); }
+			static reg select(reg mask, reg a, reg b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+			static reg trunc(reg a) { return _mm_cvtepi32_pd(_mm_cvttpd_epi32(a)); }
+		};
+	}
+#endif
+
+	namespace
+	{
+		// Each vector step mirrors an operation in color_conversion so that results match it exactly
+
+		template<typename T>
+		void rgb_to_hsb_batch_impl(const T* r, const T* g, const T* b, T* h, T* s, T* v, size_t count)
+		{
+			size_t i = 0;
+
+#ifdef LXMAX_COLOR_BATCH_SSE2
+			using simd = simd_ops<T>;
+
+			const auto zero = simd::set1(T(0));
+			const auto two = simd::set1(T(2));
+			const auto four = simd::set1(T(4));
+			const auto sixty = simd::set1(T(60));
+			const auto three_sixty = simd::set1(T(360));
+
+			for (; i + simd::width <= count; i += simd::width)
+			{
+				const auto vr = simd::load(r + i);
+				const auto vg = simd::load(g + i);
+				const auto vb = simd::load(b + i);
+
+				const auto min = simd::min(simd::min(vr, vg), vb);
+				const auto max = simd::max(simd::max(vr, vg), vb);
+				const auto delta = simd::sub(max, min);
+
+				const auto hue_r = simd::div(simd::sub(vg, vb), delta);
+				const auto hue_g = simd::add(two, simd::div(simd::sub(vb, vr), delta));
+				const auto hue_b = simd::add(four, simd::div(simd::sub(vr, vg), delta));
+
+				auto hue = simd::select(simd::cmpeq(vr, max), hue_r, simd::select(simd::cmpeq(vg, max), hue_g, hue_b));
+				hue = simd::mul(hue, sixty);
+				hue = simd::select(simd::cmplt(hue, zero), simd::add(hue, three_sixty), hue);
+				hue = simd::div(hue, three_sixty);
+
+				const auto is_black = simd::cmpeq(max, zero);
+				const auto is_grey = simd::cmpeq(delta, zero);
+
+				simd::store(h + i, simd::select(simd::bit_or(is_black, is_grey), zero, hue));
+				simd::store(s + i, simd::select(is_black, zero, simd::div(delta, max)));
+				simd::store(v + i, max);
+			}
+#endif
+
+			for (; i < count; ++i)
+				color_conversion::rgb_to_hsb(r[i], g[i], b[i], h[i], s[i], v[i]);
+		}
+
+		template<typename T>
+		void hsb_to_rgb_batch_impl(const T* h, const T* s, const T* v, T* r, T* g, T* b, size_t count)
+		{
+			size_t i = 0;
+
+#ifdef LXMAX_COLOR_BATCH_SSE2
+			using simd = simd_ops<T>;
+
+			const auto zero = simd::set1(T(0));
+			const auto one = simd::set1(T(1));
+			const auto two = simd::set1(T(2));
+			const auto three = simd::set1(T(3));
+			const auto four = simd::set1(T(4));
+			const auto six = simd::set1(T(6));
+			const auto sixty = simd::set1(T(60));
+			const auto three_sixty = simd::set1(T(360));
+
+			for (; i + simd::width <= count; i += simd::width)
+			{
+				const auto vh = simd::load(h + i);
+				const auto vs = simd::load(s + i);
+				const auto vv = simd::load(v + i);
+
+				const auto sector = simd::div(simd::mul(vh, three_sixty), sixty);
+
+				// Truncation rounds negative sectors up, so step those down to floor them
+				auto sector_index = simd::trunc(sector);
+				sector_index = simd::sub(sector_index, simd::bit_and(simd::cmpgt(sector_index, sector), one));
+
+				const auto f = simd::sub(sector, sector_index);
+
+				sector_index = simd::select(simd::cmpge(sector_index, six), simd::sub(sector_index, six), sector_index);
+
+				const auto p = simd::mul(vv, simd::sub(one, vs));
+				const auto q = simd::mul(vv, simd::sub(one, simd::mul(vs, f)));
+				const auto t = simd::mul(vv, simd::sub(one, simd::mul(vs, simd::sub(one, f))));
+
+				const auto is_0 = simd::cmpeq(sector_index, zero);
+				const auto is_1 = simd::cmpeq(sector_index, one);
+				const auto is_2 = simd::cmpeq(sector_index, two);
+				const auto is_3 = simd::cmpeq(sector_index, three);
+				const auto is_4 = simd::cmpeq(sector_index, four);
+				const auto is_grey = simd::cmpeq(vs, zero);
+
+				// Sector 5 and any out of range sectors
+				auto vr = vv;
+				auto vg = p;
+				auto vb = q;
+
+				vr = simd::select(is_0, vv, vr);
+				vg = simd::select(is_0, t, vg);
+				vb = simd::select(is_0, p, vb);
+
+				vr = simd::select(is_1, q, vr);
+				vg = simd::select(is_1, vv, vg);
+				vb = simd::select(is_1, p, vb);
+
+				vr = simd::select(is_2, p, vr);
+				vg = simd::select(is_2, vv, vg);
+				vb = simd::select(is_2, t, vb);
+
+				vr = simd::select(is_3, p, vr);
+				vg = simd::select(is_3, q, vg);
+				vb = simd::select(is_3, vv, vb);
+
+				vr = simd::select(is_4, t, vr);
+				vg = simd::select(is_4, p, vg);
+				vb = simd::select(is_4, vv, vb);
+
+				simd::store(r + i, simd::select(is_grey, vv, vr));
+				simd::store(g + i, simd::select(is_grey, vv, vg));
+				simd::store(b + i, simd::select(is_grey, vv, vb));
+			}
+#endif
+
+			for (; i < count; ++i)
+				color_conversion::hsb_to_rgb(h[i], s[i], v[i], r[i], g[i], b[i]);
+		}
+
+		template<typename T>
+		void invert_batch_impl(const T* values, T* inverted, size_t count)
+		{
+			size_t i = 0;
+
+#ifdef LXMAX_COLOR_BATCH_SSE2
+			using simd = simd_ops<T>;
+
+			const auto one = simd::set1(T(1));
+
+			for (; i + simd::width <= count; i += simd::width)
+				simd::store(inverted + i, simd::sub(one, simd::load(values + i)));
+#endif
+
+			for (; i < count; ++i)
+				inverted[i] = T(1) - values[i];
+		}
+	}
 
 	color_values color_processor::get_rgb() const
 	{
@@ -49,7 +261,7 @@ namespace lxmax
 			break;
 
 		case colorspace::hsb:
-			return rgb_to_hsb(invert(_values));
+			return invert(hsb_to_rgb(_values));
 		}
 	}
 
@@ -73,102 +285,62 @@ namespace lxmax
 		}
 	}
 
-	color_values color_processor::rgb_to_hsb(color_values rgb)
+	emitter_values color_processor::get_emitters(emitter_set set) const
 	{
-		color_values hsb;
-		
-		const double min = std::min({rgb[0], rgb[1], rgb[2]});
-		const double max = std::max({rgb[0], rgb[1], rgb[2]});
-		hsb[2] = max;
-		
-		const double delta = max - min;
-
-		if (max != 0)
-		{
-			hsb[1] = delta / max;
-		}
-		else
-		{
-			hsb[1] = 0;
-			hsb[0] = 0;
-			return hsb;
-		}
+		const color_values rgb = get_rgb();
 
-		if (rgb[0] == max)
-			hsb[0] = (rgb[1] - rgb[2]) / delta;
-		else if (rgb[1] == max)
-			hsb[0] = 2 + (rgb[2] - rgb[0]) / delta;
-		else
-			hsb[0] = 4 + (rgb[0] - rgb[1]) / delta;
-		
-		hsb[0] *= 60; // degrees
-		if (hsb[0] < 0)
-			hsb[0] += 360;
+		if (_emitter_lut && _emitter_lut->set() == set)
+			return _emitter_lut->lookup(rgb);
 
-		hsb[0] /= 360.; // normalize
+		return extract_emitters(rgb, set);
+	}
 
+	color_values color_processor::rgb_to_hsb(color_values rgb)
+	{
+		color_values hsb;
+		color_conversion::rgb_to_hsb(rgb[0], rgb[1], rgb[2], hsb[0], hsb[1], hsb[2]);
 		return hsb;
 	}
 
 	color_values color_processor::hsb_to_rgb(color_values hsb)
 	{
 		color_values rgb;
-		
-		if (hsb[1] == 0)
-		{
-			// achromatic (grey)
-			rgb[0] = hsb[2];
-			rgb[1] = hsb[2];
-			rgb[2] = hsb[2];
-			return rgb;
-		}
+		color_conversion::hsb_to_rgb(hsb[0], hsb[1], hsb[2], rgb[0], rgb[1], rgb[2]);
+		return rgb;
+	}
+
+	color_values color_processor::invert(color_values values)
+	{
+		return color_values { 1. - values[0], 1. - values[1], 1. - values[2] };
+	}
 
-		hsb[0] *= 360; // de-normalize
-		hsb[0] /= 60; // sector 0 to 5
+	void color_processor::rgb_to_hsb_batch(const float* r, const float* g, const float* b, float* h, float* s, float* v, size_t count)
+	{
+		rgb_to_hsb_batch_impl(r, g, b, h, s, v, count);
+	}
 
-		const int i = floor(hsb[0]);
-		const double f = hsb[0] - i; // factorial part of h
-		const double p = hsb[2] * (1 - hsb[1]);
-		const double q = hsb[2] * (1 - hsb[1] * f);
-		const double t = hsb[2] * (1 - hsb[1] * (1 - f));
+	void color_processor::rgb_to_hsb_batch(const double* r, const double* g, const double* b, double* h, double* s, double* v, size_t count)
+	{
+		rgb_to_hsb_batch_impl(r, g, b, h, s, v, count);
+	}
 
-		switch (i)
-		{
-		case 0:
-			rgb[0] = hsb[2];
-			rgb[1] = t;
-			rgb[2] = p;
-			break;
-		case 1:
-			rgb[0] = q;
-			rgb[1] = hsb[2];
-			rgb[2] = p;
-			break;
-		case 2:
-			rgb[0] = p;
-			rgb[1] = hsb[2];
-			rgb[2] = t;
-			break;
-		case 3:
-			rgb[0] = p;
-			rgb[1] = q;
-			rgb[2] = hsb[2];
-			break;
-		case 4:
-			rgb[0] = t;
-			rgb[1] = p;
-			rgb[2] = hsb[2];
-			break;
-		default: // case 5:
-			rgb[0] = hsb[2];
-			rgb[1] = p;
-			rgb[2] = q;
-			break;
-		}
+	void color_processor::hsb_to_rgb_batch(const float* h, const float* s, const float* v, float* r, float* g, float* b, size_t count)
+	{
+		hsb_to_rgb_batch_impl(h, s, v, r, g, b, count);
 	}
 
-	color_values color_processor::invert(color_values values)
+	void color_processor::hsb_to_rgb_batch(const double* h, const double* s, const double* v, double* r, double* g, double* b, size_t count)
 	{
-		return color_values { 1. - values[0], 1. - values[1], 1. - values[2] };
+		hsb_to_rgb_batch_impl(h, s, v, r, g, b, count);
+	}
+
+	void color_processor::invert_batch(const float* values, float* inverted, size_t count)
+	{
+		invert_batch_impl(values, inverted, count);
+	}
+
+	void color_processor::invert_batch(const double* values, double* inverted, size_t count)
+	{
+		invert_batch_impl(values, inverted, count);
 	}
 }
@@ -6,16 +6,18 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include "color_component.hpp"
+#include "color_conversion.hpp"
+#include "emitter_extraction.hpp"
 
 namespace lxmax
 {
-	using color_values = std::array<double, 3>;
-
 	class color_processor
 	{
 		color_values _values { 0, 0, 0 };
 		colorspace _colorspace { colorspace::rgb };
+		std::shared_ptr<const emitter_lut> _emitter_lut;
 		
 	public:
 		void set_rgb(double r, double g, double b)
@@ -48,16 +50,36 @@ namespace lxmax
 
 		color_values get_hsb() const;
 
+		/// @brief Uses calibrated emitter levels from the table, when its emitter set matches, rather than extracting them
+		void set_emitter_lut(std::shared_ptr<const emitter_lut> lut)
+		{
+			_emitter_lut = std::move(lut);
+		}
+
+		/// @brief Gets the color split across a fixture's emitters
+		emitter_values get_emitters(emitter_set set) const;
+
 		double get_white() const
 		{
-			
+			return get_emitters(emitter_set::rgbw).white;
 		}
 
 		double get_amber() const
 		{
-			
+			return get_emitters(emitter_set::rgba).amber;
 		}
 
+		/// @brief Converts a batch of colors stored as one array per component
+		/// @note Uses SSE2 where available, results are bit-exact with converting each color individually
+		static void rgb_to_hsb_batch(const float* r, const float* g, const float* b, float* h, float* s, float* v, size_t count);
+		static void rgb_to_hsb_batch(const double* r, const double* g, const double* b, double* h, double* s, double* v, size_t count);
+
+		static void hsb_to_rgb_batch(const float* h, const float* s, const float* v, float* r, float* g, float* b, size_t count);
+		static void hsb_to_rgb_batch(const double* h, const double* s, const double* v, double* r, double* g, double* b, size_t count);
+
+		static void invert_batch(const float* values, float* inverted, size_t count);
+		static void invert_batch(const double* values, double* inverted, size_t count);
+
 	private:
 		static color_values rgb_to_hsb(color_values rgb);
 
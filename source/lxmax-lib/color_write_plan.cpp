@@ -0,0 +1,126 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "color_write_plan.hpp"
+
+#include <algorithm>
+
+namespace lxmax
+{
+	color_write_plan::color_write_plan(const color_personality& personality)
+	{
+		_entries.reserve(personality.size());
+
+		bool is_white_used = false;
+		bool is_amber_used = false;
+
+		for (const auto& e : personality)
+		{
+			color_write_plan_entry entry;
+			entry.offset = _channel_count;
+			entry.width = precision_helper::get_width(e.precision);
+			entry.precision = e.precision;
+			entry.writer = get_ltp_writer(e.precision);
+
+			switch (e.component)
+			{
+				case color_component::none:
+				case color_component::fixed:
+				{
+					const double max = precision_helper::get_max(e.precision);
+					const double value = e.component == color_component::fixed ? static_cast<double>(e.data.value_or(0)) : 0.;
+
+					entry.source = _source_values.size();
+					entry.is_fixed = true;
+					_source_values.push_back(std::clamp(value / max, 0., 1.));
+				}
+				break;
+
+				default:
+					entry.source = static_cast<size_t>(e.component);
+					entry.is_fixed = false;
+					break;
+			}
+
+			switch (color_component_helper::get_colorspace(e.component))
+			{
+				case colorspace::rgb:
+					_is_rgb_used = true;
+					break;
+				case colorspace::cmy:
+					_is_cmy_used = true;
+					break;
+				case colorspace::hsb:
+					_is_hsb_used = true;
+					break;
+				default:
+					break;
+			}
+
+			is_white_used |= e.component == color_component::white;
+			is_amber_used |= e.component == color_component::amber;
+
+			_entries.push_back(entry);
+			_channel_count += entry.width;
+		}
+
+		if (is_white_used)
+			_emitter_set = is_amber_used ? emitter_set::rgbwa : emitter_set::rgbw;
+		else if (is_amber_used)
+			_emitter_set = emitter_set::rgba;
+	}
+
+	void color_write_plan::write(const color_processor& processor, double intensity, dmx_value* data, int available,
+	                             const response_curve* curve)
+	{
+		double* values = _source_values.data();
+
+		if (_emitter_set != emitter_set::rgb)
+		{
+			// Red, green and blue only make up what the other emitters can't
+			const emitter_values emitters = processor.get_emitters(_emitter_set);
+			values[static_cast<size_t>(color_component::red)] = emitters.red;
+			values[static_cast<size_t>(color_component::green)] = emitters.green;
+			values[static_cast<size_t>(color_component::blue)] = emitters.blue;
+			values[static_cast<size_t>(color_component::white)] = emitters.white;
+			values[static_cast<size_t>(color_component::amber)] = emitters.amber;
+		}
+		else if (_is_rgb_used)
+		{
+			const color_values rgb = processor.get_rgb();
+			values[static_cast<size_t>(color_component::red)] = rgb[0];
+			values[static_cast<size_t>(color_component::green)] = rgb[1];
+			values[static_cast<size_t>(color_component::blue)] = rgb[2];
+		}
+
+		if (_is_cmy_used)
+		{
+			const color_values cmy = processor.get_cmy();
+			values[static_cast<size_t>(color_component::cyan)] = cmy[0];
+			values[static_cast<size_t>(color_component::magenta)] = cmy[1];
+			values[static_cast<size_t>(color_component::yellow)] = cmy[2];
+		}
+
+		if (_is_hsb_used)
+		{
+			const color_values hsb = processor.get_hsb();
+			values[static_cast<size_t>(color_component::hue)] = hsb[0];
+			values[static_cast<size_t>(color_component::saturation)] = hsb[1];
+			values[static_cast<size_t>(color_component::brightness)] = hsb[2];
+		}
+
+		values[static_cast<size_t>(color_component::intensity)] = intensity;
+
+		for (const auto& e : _entries)
+		{
+			// Entries are in channel order, so once one doesn't fit none of the rest will
+			if (e.offset + e.width > available)
+				break;
+
+			const double value = std::clamp(values[e.source], 0., 1.);
+			e.writer(curve && !e.is_fixed ? curve->apply(value) : value, data + e.offset);
+		}
+	}
+}
@@ -0,0 +1,74 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <vector>
+
+#include "color_personality.hpp"
+#include "color_processor.hpp"
+#include "precision_helpers.hpp"
+
+namespace lxmax
+{
+	/// @brief A single value written by a color write plan
+	///
+	struct color_write_plan_entry
+	{
+		int offset;
+		int width;
+		value_precision precision;
+		precision_writer writer;
+		size_t source;
+		bool is_fixed;
+	};
+
+	/// @brief Color personality compiled into a flat list of writes
+	///
+	/// Sources index a table holding one normalized value per color component followed by the plan's fixed values.
+	/// The table's component values are refreshed once per write, so each entry is a lookup and a call to its
+	/// precision's writer.
+	class color_write_plan
+	{
+		static const size_t k_component_count = static_cast<size_t>(color_component::intensity) + 1;
+
+		std::vector<color_write_plan_entry> _entries;
+		std::vector<double> _source_values = std::vector<double>(k_component_count, 0.);
+		int _channel_count { 0 };
+
+		bool _is_rgb_used { false };
+		bool _is_cmy_used { false };
+		bool _is_hsb_used { false };
+		emitter_set _emitter_set { emitter_set::rgb };
+
+	public:
+		color_write_plan() = default;
+
+		explicit color_write_plan(const color_personality& personality);
+
+		/// @brief Gets the number of DMX channels written by the plan
+		int channel_count() const
+		{
+			return _channel_count;
+		}
+
+		const std::vector<color_write_plan_entry>& entries() const
+		{
+			return _entries;
+		}
+
+		/// @brief Gets the emitters the personality has in addition to red, green and blue
+		emitter_set get_emitter_set() const
+		{
+			return _emitter_set;
+		}
+
+		/// @brief Writes the processor's current color
+		/// @param available Number of channels available from data, entries which don't fit are not written
+		/// @param curve Applied to all but fixed values, may be null
+		void write(const color_processor& processor, double intensity, dmx_value* data, int available,
+		           const response_curve* curve = nullptr);
+	};
+}
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <climits>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -14,6 +15,7 @@
 #include <map>
 #include <chrono>
 #include <unordered_set>
+#include <vector>
 
 namespace lxmax
 {
@@ -5,11 +5,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <mutex>
 #include <optional>
 #include "common.hpp"
+#include "instrumented_mutex.hpp"
 #include "preferences_manager.hpp"
+#include "trace.hpp"
+#include "universe_monitor.hpp"
 
 namespace lxmax
 {
@@ -19,11 +23,14 @@ namespace lxmax
 	{
 		Poco::Logger& _log;
 
-		std::mutex _config_mutex;
+		instrumented_mutex _config_mutex { "dmx_buffer_manager config" };
 		
 		universe_buffer_map _universe_buffers;
 		universe_updated_list _universe_updated;
 
+		std::mutex _monitor_mutex;
+		std::vector<universe_monitor*> _monitors;
+
 	public:
 		dmx_buffer_manager(Poco::Logger& log)
 			: _log(log)
@@ -31,9 +38,9 @@ namespace lxmax
 			
 		}
 
-		std::tuple<std::unique_lock<std::mutex>, universe_buffer_map&> get_universe_buffers()
+		std::tuple<std::unique_lock<instrumented_mutex>, universe_buffer_map&> get_universe_buffers()
 		{
-			return { std::unique_lock<std::mutex>(_config_mutex), _universe_buffers };
+			return { std::unique_lock<instrumented_mutex>(_config_mutex), _universe_buffers };
 		}
 
 		void update_universe_configs(const void* pSender)
@@ -43,7 +50,9 @@ namespace lxmax
 
 		std::optional<universe_buffer> get_universe_buffer(universe_address address)
 		{
-			std::lock_guard<std::mutex> lock(_config_mutex);
+			LXMAX_TRACE_SCOPE_ARG("output", "universe copy", "universe", address);
+
+			std::lock_guard<instrumented_mutex> lock(_config_mutex);
 			
 			const auto it = _universe_buffers.find(address);
 			if (it == std::end(_universe_buffers))
@@ -52,10 +61,51 @@ namespace lxmax
 			return it->second;
 		}
 
+		/// @brief Registers a monitor, which is immediately sent the current state of its universe
+		void add_monitor(universe_monitor* monitor)
+		{
+			const auto buffer = get_universe_buffer(monitor->universe());
+
+			std::lock_guard<std::mutex> lock(_monitor_mutex);
+			_monitors.push_back(monitor);
+
+			if (buffer.has_value())
+				monitor->write_frame(buffer.value());
+		}
+
+		/// @brief Unregisters a monitor, after which the output thread will no longer write to it
+		void remove_monitor(universe_monitor* monitor)
+		{
+			std::lock_guard<std::mutex> lock(_monitor_mutex);
+			_monitors.erase(std::remove(std::begin(_monitors), std::end(_monitors), monitor), std::end(_monitors));
+		}
+
+		/// @brief Sends each updated universe to its monitors, called by the output thread after writing a frame
+		void notify_monitors(const universe_updated_list& updated_universes)
+		{
+			std::lock_guard<std::mutex> monitor_lock(_monitor_mutex);
+
+			if (_monitors.empty() || updated_universes.empty())
+				return;
+
+			std::lock_guard<instrumented_mutex> lock(_config_mutex);
+
+			for (universe_monitor* monitor : _monitors)
+			{
+				if (std::find(std::begin(updated_universes), std::end(updated_universes), monitor->universe())
+					== std::end(updated_universes))
+					continue;
+
+				const auto it = _universe_buffers.find(monitor->universe());
+				if (it != std::end(_universe_buffers))
+					monitor->write_frame(it->second);
+			}
+		}
+
 	private:
 		void create_buffers(const dmx_universe_configs& universe_configs)
 		{
-			std::lock_guard<std::mutex> lock(_config_mutex);
+			std::lock_guard<instrumented_mutex> lock(_config_mutex);
 			
 			_universe_buffers.clear();
 			
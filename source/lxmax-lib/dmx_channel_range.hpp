@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <cmath>
+
 #include "common.hpp"
 
 namespace lxmax
@@ -24,8 +26,8 @@ namespace lxmax
 		}
 		
 		dmx_channel_range(universe_address universe, int start_channel, int channel_count)
-			: _start(universe * k_universe_length),
-			_end(_start + (start_channel - 1) + channel_count)
+			: _start(universe * k_universe_length + (start_channel - 1)),
+			_end(_start + channel_count)
 		{
 			
 		}
@@ -45,6 +47,11 @@ namespace lxmax
 			return std::floor(_start / 512);
 		}
 
+		universe_address end_universe() const
+		{
+			return _end > _start ? (_end - 1) / 512 : start_universe();
+		}
+
 		local_channel_address start_local() const
 		{
 			return _start % 512;
@@ -68,7 +75,7 @@ namespace lxmax
 
 		bool is_overlapping_with(const dmx_channel_range& other) const
 		{
-			return _start <= other._end && other._start <= _end;
+			return _start < other._end && other._start < _end;
 		}
 
 		bool is_empty() const
@@ -4,16 +4,21 @@
 /// @license	Use of this source code is governed by the MIT License found in the License.md file.
 
 #include "dmx_output_service.hpp"
+#include <algorithm>
+#include <thread>
 #include <Poco/Net/NetException.h>
+#include "trace.hpp"
 
 namespace lxmax
 {
 	void dmx_output_service::update_global_config(const void* pSender)
 	{
-		std::lock_guard<std::mutex> lock(_config_mutex);
+		std::lock_guard<instrumented_mutex> lock(_config_mutex);
 
 		_global_config = reinterpret_cast<const preferences_manager*>(pSender)->get_global_config();
 
+		_artnet_discovery.stop();
+
 		if (_sacn_socket)
 			_sacn_socket.reset();
 
@@ -24,7 +29,9 @@ namespace lxmax
 			                                  ? _global_config.framerate
 			                                  : std::min(_global_config.framerate, k_dmx_framerate_max));
 
-		_timer.setPeriodicInterval(static_cast<long>(std::round(1000. / framerate)));
+		_frame_period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1. / framerate));
+
+		_fixture_manager->set_compose_thread_count(_global_config.compose_thread_count);
 
 		{
 			Poco::Net::IPAddress artnet_nic_address;
@@ -59,10 +66,13 @@ namespace lxmax
 				}
 			}
 
-			_artnet_socket = std::make_unique<Poco::Net::DatagramSocket>();
+			_artnet_socket = std::make_shared<Poco::Net::DatagramSocket>();
 
 			_artnet_socket->bind(Poco::Net::SocketAddress(artnet_nic_address, k_artnet_port), true, true);
 			_artnet_socket->setBroadcast(true);
+
+			if (_global_config.is_artnet_discovery_enabled)
+				_artnet_discovery.start(_artnet_socket.get(), Poco::Net::SocketAddress(_artnet_broadcast_address, k_artnet_port));
 		}
 
 		{
@@ -83,7 +93,7 @@ namespace lxmax
 				}
 			}
 
-			_sacn_socket = std::make_unique<Poco::Net::MulticastSocket>();
+			_sacn_socket = std::make_shared<Poco::Net::MulticastSocket>();
 
 			Poco::Net::IPAddress sacn_nic_address;
 			sacn_nic.firstAddress(sacn_nic_address);
@@ -95,11 +105,20 @@ namespace lxmax
 
 			_sacn_socket->setLoopback(true);
 		}
+
+		_artnet_sync_address = Poco::Net::SocketAddress(_artnet_broadcast_address, k_artnet_port);
+		_sacn_sync_address = Poco::Net::SocketAddress(get_sacn_multicast_address(_global_config.sacn_sync_address), k_sacn_port);
+
+		update_destinations();
+		reset_send_state();
+
+		// Wake the output thread so the new configuration takes effect immediately
+		_fixture_manager->notify_fixture_updated();
 	}
 
 	void dmx_output_service::update_universe_configs(const void* pSender)
 	{
-		std::lock_guard<std::mutex> lock(_config_mutex);
+		std::lock_guard<instrumented_mutex> lock(_config_mutex);
 
 		const auto& universes = reinterpret_cast<const preferences_manager*>(pSender)->get_universe_configs();
 
@@ -110,35 +129,193 @@ namespace lxmax
 			if (u.second->is_enabled && u.second->universe_type() == dmx_universe_type::output)
 				_universe_configs.push_back(*dynamic_cast<dmx_output_universe_config*>(u.second.get()));
 		}
+
+		update_destinations();
+		reset_send_state();
+
+		_fixture_manager->notify_fixture_updated();
 	}
 
-	void dmx_output_service::on_timer(Poco::Timer& timer)
+	void dmx_output_service::run()
 	{
-		// TODO: Calculate full update time per universe
+		LXMAX_TRACE_THREAD_NAME("DMX Output");
 
-		bool is_full_update = false;
+		bool is_update_pending = true;
 
-		const auto time_now = clock::now();
-		if (_global_config.is_force_output_at_framerate || time_now - _last_full_update_time > k_full_update_interval)
+		while (_isRunning)
 		{
-			is_full_update = true;
-			_last_full_update_time = time_now;
+			timestamp next_output;
+
+			{
+				std::lock_guard<instrumented_mutex> lock(_config_mutex);
+				next_output = next_output_time(is_update_pending);
+
+				// Signal rate fixtures change every frame without notifying, so they're output at the frame rate, as are
+				// frames until queued registrations have settled and been published
+				if (_fixture_manager->has_streaming_fixtures() || _fixture_manager->has_pending_registrations())
+					next_output = std::min(next_output, _last_frame_time + _frame_period);
+			}
+
+			// Sleep until the next keep-alive or pending change is due, any fixture change wakes us early
+			const auto time_now = clock::now();
+			if (time_now < next_output)
+			{
+				if (_fixture_manager->wait_for_fixture_update(std::chrono::ceil<milliseconds>(next_output - time_now)))
+					is_update_pending = true;
+
+				++_counters.wakeups;
+				continue;
+			}
+
+			{
+				std::lock_guard<instrumented_mutex> lock(_config_mutex);
+
+				// TODO: Calculate full update time per universe
+
+				bool is_full_update = false;
+
+				if (_global_config.is_force_output_at_framerate || time_now - _last_full_update_time >= k_full_update_interval)
+				{
+					is_full_update = true;
+					_last_full_update_time = time_now;
+				}
+
+				_last_frame_time = time_now;
+				is_update_pending = false;
+
+				output_frame(is_full_update, time_now);
+			}
+
+			// Pacing can sleep for most of the frame, so config changes aren't held up while the packets are sent
+			send_pending(time_now);
+
+			std::lock_guard<instrumented_mutex> lock(_config_mutex);
+			finish_frame();
 		}
+	}
 
-		std::lock_guard<std::mutex> lock(_config_mutex);
+	timestamp dmx_output_service::next_output_time(bool is_update_pending) const
+	{
+		const timestamp next_frame = _last_frame_time + _frame_period;
 
-		auto updated_universes = _fixture_manager->write_to_buffer(is_full_update);
+		timestamp next_output = _global_config.is_force_output_at_framerate
+			                        ? next_frame
+			                        : _last_full_update_time + k_full_update_interval;
 
-		bool is_artnet_packet_sent = false;
-		bool is_sacn_packet_sent = false;
+		if (_global_config.is_low_latency_output_enabled)
+		{
+			if (is_update_pending)
+				return clock::now();
 
-		for (const auto& config : _universe_configs)
+			// Universes held back by the minimum interval are due as soon as it has elapsed
+			const milliseconds min_interval { std::max(0, _global_config.low_latency_min_interval) };
+
+			for (size_t i = 0; i < _universe_configs.size(); ++i)
+			{
+				if (std::find(std::begin(_rate_limited_universes), std::end(_rate_limited_universes),
+				              _universe_configs[i].internal_universe) != std::end(_rate_limited_universes))
+					next_output = std::min(next_output, _universe_last_sent_times[i] + min_interval);
+			}
+		}
+		else if (is_update_pending)
+		{
+			next_output = std::min(next_output, next_frame);
+		}
+
+		if (!_deferred_sends.empty())
+			next_output = std::min(next_output, next_frame);
+
+		return next_output;
+	}
+
+	void dmx_output_service::output_frame(bool is_full_update, timestamp time_now)
+	{
+		LXMAX_TRACE_SCOPE_ARG("output", "output_frame", "is_full_update", is_full_update);
+
+		// Nodes joining or expiring only change where universes are sent, so pacing and deferred sends are kept
+		if (_global_config.is_artnet_discovery_enabled && _artnet_discovery.generation() != _artnet_discovery_generation)
+			update_destinations();
+
+		if (_is_send_state_reset_pending)
+		{
+			_destination_buckets.clear();
+			_deferred_sends.clear();
+			_deferred_destinations.reset();
+			_is_send_state_reset_pending = false;
+		}
+
+		// The frame keeps its own references to what it sends with, as they can be replaced once the config is unlocked
+		_send_artnet_socket = _artnet_socket;
+		_send_sacn_socket = _sacn_socket;
+		_send_destinations = _universe_destinations;
+
+		_send_settings.is_pacing_enabled = _global_config.is_output_pacing_enabled;
+		_send_settings.max_packets_per_second = _global_config.output_pacing_max_packets_per_second;
+		_send_settings.window = _frame_period * std::clamp(_global_config.output_pacing_window, 1, 100) / 100;
+
+		universe_updated_list& updated_universes = _updated_universes;
+
+		_fixture_manager->write_to_buffer(updated_universes, is_full_update);
+		_buffer_manager->notify_monitors(updated_universes);
+
+		// Packets which couldn't be sent within the last frame's pacing window are sent in this one, to the destinations
+		// which missed them. If the destinations have changed since, their universes are sent to every destination.
+		_requeued_sends.swap(_deferred_sends);
+		_deferred_sends.clear();
+
+		if (!_requeued_sends.empty() && _deferred_destinations != _send_destinations)
+		{
+			for (const auto& requeued : _requeued_sends)
+				updated_universes.push_back(requeued.internal_universe);
+
+			_requeued_sends.clear();
+		}
+
+		_deferred_destinations.reset();
+
+		// As are those held back by the low latency minimum interval
+		updated_universes.insert(std::end(updated_universes), std::begin(_rate_limited_universes), std::end(_rate_limited_universes));
+		_rate_limited_universes.clear();
+
+		const milliseconds min_interval { std::max(0, _global_config.low_latency_min_interval) };
+
+		_pending_sends.clear();
+
+		_is_artnet_packet_queued = false;
+		_is_sacn_packet_queued = false;
+
+		for (size_t i = 0; i < _universe_configs.size(); ++i)
 		{
-			if (!is_full_update)
+			const auto& config = _universe_configs[i];
+
+			const bool is_updated = is_full_update
+				|| std::find(std::begin(updated_universes), std::end(updated_universes), config.internal_universe)
+				!= std::end(updated_universes);
+
+			const bool is_requeued_only = !is_updated
+				&& std::any_of(std::begin(_requeued_sends), std::end(_requeued_sends),
+				               [&](const dmx_output_deferred_send& requeued) { return requeued.internal_universe == config.internal_universe; });
+
+			if (!is_updated && !is_requeued_only)
+				continue;
+
+			const int patched_channel_count = _fixture_manager->get_patched_channel_count(config.internal_universe);
+
+			if (patched_channel_count == 0 && !_global_config.is_output_empty_universes)
+				continue;
+
+			if (_global_config.is_low_latency_output_enabled)
 			{
-				if (std::find(std::begin(updated_universes), std::end(updated_universes), config.internal_universe)
-					== std::end(updated_universes))
+				if (time_now - _universe_last_sent_times[i] < min_interval)
+				{
+					if (std::find(std::begin(_rate_limited_universes), std::end(_rate_limited_universes), config.internal_universe)
+						== std::end(_rate_limited_universes))
+					{
+						_rate_limited_universes.push_back(config.internal_universe);
+					}
+
 					continue;
+				}
 			}
 
 			const auto data = _buffer_manager->get_universe_buffer(config.internal_universe);
@@ -146,54 +323,146 @@ namespace lxmax
 			if (!data.has_value())
 				continue;
 
-			try
+			switch (config.protocol)
 			{
-				switch (config.protocol)
-				{
 				case dmx_protocol::artnet:
-				{
-					if (!_artnet_socket)
+					if (!_send_artnet_socket)
 						continue;
 
-					if (!is_artnet_packet_sent)
+					if (!_is_artnet_packet_queued)
 					{
 						_artnet_sequence = _artnet_sequence >= 255 ? 1 : _artnet_sequence + 1;
-						is_artnet_packet_sent = true;
+						_is_artnet_packet_queued = true;
 					}
+					break;
 
-					dmx_packet_artnet packet(config.protocol_universe, _artnet_sequence, data.value());
-					const auto packet_buffer = packet.serialize();
+				case dmx_protocol::sacn:
+					if (!_send_sacn_socket)
+						continue;
+
+					if (!_is_sacn_packet_queued)
+					{
+						_sacn_sequence = _sacn_sequence >= 255 ? 0 : _sacn_sequence + 1;
+						_is_sacn_packet_queued = true;
+					}
+					break;
+
+				default:
+					continue;
+			}
+
+			// Only universes with packets queued are held back by the minimum interval, deferred ones are cleared once sent
+			if (queue_universe_packets(config, (*_send_destinations)[i], is_requeued_only, data.value(),
+				patched_channel_count > 0 ? patched_channel_count : k_universe_length))
+			{
+				_universe_last_sent_times[i] = time_now;
+			}
+		}
+
+		_counters.compose_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - time_now).count();
+	}
+
+	void dmx_output_service::finish_frame()
+	{
+		// Universes the pacing deferred weren't sent everywhere, so mustn't hold up their next frame
+		for (const auto& deferred : _deferred_sends)
+		{
+			for (size_t i = 0; i < _universe_configs.size(); ++i)
+			{
+				if (_universe_configs[i].internal_universe == deferred.internal_universe)
+					_universe_last_sent_times[i] = timestamp();
+			}
+		}
+
+		try
+		{
+			if (_global_config.is_send_artnet_sync_packets && _is_artnet_packet_queued)
+			{
+				LXMAX_TRACE_SCOPE("output", "artnet sync packet");
 
+				sync_packet_artnet packet;
+				packet.serialize(_sync_packet_buffer);
+
+				_send_artnet_socket->sendTo(_sync_packet_buffer.data(), static_cast<int>(_sync_packet_buffer.size()), _artnet_sync_address);
+			}
+
+			if (_global_config.is_send_sacn_sync_packets && _is_sacn_packet_queued)
+			{
+				LXMAX_TRACE_SCOPE("output", "sacn sync packet");
+
+				sync_packet_sacn packet(_system_id, _sacn_sync_sequence, _global_config.sacn_sync_address);
+				packet.serialize(_sync_packet_buffer);
+
+				_send_sacn_socket->sendTo(_sync_packet_buffer.data(), static_cast<int>(_sync_packet_buffer.size()), _sacn_sync_address);
+
+				_sacn_sync_sequence = _sacn_sync_sequence >= 255 ? 1 : _sacn_sync_sequence + 1;
+			}
+		}
+		catch (const Poco::Net::NetException& ex)
+		{
+			++_counters.send_errors;
+		}
+
+		// Sockets replaced by a config change while the frame was sending are closed here
+		_send_artnet_socket.reset();
+		_send_sacn_socket.reset();
+		_send_destinations.reset();
+
+		++_counters.frames_sent;
+	}
+
+	void dmx_output_service::update_destinations()
+	{
+		auto universe_destinations = std::make_shared<universe_destination_list>();
+		universe_destinations->reserve(_universe_configs.size());
+
+		_artnet_discovery_generation = _artnet_discovery.generation();
+
+		// With discovery enabled, universes which would be broadcast are instead unicast to subscribed nodes, until a
+		// node has replied or once every node has expired they're still broadcast so output doesn't stop
+		const auto add_artnet_broadcast_destinations = [this](universe_address protocol_universe,
+		                                                      std::vector<Poco::Net::SocketAddress>& destinations)
+		{
+			if (_global_config.is_artnet_discovery_enabled)
+			{
+				for (const auto& a : _artnet_discovery.get_subscribers(protocol_universe))
+					destinations.emplace_back(a, k_artnet_port);
+			}
+
+			if (destinations.empty())
+				destinations.emplace_back(_artnet_broadcast_address, k_artnet_port);
+		};
+
+		for (const auto& config : _universe_configs)
+		{
+			std::vector<Poco::Net::SocketAddress> destinations;
+
+			switch (config.protocol)
+			{
+				case dmx_protocol::artnet:
+				{
 					if (config.is_use_global_destination)
 					{
 						if (_global_config.is_artnet_global_destination_broadcast)
 						{
-							Poco::Net::SocketAddress address{_artnet_broadcast_address, k_artnet_port};
-							_artnet_socket->sendTo(packet_buffer.data(), packet_buffer.size(), address);
+							add_artnet_broadcast_destinations(config.protocol_universe, destinations);
 						}
 						else
 						{
 							for (const auto& a : _global_config.artnet_global_destination_unicast_addresses)
-							{
-								Poco::Net::SocketAddress address{a, k_artnet_port};
-								_artnet_socket->sendTo(packet_buffer.data(), packet_buffer.size(), address);
-							}
+								destinations.emplace_back(a, k_artnet_port);
 						}
 					}
 					else
 					{
 						if (config.is_broadcast_or_multicast)
 						{
-							Poco::Net::SocketAddress address{_artnet_broadcast_address, k_artnet_port};
-							_artnet_socket->sendTo(packet_buffer.data(), packet_buffer.size(), address);
+							add_artnet_broadcast_destinations(config.protocol_universe, destinations);
 						}
 						else
 						{
 							for (const auto& a : config.unicast_addresses)
-							{
-								Poco::Net::SocketAddress address{a, k_artnet_port};
-								_artnet_socket->sendTo(packet_buffer.data(), packet_buffer.size(), address);
-							}
+								destinations.emplace_back(a, k_artnet_port);
 						}
 					}
 				}
@@ -201,57 +470,28 @@ namespace lxmax
 
 				case dmx_protocol::sacn:
 				{
-					if (!_sacn_socket)
-						continue;
-
-					if (!is_sacn_packet_sent)
-					{
-						_sacn_sequence = _sacn_sequence >= 255 ? 0 : _sacn_sequence + 1;
-						is_sacn_packet_sent = true;
-					}
-
-					dmx_packet_sacn packet(_system_id, _system_name, config.priority,
-					                       _global_config.is_send_sacn_sync_packets
-						                       ? _global_config.sacn_sync_address
-						                       : 0,
-					                       _sacn_sequence, sacn_options_flags::none, config.protocol_universe,
-					                       data.value());
-					const auto packet_buffer = packet.serialize();
-
 					if (config.is_use_global_destination)
 					{
 						if (_global_config.is_sacn_global_destination_multicast)
 						{
-							Poco::Net::SocketAddress address{
-								get_sacn_multicast_address(config.protocol_universe), k_sacn_port
-							};
-							_sacn_socket->sendTo(packet_buffer.data(), packet_buffer.size(), address);
+							destinations.emplace_back(get_sacn_multicast_address(config.protocol_universe), k_sacn_port);
 						}
 						else
 						{
 							for (const auto& a : _global_config.sacn_global_destination_unicast_addresses)
-							{
-								Poco::Net::SocketAddress address{a, k_sacn_port};
-								_sacn_socket->sendTo(packet_buffer.data(), packet_buffer.size(), address);
-							}
+								destinations.emplace_back(a, k_sacn_port);
 						}
 					}
 					else
 					{
 						if (config.is_broadcast_or_multicast)
 						{
-							Poco::Net::SocketAddress address{
-								get_sacn_multicast_address(config.protocol_universe), k_sacn_port
-							};
-							_sacn_socket->sendTo(packet_buffer.data(), packet_buffer.size(), address);
+							destinations.emplace_back(get_sacn_multicast_address(config.protocol_universe), k_sacn_port);
 						}
 						else
 						{
 							for (const auto& a : config.unicast_addresses)
-							{
-								Poco::Net::SocketAddress address{a, k_sacn_port};
-								_sacn_socket->sendTo(packet_buffer.data(), packet_buffer.size(), address);
-							}
+								destinations.emplace_back(a, k_sacn_port);
 						}
 					}
 				}
@@ -259,33 +499,163 @@ namespace lxmax
 
 				default:
 					break;
-				}
 			}
-			catch (const Poco::Net::NetException& ex)
+
+			universe_destinations->push_back(std::move(destinations));
+		}
+
+		_universe_destinations = std::move(universe_destinations);
+	}
+
+	void dmx_output_service::reset_send_state()
+	{
+		// Deferred sends and token buckets may be in use by a frame being sent, so are left for the output thread
+		_is_send_state_reset_pending = true;
+
+		_universe_last_sent_times.assign(_universe_configs.size(), timestamp());
+		_rate_limited_universes.clear();
+	}
+
+	bool dmx_output_service::queue_universe_packets(const dmx_output_universe_config& config,
+	                                                const std::vector<Poco::Net::SocketAddress>& destinations,
+	                                                bool is_requeued_only, const universe_buffer& data, int channel_count)
+	{
+		if (destinations.empty())
+			return false;
+
+		Poco::Net::DatagramSocket* socket = nullptr;
+
+		switch (config.protocol)
+		{
+			case dmx_protocol::artnet:
+				socket = _send_artnet_socket.get();
+				break;
+
+			case dmx_protocol::sacn:
+				socket = _send_sacn_socket.get();
+				break;
+
+			default:
+				return false;
+		}
+
+		const size_t buffer_index = _pending_sends.empty() ? 0 : _pending_sends.back().buffer_index + 1;
+
+		if (buffer_index == _packet_buffers.size())
+			_packet_buffers.emplace_back();
+
+		// Packets and their buffers are reused, so once each buffer has held a packet this doesn't allocate
+		std::vector<char>& packet_buffer = _packet_buffers[buffer_index];
+
+		{
+			LXMAX_TRACE_SCOPE_ARG("output", "packet build", "universe", config.internal_universe);
+
+			if (config.protocol == dmx_protocol::artnet)
 			{
-				// TODO: Can't log to Max from this thread, implement a logging system based off a Max timer
-				//poco_error(_log, "Failed to send DMX data for internal universe %hu - %s", config.internal_universe, ex.message());
+				_artnet_packet.set_data(config.protocol_universe, _artnet_sequence, data, channel_count);
+				_artnet_packet.serialize(packet_buffer);
+			}
+			else
+			{
+				_sacn_packet.set_data(config.priority,
+				                      _global_config.is_send_sacn_sync_packets ? _global_config.sacn_sync_address : 0,
+				                      _sacn_sequence, config.protocol_universe, data);
+				_sacn_packet.serialize(packet_buffer);
 			}
 		}
 
-		if (_global_config.is_send_artnet_sync_packets && is_artnet_packet_sent)
-		{
-			sync_packet_artnet packet;
-			const auto packet_buffer = packet.serialize();
+		const size_t queued_count = _pending_sends.size();
 
-			Poco::Net::SocketAddress address{_artnet_broadcast_address, k_artnet_port};
-			_artnet_socket->sendTo(packet_buffer.data(), packet_buffer.size(), address);
+		if (is_requeued_only)
+		{
+			for (const auto& requeued : _requeued_sends)
+			{
+				if (requeued.internal_universe == config.internal_universe && requeued.destination_index < destinations.size())
+				{
+					_pending_sends.push_back({ socket, &destinations[requeued.destination_index], buffer_index,
+					                           config.internal_universe, requeued.destination_index });
+				}
+			}
+		}
+		else
+		{
+			for (size_t d = 0; d < destinations.size(); ++d)
+				_pending_sends.push_back({ socket, &destinations[d], buffer_index, config.internal_universe, d });
 		}
 
-		if (_global_config.is_send_sacn_sync_packets && is_sacn_packet_sent)
+		return _pending_sends.size() > queued_count;
+	}
+
+	void dmx_output_service::send_pending(timestamp frame_start)
+	{
+		LXMAX_TRACE_SCOPE_ARG("output", "send", "packets", _pending_sends.size());
+
+		const auto send_start = clock::now();
+
+		const bool is_pacing = _send_settings.is_pacing_enabled && _pending_sends.size() > 1;
+		const int max_packets_per_second = _send_settings.max_packets_per_second;
+
+		// Spread the frame's packets evenly over the configured fraction of the frame period
+		const auto window = _send_settings.window;
+		const auto window_end = frame_start + window;
+		const auto interval = is_pacing ? window / static_cast<long>(_pending_sends.size()) : clock::duration::zero();
+
+		for (size_t i = 0; i < _pending_sends.size(); ++i)
 		{
-			sync_packet_sacn packet(_system_id, _sacn_sync_sequence, _global_config.sacn_sync_address);
-			const auto packet_buffer = packet.serialize();
+			const auto& send = _pending_sends[i];
+
+			if (is_pacing)
+			{
+				const auto send_time = frame_start + interval * static_cast<long>(i);
+				if (clock::now() < send_time)
+					std::this_thread::sleep_until(send_time);
+			}
+
+			if (_send_settings.is_pacing_enabled && max_packets_per_second > 0)
+			{
+				auto bucket = _destination_buckets.find(send.address->host());
+				if (bucket == std::end(_destination_buckets))
+				{
+					bucket = _destination_buckets.emplace(send.address->host(),
+						token_bucket(max_packets_per_second, std::max(1, max_packets_per_second / k_dmx_framerate_max))).first;
+				}
+
+				auto time_now = clock::now();
+				if (!bucket->second.try_consume(time_now))
+				{
+					const auto available = bucket->second.next_available(time_now);
+
+					if (available > window_end)
+					{
+						// Node can't accept any more packets this frame, send it this universe again in the next one
+						_deferred_sends.push_back({ send.internal_universe, send.destination_index });
+						_deferred_destinations = _send_destinations;
+
+						++_counters.packets_deferred;
+						continue;
+					}
 
-			Poco::Net::SocketAddress address{get_sacn_multicast_address(_global_config.sacn_sync_address), k_sacn_port};
-			_sacn_socket->sendTo(packet_buffer.data(), packet_buffer.size(), address);
+					std::this_thread::sleep_until(available);
+					bucket->second.try_consume(clock::now());
+				}
+			}
 
-			_sacn_sync_sequence = _sacn_sync_sequence >= 255 ? 1 : _sacn_sync_sequence + 1;
+			try
+			{
+				const auto& buffer = _packet_buffers[send.buffer_index];
+				send.socket->sendTo(buffer.data(), static_cast<int>(buffer.size()), *send.address);
+				++_counters.packets_sent;
+			}
+			catch (const Poco::Net::NetException& ex)
+			{
+				// TODO: Can't log to Max from this thread, implement a logging system based off a Max timer
+				++_counters.send_errors;
+			}
 		}
+
+		if (is_pacing && clock::now() > window_end)
+			++_counters.pacing_overruns;
+
+		_counters.send_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - send_start).count();
 	}
 }
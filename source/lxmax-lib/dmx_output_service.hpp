@@ -6,30 +6,68 @@
 
 #pragma once
 
+#include <atomic>
 #include <cmath>
 #include <utility>
 #include <vector>
 #include <mutex>
 #include <memory>
+#include <unordered_map>
 #include <Poco/Logger.h>
 #include <Poco/Net/DatagramSocket.h>
 #include <Poco/Net/MulticastSocket.h>
-#include <Poco/Timer.h>
+#include <Poco/RunnableAdapter.h>
+#include <Poco/Thread.h>
 #include <Poco/UUIDGenerator.h>
 
+#include "artnet_discovery.hpp"
 #include "common.hpp"
 #include "hash_functions.hpp"
+#include "instrumented_mutex.hpp"
 #include "dmx_packet_artnet.hpp"
 #include "dmx_packet_sacn.hpp"
 #include "dmx_universe_config.hpp"
 #include "dmx_buffer_manager.hpp"
+#include "dmx_output_stats.hpp"
 #include "fixture_manager.hpp"
 #include "global_config.hpp"
 #include "preferences_manager.hpp"
+#include "token_bucket.hpp"
 
 
 namespace lxmax
 {
+	/// @brief Addresses each output universe is sent to, in the same order as the universe configs
+	using universe_destination_list = std::vector<std::vector<Poco::Net::SocketAddress>>;
+
+	/// @brief A serialized packet waiting to be sent to a single destination
+	///
+	/// The socket and address are kept alive by the frame's send state rather than the service config, so packets can be
+	/// sent after the config lock has been released.
+	struct dmx_output_pending_send
+	{
+		Poco::Net::DatagramSocket* socket;
+		const Poco::Net::SocketAddress* address;
+		size_t buffer_index;
+		universe_address internal_universe;
+		size_t destination_index;
+	};
+
+	/// @brief A universe's packet which the pacing couldn't send to one of its destinations this frame
+	struct dmx_output_deferred_send
+	{
+		universe_address internal_universe;
+		size_t destination_index;
+	};
+
+	/// @brief Pacing settings for sending a frame, copied from the global config while it's locked
+	struct dmx_output_send_settings
+	{
+		bool is_pacing_enabled { false };
+		int max_packets_per_second { 0 };
+		clock::duration window { };
+	};
+
 	class dmx_output_service
 	{
 		const milliseconds k_full_update_interval {1000};
@@ -38,58 +76,141 @@ namespace lxmax
 		
 		global_config _global_config;
 
-		bool _isRunning {false};
-		Poco::Timer _timer;
+		std::atomic<bool> _isRunning {false};
 
-		std::unique_ptr<Poco::Net::DatagramSocket> _artnet_socket;
-		std::unique_ptr<Poco::Net::MulticastSocket> _sacn_socket;
+		Poco::Thread _output_thread;
+		Poco::RunnableAdapter<dmx_output_service> _output_runnable;
+
+		std::shared_ptr<Poco::Net::DatagramSocket> _artnet_socket;
+		std::shared_ptr<Poco::Net::MulticastSocket> _sacn_socket;
 
 		Poco::Net::IPAddress _artnet_broadcast_address;
 
+		artnet_discovery _artnet_discovery;
+		uint64_t _artnet_discovery_generation { 0 };
+
 		std::shared_ptr<fixture_manager> _fixture_manager;
 		std::shared_ptr<dmx_buffer_manager> _buffer_manager;
 
-		std::mutex _config_mutex;
+		instrumented_mutex _config_mutex { "dmx_output_service config" };
 		std::vector<dmx_output_universe_config> _universe_configs;
 
+		// Replaced rather than modified, so a frame being sent keeps the destinations it queued packets for
+		std::shared_ptr<const universe_destination_list> _universe_destinations { std::make_shared<universe_destination_list>() };
+
+		clock::duration _frame_period { milliseconds(1000 / k_dmx_framerate_max) };
+
+		// Kept between frames along with their capacity, so steady state frames don't allocate
+		universe_updated_list _updated_universes;
+		std::vector<std::vector<char>> _packet_buffers;
+		std::vector<char> _sync_packet_buffer;
+		Poco::Net::SocketAddress _artnet_sync_address;
+		Poco::Net::SocketAddress _sacn_sync_address;
+
+		// Only accessed by the output thread, sending uses these rather than the config so it doesn't hold the config lock
+		std::shared_ptr<Poco::Net::DatagramSocket> _send_artnet_socket;
+		std::shared_ptr<Poco::Net::MulticastSocket> _send_sacn_socket;
+		std::shared_ptr<const universe_destination_list> _send_destinations;
+		dmx_output_send_settings _send_settings;
+		std::vector<dmx_output_pending_send> _pending_sends;
+		// Deferred sends index into the destinations they were deferred from, only sent again to those destinations
+		std::vector<dmx_output_deferred_send> _deferred_sends;
+		std::vector<dmx_output_deferred_send> _requeued_sends;
+		std::shared_ptr<const universe_destination_list> _deferred_destinations;
+		std::unordered_map<Poco::Net::IPAddress, token_bucket> _destination_buckets;
+		bool _is_artnet_packet_queued { false };
+		bool _is_sacn_packet_queued { false };
+
+		// Set when the config changes, the output thread clears its send state at the start of the next frame
+		bool _is_send_state_reset_pending { false };
+
+		std::vector<timestamp> _universe_last_sent_times;
+		universe_updated_list _rate_limited_universes;
+
+		dmx_output_counters _counters;
+
 		const std::string _system_name;
 		const Poco::UUID _system_id;
 
+		dmx_packet_artnet _artnet_packet;
+		dmx_packet_sacn _sacn_packet;
+
 		uint8_t _artnet_sequence = 1;
 		uint8_t _sacn_sequence = 0;
 		uint8_t _sacn_sync_sequence = 0;
 
 		timestamp _last_full_update_time;
+		timestamp _last_frame_time;
 
 
 	public:
 		dmx_output_service(Poco::Logger& log, std::shared_ptr<fixture_manager> fixture_manager, std::shared_ptr<dmx_buffer_manager> buffer_manager)
 			: _log(log),
+			_output_runnable(*this, &dmx_output_service::run),
+			_artnet_discovery(log),
 			_fixture_manager(std::move(fixture_manager)),
 			_buffer_manager(std::move(buffer_manager)),
 			_system_name(Poco::Environment::nodeName()),
-			_system_id(Poco::UUIDGenerator::defaultGenerator().createFromName(Poco::UUID(), _system_name))
+			_system_id(Poco::UUIDGenerator::defaultGenerator().createFromName(Poco::UUID(), _system_name)),
+			_sacn_packet(_system_id, _system_name, 100, 0, 0, sacn_options_flags::none, k_universe_sacn_min, universe_buffer { })
 		{
 			
 		}
 
 		void start()
 		{
-			_timer.start(Poco::TimerCallback<dmx_output_service>(*this, &dmx_output_service::on_timer));
 			_isRunning = true;
+			_output_thread.start(_output_runnable);
 		}
 
 		void stop()
 		{
-			_timer.stop();
-			_isRunning = false;
+			if (_isRunning.exchange(false))
+			{
+				_fixture_manager->notify_fixture_updated();
+				_output_thread.join();
+			}
+
+			_artnet_discovery.stop();
 		}
 
 		void update_global_config(const void* pSender);
 
 		void update_universe_configs(const void* pSender);
 
+		dmx_output_stats get_stats() const
+		{
+			return _counters.snapshot();
+		}
+
+		artnet_node_map get_artnet_nodes() const
+		{
+			return _artnet_discovery.get_nodes();
+		}
+
 	private:
-		void on_timer(Poco::Timer& timer);
+		void run();
+
+		timestamp next_output_time(bool is_update_pending) const;
+
+		/// @brief Writes fixtures to the buffers and queues the frame's packets, called with the config lock held
+		void output_frame(bool is_full_update, timestamp time_now);
+
+		/// @brief Sends the queued packets, called without the config lock as pacing sleeps between them
+		void send_pending(timestamp frame_start);
+
+		/// @brief Sends sync packets once the frame's packets are sent, called with the config lock held
+		void finish_frame();
+
+		/// @brief Rebuilds the destinations of each universe from the config and the discovered Art-Net nodes
+		void update_destinations();
+
+		/// @brief Forgets pacing and rate limiting state which may no longer apply after a config change
+		void reset_send_state();
+
+		/// @param is_requeued_only Only queue the packet for the destinations it was deferred from last frame
+		/// @returns false if the universe has no destinations to send to, so nothing was queued
+		bool queue_universe_packets(const dmx_output_universe_config& config, const std::vector<Poco::Net::SocketAddress>& destinations,
+		                            bool is_requeued_only, const universe_buffer& data, int channel_count);
 	};
 }
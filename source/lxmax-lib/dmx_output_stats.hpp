@@ -0,0 +1,56 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace lxmax
+{
+	/// @brief Snapshot of the DMX output service counters
+	/// 
+	struct dmx_output_stats
+	{
+		uint64_t frames_sent { 0 };
+		uint64_t packets_sent { 0 };
+		uint64_t packets_deferred { 0 };
+		uint64_t pacing_overruns { 0 };
+		uint64_t send_errors { 0 };
+		uint64_t wakeups { 0 };
+		uint64_t compose_nanoseconds { 0 };	// Writing fixtures to buffers and building packets
+		uint64_t send_nanoseconds { 0 };
+	};
+
+	/// @brief Counters updated by the DMX output thread which can be read from any thread
+	/// 
+	struct dmx_output_counters
+	{
+		std::atomic<uint64_t> frames_sent { 0 };
+		std::atomic<uint64_t> packets_sent { 0 };
+		std::atomic<uint64_t> packets_deferred { 0 };
+		std::atomic<uint64_t> pacing_overruns { 0 };
+		std::atomic<uint64_t> send_errors { 0 };
+		std::atomic<uint64_t> wakeups { 0 };
+		std::atomic<uint64_t> compose_nanoseconds { 0 };
+		std::atomic<uint64_t> send_nanoseconds { 0 };
+
+		dmx_output_stats snapshot() const
+		{
+			dmx_output_stats stats;
+
+			stats.frames_sent = frames_sent;
+			stats.packets_sent = packets_sent;
+			stats.packets_deferred = packets_deferred;
+			stats.pacing_overruns = pacing_overruns;
+			stats.send_errors = send_errors;
+			stats.wakeups = wakeups;
+			stats.compose_nanoseconds = compose_nanoseconds;
+			stats.send_nanoseconds = send_nanoseconds;
+
+			return stats;
+		}
+	};
+}
@@ -6,7 +6,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
 #include "common.hpp"
@@ -18,9 +21,15 @@ namespace lxmax
 
 	static const char* k_artnet_id = "Art-Net";
 	const uint16_t k_artnet_prot_ver = 14;
+	const uint16_t k_artnet_opcode_poll = 0x2000;
+	const uint16_t k_artnet_opcode_poll_reply = 0x2100;
 	const uint16_t k_artnet_opcode_dmx = 0x5000;
 	const uint16_t k_artnet_opcode_sync = 0x5200;
 
+	const uint8_t k_artnet_poll_flag_reply_on_change = 0x02;
+	const uint8_t k_artnet_diag_priority_low = 0x10;
+	const uint8_t k_artnet_port_type_output = 0x80;
+
 	#pragma pack(push, 1)
     struct artdmx_header
     {
@@ -57,13 +66,22 @@ namespace lxmax
 
 		dmx_packet_artnet() = default;
 
-		dmx_packet_artnet(universe_address address, uint8_t sequence, const universe_buffer& data)
-			: dmx_channels(data.size())
+		/// @param length Number of channels to send. Art-Net requires an even length from 2 to 512, so this is rounded up.
+		dmx_packet_artnet(universe_address address, uint8_t sequence, const universe_buffer& data, size_t length = k_universe_length)
 		{
+			set_data(address, sequence, data, length);
+		}
+
+		/// @brief Sets the packet's universe and data, reusing its channel storage
+		/// @param length Number of channels to send, rounded up as in the constructor
+		void set_data(universe_address address, uint8_t sequence, const universe_buffer& data, size_t length = k_universe_length)
+		{
+			dmx_channels.resize(std::clamp<size_t>(length + (length & 1), 2, k_universe_length));
+
 			header.sub_uni = address & 0x00FF;
 			header.net = (address & 0x7F00) >> 8;
 			header.sequence = sequence;
-			header.length = k_universe_length;
+			header.length = static_cast<uint16_t>(dmx_channels.size());
 			memcpy(dmx_channels.data(), data.data(),std::min(data.size(), dmx_channels.size()));
 		}
 
@@ -96,12 +114,19 @@ namespace lxmax
 
 		std::vector<char> serialize() const noexcept
 		{
-			std::vector<char> buffer(sizeof(artdmx_header) + dmx_channels.size());
+			std::vector<char> buffer;
+			serialize(buffer);
+
+			return buffer;
+		}
+
+		/// @brief Serializes into an existing buffer, which only allocates if it has never held a packet this size
+		void serialize(std::vector<char>& buffer) const noexcept
+		{
+			buffer.resize(sizeof(artdmx_header) + dmx_channels.size());
 
 			memcpy(buffer.data(), &header, sizeof(artdmx_header));
 			memcpy(buffer.data() + sizeof(artdmx_header), dmx_channels.data(), dmx_channels.size());
-
-			return buffer;
 		}
 	};
 
@@ -141,12 +166,141 @@ namespace lxmax
 
 		std::vector<char> serialize() const noexcept
 		{
-			std::vector<char> buffer(sizeof(sync_packet_artnet));
+			std::vector<char> buffer;
+			serialize(buffer);
+
+			return buffer;
+		}
+
+		void serialize(std::vector<char>& buffer) const noexcept
+		{
+			buffer.resize(sizeof(sync_packet_artnet));
 
 			memcpy(buffer.data(), this, sizeof(sync_packet_artnet));
+		}
+    };
+	#pragma pack(pop)
+
+	#pragma pack(push, 1)
+	struct artpoll_packet
+	{
+		char id[8];
+		uint16_t opcode;
+		uint16_t_be prot_ver;
+		uint8_t flags;
+		uint8_t diag_priority;
+
+		artpoll_packet()
+			: opcode(k_artnet_opcode_poll),
+			prot_ver(k_artnet_prot_ver),
+			flags(k_artnet_poll_flag_reply_on_change),
+			diag_priority(k_artnet_diag_priority_low)
+		{
+			memcpy(id, k_artnet_id, sizeof(id));
+		}
+
+		static bool deserialize(const char* data, size_t length, artpoll_packet& packet)
+		{
+			if (length < sizeof(artpoll_packet))
+				return false;
+
+			memcpy(&packet, data, sizeof(artpoll_packet));
+
+			if (strncmp(packet.id, k_artnet_id, sizeof(packet.id)) != 0)
+				return false;
+
+			return packet.opcode == k_artnet_opcode_poll;
+		}
+
+		std::vector<char> serialize() const noexcept
+		{
+			std::vector<char> buffer(sizeof(artpoll_packet));
+
+			memcpy(buffer.data(), this, sizeof(artpoll_packet));
 
 			return buffer;
 		}
-    };
+	};
+	#pragma pack(pop)
+
+	#pragma pack(push, 1)
+	struct artpollreply_packet
+	{
+		char id[8];
+		uint16_t opcode;
+		uint8_t ip_address[4];
+		uint16_t port;
+		uint16_t_be version_info;
+		uint8_t net_switch;
+		uint8_t sub_switch;
+		uint16_t_be oem;
+		uint8_t ubea_version;
+		uint8_t status_1;
+		uint16_t esta_manufacturer;
+		char short_name[18];
+		char long_name[64];
+		char node_report[64];
+		uint16_t_be num_ports;
+		uint8_t port_types[4];
+		uint8_t good_input[4];
+		uint8_t good_output[4];
+		uint8_t sw_in[4];
+		uint8_t sw_out[4];
+		uint8_t acn_priority;
+		uint8_t sw_macro;
+		uint8_t sw_remote;
+		uint8_t spare[3];
+		uint8_t style;
+		uint8_t mac[6];
+		uint8_t bind_ip[4];
+		uint8_t bind_index;
+		uint8_t status_2;
+		uint8_t filler[26];
+
+		artpollreply_packet()
+		{
+			memset(this, 0, sizeof(artpollreply_packet));
+			memcpy(id, k_artnet_id, sizeof(id));
+			opcode = k_artnet_opcode_poll_reply;
+			port = k_artnet_port;
+		}
+
+		/// @brief Gets the 15-bit Art-Net port-address of one of the node's ports
+		universe_address port_address(int port_index, bool is_output) const
+		{
+			return ((net_switch & 0x7F) << 8)
+				+ ((sub_switch & 0x0F) << 4)
+				+ ((is_output ? sw_out[port_index] : sw_in[port_index]) & 0x0F);
+		}
+
+		bool is_output_port(int port_index) const
+		{
+			return port_index < std::min<int>(num_ports, 4) && (port_types[port_index] & k_artnet_port_type_output) != 0;
+		}
+
+		static bool deserialize(const char* data, size_t length, artpollreply_packet& packet)
+		{
+			// Older nodes send a shorter packet without the fields following the MAC address
+			if (length < offsetof(artpollreply_packet, bind_ip))
+				return false;
+
+			packet = artpollreply_packet();
+			memcpy(&packet, data, std::min(length, sizeof(artpollreply_packet)));
+
+			if (strncmp(packet.id, k_artnet_id, sizeof(packet.id)) != 0)
+				return false;
+
+			return packet.opcode == k_artnet_opcode_poll_reply;
+		}
+
+		std::vector<char> serialize() const noexcept
+		{
+			std::vector<char> buffer(sizeof(artpollreply_packet));
+
+			memcpy(buffer.data(), this, sizeof(artpollreply_packet));
+
+			return buffer;
+		}
+	};
 	#pragma pack(pop)
 }
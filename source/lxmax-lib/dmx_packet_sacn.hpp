@@ -212,6 +212,18 @@ namespace lxmax
 			memcpy(dmx_channels.data(), data.data(), std::min(data.size(), dmx_channels.size()));
 		}
 
+		/// @brief Sets the packet's universe and data, reusing its channel storage
+		void set_data(uint8_t priority, universe_address sync_address, uint8_t sequence, universe_address universe,
+		              const universe_buffer& data)
+		{
+			framing_layer.priority = priority;
+			framing_layer.sync_address = static_cast<uint16_t>(sync_address);
+			framing_layer.sequence = sequence;
+			framing_layer.universe = static_cast<uint16_t>(universe);
+
+			memcpy(dmx_channels.data(), data.data(), std::min(data.size(), dmx_channels.size()));
+		}
+
 		static bool deserialize(char* data, size_t length, dmx_packet_sacn& packet)
 		{
 			if (length < k_min_sacn_dmx_packet_length)
@@ -248,15 +260,22 @@ namespace lxmax
 
 		std::vector<char> serialize() const noexcept
 		{
-			std::vector<char> buffer(sizeof(sacn_root_layer) + sizeof(sacn_framing_layer_data) + sizeof(sacn_dmp_layer) + dmx_channels.size());
+			std::vector<char> buffer;
+			serialize(buffer);
+
+			return buffer;
+		}
+
+		/// @brief Serializes into an existing buffer, which only allocates if it has never held a packet this size
+		void serialize(std::vector<char>& buffer) const noexcept
+		{
+			buffer.resize(sizeof(sacn_root_layer) + sizeof(sacn_framing_layer_data) + sizeof(sacn_dmp_layer) + dmx_channels.size());
 
 			memcpy(buffer.data(), &root_layer, sizeof(sacn_root_layer));
 			memcpy(buffer.data() + sizeof(sacn_root_layer), &framing_layer, sizeof(sacn_framing_layer_data));
 			memcpy(buffer.data() + sizeof(sacn_root_layer) + sizeof(sacn_framing_layer_data), &dmp_layer, sizeof(sacn_dmp_layer));
 			memcpy(buffer.data() + sizeof(sacn_root_layer) + sizeof(sacn_framing_layer_data) + sizeof(sacn_dmp_layer),
 				dmx_channels.data(), dmx_channels.size());
-
-			return buffer;
 		}
 	};
 
@@ -290,12 +309,18 @@ namespace lxmax
 
 		std::vector<char> serialize() const noexcept
 		{
-			std::vector<char> buffer(sizeof(sacn_root_layer) + sizeof(sacn_framing_layer_sync));
+			std::vector<char> buffer;
+			serialize(buffer);
+
+			return buffer;
+		}
+
+		void serialize(std::vector<char>& buffer) const noexcept
+		{
+			buffer.resize(sizeof(sacn_root_layer) + sizeof(sacn_framing_layer_sync));
 
 			memcpy(buffer.data(), &root_layer, sizeof(sacn_root_layer));
 			memcpy(buffer.data() + sizeof(sacn_root_layer), &framing_layer, sizeof(sacn_framing_layer_sync));
-
-			return buffer;
 		}
     };
 }
@@ -0,0 +1,275 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "emitter_extraction.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace lxmax
+{
+	namespace
+	{
+		using vector3 = std::array<double, 3>;
+		using matrix3 = std::array<vector3, 3>;
+
+		// Linear sRGB (D65) to CIE XYZ
+		const matrix3 k_srgb_to_xyz
+		{{
+			{ 0.4124564, 0.3575761, 0.1804375 },
+			{ 0.2126729, 0.7151522, 0.0721750 },
+			{ 0.0193339, 0.1191920, 0.9503041 }
+		}};
+
+		vector3 multiply(const matrix3& m, const vector3& v)
+		{
+			return
+			{
+				m[0][0] * v[0] + m[0][1] * v[1] + m[0][2] * v[2],
+				m[1][0] * v[0] + m[1][1] * v[1] + m[1][2] * v[2],
+				m[2][0] * v[0] + m[2][1] * v[1] + m[2][2] * v[2]
+			};
+		}
+
+		bool invert(const matrix3& m, matrix3& inverse)
+		{
+			const double determinant = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+				- m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+				+ m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+
+			if (std::abs(determinant) < 1e-12)
+				return false;
+
+			const double f = 1. / determinant;
+
+			inverse[0][0] = (m[1][1] * m[2][2] - m[1][2] * m[2][1]) * f;
+			inverse[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * f;
+			inverse[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * f;
+			inverse[1][0] = (m[1][2] * m[2][0] - m[1][0] * m[2][2]) * f;
+			inverse[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * f;
+			inverse[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * f;
+			inverse[2][0] = (m[1][0] * m[2][1] - m[1][1] * m[2][0]) * f;
+			inverse[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * f;
+			inverse[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * f;
+
+			return true;
+		}
+
+		vector3 to_xyz(const emitter_chromaticity& c)
+		{
+			if (c.y <= 0)
+				return { 0, 0, 0 };
+
+			return { c.x * c.luminance / c.y, c.luminance, (1. - c.x - c.y) * c.luminance / c.y };
+		}
+
+		/// @brief Gets how much of an emitter, expressed in red, green and blue, can replace those levels
+		double get_replaceable_amount(const vector3& levels, const vector3& emitter)
+		{
+			double amount = std::numeric_limits<double>::max();
+			bool is_limited = false;
+
+			for (size_t i = 0; i < 3; ++i)
+			{
+				if (emitter[i] > 1e-9)
+				{
+					amount = std::min(amount, levels[i] / emitter[i]);
+					is_limited = true;
+				}
+			}
+
+			return is_limited ? std::max(0., amount) : 0.;
+		}
+
+		emitter_values solve_unscaled(const emitter_calibration& calibration, emitter_set set, const color_values& rgb)
+		{
+			const vector3 red = to_xyz(calibration.red);
+			const vector3 green = to_xyz(calibration.green);
+			const vector3 blue = to_xyz(calibration.blue);
+
+			const matrix3 emitters
+			{{
+				{ red[0], green[0], blue[0] },
+				{ red[1], green[1], blue[1] },
+				{ red[2], green[2], blue[2] }
+			}};
+
+			matrix3 xyz_to_emitters;
+			if (!invert(emitters, xyz_to_emitters))
+				return extract_emitters(rgb, set);
+
+			vector3 levels = multiply(xyz_to_emitters, multiply(k_srgb_to_xyz, rgb));
+
+			emitter_values values;
+
+			if (has_white(set))
+			{
+				const vector3 white = multiply(xyz_to_emitters, to_xyz(calibration.white));
+				values.white = get_replaceable_amount(levels, white);
+
+				for (size_t i = 0; i < 3; ++i)
+					levels[i] -= values.white * white[i];
+			}
+
+			if (has_amber(set))
+			{
+				const vector3 amber = multiply(xyz_to_emitters, to_xyz(calibration.amber));
+				values.amber = get_replaceable_amount(levels, amber);
+
+				for (size_t i = 0; i < 3; ++i)
+					levels[i] -= values.amber * amber[i];
+			}
+
+			// Colors outside the emitters' gamut are clipped
+			values.red = std::max(0., levels[0]);
+			values.green = std::max(0., levels[1]);
+			values.blue = std::max(0., levels[2]);
+
+			return values;
+		}
+
+		double get_calibration_scale(const emitter_calibration& calibration, emitter_set set)
+		{
+			double max_level = 0;
+
+			for (int corner = 1; corner < 8; ++corner)
+			{
+				const color_values rgb { double(corner & 1), double((corner >> 1) & 1), double((corner >> 2) & 1) };
+				const emitter_values values = solve_unscaled(calibration, set, rgb);
+
+				max_level = std::max({ max_level, values.red, values.green, values.blue, values.white, values.amber });
+			}
+
+			return max_level > 0 ? 1. / max_level : 0.;
+		}
+
+		emitter_values scale_and_clamp(emitter_values values, double scale)
+		{
+			values.red = std::clamp(values.red * scale, 0., 1.);
+			values.green = std::clamp(values.green * scale, 0., 1.);
+			values.blue = std::clamp(values.blue * scale, 0., 1.);
+			values.white = std::clamp(values.white * scale, 0., 1.);
+			values.amber = std::clamp(values.amber * scale, 0., 1.);
+
+			return values;
+		}
+	}
+
+	emitter_values extract_emitters(const color_values& rgb, emitter_set set)
+	{
+		emitter_values values;
+		values.red = std::clamp(rgb[0], 0., 1.);
+		values.green = std::clamp(rgb[1], 0., 1.);
+		values.blue = std::clamp(rgb[2], 0., 1.);
+
+		if (has_white(set))
+		{
+			values.white = std::min({ values.red, values.green, values.blue });
+			values.red -= values.white;
+			values.green -= values.white;
+			values.blue -= values.white;
+		}
+
+		if (has_amber(set))
+		{
+			values.amber = std::min(values.red, values.green * 2.);
+			values.red -= values.amber;
+			values.green -= values.amber / 2.;
+		}
+
+		return values;
+	}
+
+	emitter_lut::emitter_lut(const emitter_calibration& calibration, emitter_set set)
+		: _calibration(calibration),
+		_set(set)
+	{
+		const double scale = get_calibration_scale(calibration, set);
+
+		_table.reserve(k_grid_size * k_grid_size * k_grid_size);
+
+		for (int r = 0; r < k_grid_size; ++r)
+		{
+			for (int g = 0; g < k_grid_size; ++g)
+			{
+				for (int b = 0; b < k_grid_size; ++b)
+				{
+					const color_values rgb { double(r) / (k_grid_size - 1), double(g) / (k_grid_size - 1), double(b) / (k_grid_size - 1) };
+					const emitter_values values = scale_and_clamp(solve_unscaled(calibration, set, rgb), scale);
+
+					_table.push_back({ float(values.red), float(values.green), float(values.blue), float(values.white), float(values.amber) });
+				}
+			}
+		}
+	}
+
+	emitter_values emitter_lut::lookup(const color_values& rgb) const
+	{
+		int index[3];
+		double fraction[3];
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const double position = std::clamp(rgb[i], 0., 1.) * (k_grid_size - 1);
+			index[i] = std::min(static_cast<int>(position), k_grid_size - 2);
+			fraction[i] = position - index[i];
+		}
+
+		std::array<double, 5> result { };
+
+		// Trilinear interpolation between the eight surrounding grid points
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			const int dr = corner & 1;
+			const int dg = (corner >> 1) & 1;
+			const int db = (corner >> 2) & 1;
+
+			const double weight = (dr ? fraction[0] : 1. - fraction[0])
+				* (dg ? fraction[1] : 1. - fraction[1])
+				* (db ? fraction[2] : 1. - fraction[2]);
+
+			const auto& entry = _table[((index[0] + dr) * k_grid_size + index[1] + dg) * k_grid_size + index[2] + db];
+
+			for (size_t i = 0; i < result.size(); ++i)
+				result[i] += weight * entry[i];
+		}
+
+		emitter_values values;
+		values.red = result[0];
+		values.green = result[1];
+		values.blue = result[2];
+		values.white = result[3];
+		values.amber = result[4];
+
+		return values;
+	}
+
+	emitter_values emitter_lut::solve(const emitter_calibration& calibration, emitter_set set, const color_values& rgb)
+	{
+		return scale_and_clamp(solve_unscaled(calibration, set, rgb), get_calibration_scale(calibration, set));
+	}
+
+	std::shared_ptr<const emitter_lut> emitter_lut_cache::get(const emitter_calibration& calibration, emitter_set set)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_luts.erase(std::remove_if(std::begin(_luts), std::end(_luts),
+		                           [](const std::weak_ptr<const emitter_lut>& l) { return l.expired(); }),
+		            std::end(_luts));
+
+		for (const auto& l : _luts)
+		{
+			auto lut = l.lock();
+			if (lut && lut->set() == set && lut->calibration() == calibration)
+				return lut;
+		}
+
+		auto lut = std::make_shared<const emitter_lut>(calibration, set);
+		_luts.push_back(lut);
+
+		return lut;
+	}
+}
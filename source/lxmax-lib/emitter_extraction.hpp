@@ -0,0 +1,131 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "color_component.hpp"
+
+namespace lxmax
+{
+	/// @brief Emitters available on a fixture in addition to red, green and blue
+	///
+	enum class emitter_set
+	{
+		rgb,
+		rgbw,
+		rgba,
+		rgbwa
+	};
+
+	inline bool has_white(emitter_set set)
+	{
+		return set == emitter_set::rgbw || set == emitter_set::rgbwa;
+	}
+
+	inline bool has_amber(emitter_set set)
+	{
+		return set == emitter_set::rgba || set == emitter_set::rgbwa;
+	}
+
+	/// @brief Normalized level of each emitter
+	///
+	struct emitter_values
+	{
+		double red { 0 };
+		double green { 0 };
+		double blue { 0 };
+		double white { 0 };
+		double amber { 0 };
+	};
+
+	/// @brief Splits an RGB color across the emitters in the set without calibration data
+	///
+	/// White takes the level common to red, green and blue. Amber is treated as full red with half green and takes
+	/// as much of the remaining red and green as it can.
+	emitter_values extract_emitters(const color_values& rgb, emitter_set set);
+
+	/// @brief Color of a single emitter at full output
+	///
+	struct emitter_chromaticity
+	{
+		double x { 0 };				///< CIE 1931 x
+		double y { 0 };				///< CIE 1931 y
+		double luminance { 0 };		///< Relative luminance (Y)
+
+		friend bool operator==(const emitter_chromaticity& lhs, const emitter_chromaticity& rhs)
+		{
+			return lhs.x == rhs.x && lhs.y == rhs.y && lhs.luminance == rhs.luminance;
+		}
+	};
+
+	/// @brief Measured colors of a fixture's emitters
+	///
+	struct emitter_calibration
+	{
+		emitter_chromaticity red;
+		emitter_chromaticity green;
+		emitter_chromaticity blue;
+		emitter_chromaticity white;
+		emitter_chromaticity amber;
+
+		friend bool operator==(const emitter_calibration& lhs, const emitter_calibration& rhs)
+		{
+			return lhs.red == rhs.red && lhs.green == rhs.green && lhs.blue == rhs.blue
+				&& lhs.white == rhs.white && lhs.amber == rhs.amber;
+		}
+	};
+
+	/// @brief Calibrated emitter levels for a grid of RGB colors, interpolated between grid points
+	///
+	/// Solving for a calibrated color is too slow to do per frame, so the solutions are computed once when the
+	/// table is built and a lookup costs the same however the calibration is defined.
+	class emitter_lut
+	{
+	public:
+		static const int k_grid_size = 17;
+
+	private:
+		emitter_calibration _calibration;
+		emitter_set _set;
+		std::vector<std::array<float, 5>> _table;
+
+	public:
+		emitter_lut(const emitter_calibration& calibration, emitter_set set);
+
+		const emitter_calibration& calibration() const
+		{
+			return _calibration;
+		}
+
+		emitter_set set() const
+		{
+			return _set;
+		}
+
+		emitter_values lookup(const color_values& rgb) const;
+
+		/// @brief Solves for the emitter levels reproducing an sRGB color
+		///
+		/// Red, green and blue reproduce the color, then white and amber replace as much of them as they can
+		/// without changing it. Levels are scaled so the brightest corner of the RGB cube reaches full output.
+		static emitter_values solve(const emitter_calibration& calibration, emitter_set set, const color_values& rgb);
+	};
+
+	/// @brief Shares emitter LUTs between fixtures with the same calibration
+	///
+	class emitter_lut_cache
+	{
+		std::mutex _mutex;
+		std::vector<std::weak_ptr<const emitter_lut>> _luts;
+
+	public:
+		std::shared_ptr<const emitter_lut> get(const emitter_calibration& calibration, emitter_set set);
+	};
+}
@@ -7,6 +7,7 @@
 
 #include <utility>
 #include "fixture_manager.hpp"
+#include "trace.hpp"
 
 namespace lxmax
 {
@@ -24,6 +25,11 @@ namespace lxmax
 	}
 
 	fixture::~fixture()
+	{
+		unregister_from_manager();
+	}
+
+	void fixture::unregister_from_manager()
 	{
 		if (_manager)
 			_manager->unregister_fixture(this);
@@ -39,7 +45,12 @@ namespace lxmax
 
 	void fixture::set_updated()
 	{
-		_is_updated = true;
-		_last_updated = clock::now();
+		LXMAX_TRACE_INSTANT_ARG("fixture", "value update", "universe", universe());
+
+		_last_updated.store(clock::now().time_since_epoch().count(), std::memory_order_release);
+		_is_updated.store(true, std::memory_order_release);
+
+		if (_manager)
+			_manager->notify_fixture_updated();
 	}
 }
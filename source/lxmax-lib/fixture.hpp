@@ -7,6 +7,7 @@
 
 #include <atomic>
 #include "common.hpp"
+#include "fixture_batch.hpp"
 #include "fixture_patch_info.hpp"
 
 namespace lxmax
@@ -18,13 +19,25 @@ namespace lxmax
 		std::shared_ptr<fixture_manager> _manager;
 		fixture_patch_info _patch_info;
 		std::atomic<bool> _is_updated { true };
-		timestamp _last_updated { timestamp::min() };
+		// Stored before _is_updated is set, so a reader which sees the update also sees its time
+		std::atomic<clock::rep> _last_updated { timestamp::min().time_since_epoch().count() };
+		bool _is_streaming { false };
 
 	protected:
-		bool is_updated() const { return _is_updated; }
+		/// @brief Marks the fixture as changing every frame without calling set_updated, must be called before set_manager
+		void set_streaming(bool is_streaming)
+		{
+			_is_streaming = is_streaming;
+		}
 
 		void set_patch_info(fixture_patch_info info);
 
+		/// @brief Removes the fixture from its manager, after which the output thread no longer calls write_to_buffer
+		///
+		/// Derived classes should call this first thing in their destructor, as by the time the base destructor
+		/// unregisters the fixture their members have already been destroyed.
+		void unregister_from_manager();
+
 	public:
 		fixture() = default;
 
@@ -39,8 +52,18 @@ namespace lxmax
 
 		virtual bool write_to_buffer(const fixture_patch_info& patch_info, universe_buffer_map& buffer_map, universe_updated_list& updated_universes, bool is_force) = 0;
 
+		/// @brief Writer the manager uses for this fixture, batched with others of the same type, when nothing overlaps it
+		///
+		/// Fixture types without one are written individually through write_to_buffer.
+		virtual fixture_batch_writer batch_writer() const
+		{
+			return nullptr;
+		}
+
 		void set_updated();
 
+		bool is_updated() const { return _is_updated.load(std::memory_order_acquire); }
+
 		void clear_updated()
 		{
 			_is_updated = false;
@@ -48,7 +71,7 @@ namespace lxmax
 
 		timestamp last_updated() const
 		{
-			return _last_updated;
+			return timestamp(clock::duration(_last_updated.load(std::memory_order_acquire)));
 		}
 
 		int channel() const
@@ -65,5 +88,10 @@ namespace lxmax
 		{
 			return _patch_info.is_htp;
 		}
+
+		bool is_streaming() const
+		{
+			return _is_streaming;
+		}
 	};
 }
@@ -0,0 +1,96 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <vector>
+
+#include "common.hpp"
+#include "fixture_patch_info.hpp"
+
+namespace lxmax
+{
+	class fixture;
+
+	/// @brief A fixture and its patch as passed to a batch writer
+	struct fixture_batch_record
+	{
+		fixture* instance;
+		const fixture_patch_info* patch_info;
+	};
+
+	/// @brief Writes a batch of fixtures of one concrete type to the universe buffers
+	using fixture_batch_writer = void (*)(const fixture_batch_record* records, size_t count, universe_buffer_map& buffer_map,
+	                                      universe_updated_list& updated_universes, bool is_force);
+
+	/// @brief Fixtures of the same type, in channel order, which don't share channels with any other fixture
+	struct fixture_batch
+	{
+		fixture_batch_writer writer;
+		std::vector<fixture_batch_record> records;
+	};
+
+	/// @brief Batch writer for any fixture type, calling T::write_to_buffer directly so it can be inlined
+	template <typename T>
+	void write_fixture_batch(const fixture_batch_record* records, size_t count, universe_buffer_map& buffer_map,
+	                         universe_updated_list& updated_universes, bool is_force)
+	{
+		for (size_t i = 0; i < count; ++i)
+			static_cast<T*>(records[i].instance)->T::write_to_buffer(*records[i].patch_info, buffer_map, updated_universes, is_force);
+	}
+
+	/// @brief Batch writer for fixture types which only write to their start universe, through T::write_to_universe
+	///
+	/// Records are in channel order, so each universe buffer is looked up once per run of fixtures patched to it rather
+	/// than once per fixture. T::write_to_universe is only called for fixtures which are updated or forced.
+	template <typename T>
+	void write_universe_fixture_batch(const fixture_batch_record* records, size_t count, universe_buffer_map& buffer_map,
+	                                  universe_updated_list& updated_universes, bool is_force)
+	{
+		auto buffer = std::end(buffer_map);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			T& f = *static_cast<T*>(records[i].instance);
+			if (!is_force && !f.is_updated())
+				continue;
+
+			const fixture_patch_info& patch_info = *records[i].patch_info;
+			const universe_address universe = patch_info.channel_range.start_universe();
+
+			if (buffer == std::end(buffer_map) || buffer->first != universe)
+			{
+				buffer = buffer_map.find(universe);
+				if (buffer == std::end(buffer_map))
+					continue;
+			}
+
+			if (updated_universes.empty() || updated_universes.back() != universe)
+				updated_universes.push_back(universe);
+
+			f.write_to_universe(patch_info, buffer->second);
+		}
+	}
+
+	/// @brief Writes a single fixture the same way write_universe_fixture_batch does, for implementing T::write_to_buffer
+	template <typename T>
+	bool write_universe_fixture(T& f, const fixture_patch_info& patch_info, universe_buffer_map& buffer_map,
+	                            universe_updated_list& updated_universes, bool is_force)
+	{
+		if (!is_force && !f.is_updated())
+			return false;
+
+		const universe_address universe = patch_info.channel_range.start_universe();
+
+		const auto buffer = buffer_map.find(universe);
+		if (buffer == std::end(buffer_map))
+			return false;
+
+		updated_universes.push_back(universe);
+		f.write_to_universe(patch_info, buffer->second);
+
+		return true;
+	}
+}
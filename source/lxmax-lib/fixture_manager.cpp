@@ -5,97 +5,403 @@
 
 #include "fixture_manager.hpp"
 
-#include <set>
+#include <algorithm>
+#include <thread>
 
 
 #include "dmx_buffer_manager.hpp"
 #include "fixture.hpp"
+#include "trace.hpp"
 
 namespace lxmax
 {
-	bool fixture_last_updated_compare::operator()(const fixture_map_entry& lhs, const fixture_map_entry& rhs) const
-	{
-		return lhs.first->last_updated() < rhs.first->last_updated();
-	}
-
 	void fixture_manager::register_fixture(fixture* fixture, const fixture_patch_info& patch_info)
 	{
-		std::lock_guard<std::mutex> lock(_mutex);
+		{
+			std::lock_guard<instrumented_mutex> lock(_mutex);
+
+			_fixtures[fixture] = patch_info;
 
-		_fixtures.erase(fixture);
-		_fixtures.insert(std::make_pair(fixture, fixture_info(patch_info)));
+			const timestamp time_now = clock::now();
 
-		update_fixture_overlaps();
+			if (!_has_pending_registrations)
+				_first_pending_registration_time = time_now;
+
+			_last_registration_time = time_now;
+			_has_pending_registrations = true;
+		}
+
+		// Wakes the output thread, which publishes the registration at a frame boundary
+		notify_fixture_updated();
 	}
 
 	void fixture_manager::unregister_fixture(fixture* fixture)
 	{
-		std::lock_guard<std::mutex> lock(_mutex);
-		
-		const int erased_count = _fixtures.erase(fixture);
+		{
+			std::lock_guard<instrumented_mutex> lock(_mutex);
+
+			if (_fixtures.erase(fixture) == 0)
+				return;
 
-		if (erased_count > 0)
-			update_fixture_overlaps();
+			// A fixture whose registration is still queued was never seen by the output thread
+			const auto snapshot = get_snapshot();
+			if (std::none_of(std::begin(snapshot->fixtures), std::end(snapshot->fixtures),
+			                 [fixture](const fixture_snapshot_entry& entry) { return entry.instance == fixture; }))
+				return;
+
+			publish_snapshot();
+		}
+
+		// The fixture is about to be destroyed, so must be finished with by any write still using an older snapshot
+		wait_for_write_to_buffer();
 	}
 
 	universe_updated_list fixture_manager::write_to_buffer(bool is_force)
 	{
-		std::lock_guard<std::mutex> lock(_mutex);
+		universe_updated_list updated_universes;
+		write_to_buffer(updated_universes, is_force);
 
-		auto lock_and_buffers = _buffer_manager->get_universe_buffers();
-		universe_buffer_map& buffers = std::get<1>(lock_and_buffers);
+		return updated_universes;
+	}
 
-		universe_updated_list updated_universes;
+	void fixture_manager::flush_registrations()
+	{
+		std::lock_guard<instrumented_mutex> lock(_mutex);
 
-		std::set<fixture_map_entry, fixture_last_updated_compare> sorted_fixtures(_fixtures.begin(), _fixtures.end());
+		if (_has_pending_registrations)
+			publish_snapshot();
+	}
 
-		std::vector<fixture*> fixtures_written_to_buffer;
-		
-		for (const fixture_map_entry& entry : sorted_fixtures)
+	void fixture_manager::write_to_buffer(universe_updated_list& updated_universes, bool is_force)
+	{
+		std::lock_guard<instrumented_mutex> lock(_write_mutex);
+
+		if (_has_pending_registrations)
+			try_publish_pending_registrations();
+
+		// Only one thread writes at a time, so the epoch is odd from here until the write is finished
+		_write_epoch.fetch_add(1);
+
+		const std::shared_ptr<const fixture_snapshot> snapshot = get_snapshot();
+		const std::vector<fixture_snapshot_entry>& fixtures = snapshot->fixtures;
+
+		LXMAX_TRACE_SCOPE_ARG("output", "fixture walk", "fixtures", fixtures.size());
+
+		const std::vector<fixture_partition>& partitions = snapshot->partitions;
+
+		// Channels may have been released by the new patch, so ownership is resolved again from every fixture
+		if (snapshot != _written_snapshot)
 		{
-			bool can_write = true;
+			_written_snapshot = snapshot;
+
+			while (_partition_states.size() < partitions.size())
+				_partition_states.push_back(std::make_unique<partition_state>());
+
+			for (auto& state : _partition_states)
+				state->channel_owners.reset();
+
+			is_force = true;
+		}
 
-			if (!entry.second.patch_info.is_htp)
+		// Streaming fixtures change every frame, so are treated as updated now
+		const timestamp time_now = clock::now();
+
+		{
+			auto lock_and_buffers = _buffer_manager->get_universe_buffers();
+			universe_buffer_map& buffers = std::get<1>(lock_and_buffers);
+
+			_is_htp_write.assign(fixtures.size(), false);
+
+			// Partitions write to separate universes, so only read from the buffer map and can run at the same time
+			auto write_partition_task = [&](size_t partition)
 			{
-				for (fixture* overlapping_fixture : entry.second.overlaps)
-				{
-					auto it = std::find(fixtures_written_to_buffer.begin(), 
-						fixtures_written_to_buffer.end(), overlapping_fixture);
-					if (it != std::end(fixtures_written_to_buffer))
-					{
-						can_write = false;
-						break;
-					}
-				}
+				write_partition(*snapshot, partition, buffers, is_force, time_now);
+			};
+
+			if (_compose_pool && partitions.size() > 1 && fixtures.size() >= k_parallel_compose_min_fixtures)
+			{
+				_compose_pool->run(partitions.size(), write_partition_task);
 			}
+			else
+			{
+				for (size_t p = 0; p < partitions.size(); ++p)
+					write_partition_task(p);
+			}
+
+			updated_universes.clear();
 
-			if (!can_write)
-				break;
-			
-			const bool did_write = entry.first->write_to_buffer(entry.second.patch_info, buffers, updated_universes, is_force);
-			if (did_write)
-				fixtures_written_to_buffer.push_back(entry.first);
+			for (size_t p = 0; p < partitions.size(); ++p)
+			{
+				const universe_updated_list& partition_updated = _partition_states[p]->updated_universes;
+				updated_universes.insert(std::end(updated_universes), std::begin(partition_updated), std::end(partition_updated));
+			}
 		}
 
-		return updated_universes;
+		_write_epoch.fetch_add(1);
 	}
 
-	void fixture_manager::update_fixture_overlaps()
+	void fixture_manager::write_partition(const fixture_snapshot& snapshot, size_t partition, universe_buffer_map& buffers,
+	                                      bool is_force, timestamp time_now)
 	{
-		// TODO: Create more efficient versions of this for registering and unregistering fixtures
-		
-		for (auto& entry : _fixtures)
+		const std::vector<fixture_snapshot_entry>& fixtures = snapshot.fixtures;
+		const std::vector<size_t>& indices = snapshot.partitions[partition].fixtures;
+		partition_state& state = *_partition_states[partition];
+
+		LXMAX_TRACE_SCOPE_ARG("output", "write partition", "fixtures", indices.size());
+
+		state.updated_universes.clear();
+
+		// Batched fixtures share no channels, so are written straight to the buffers without checking ownership
+		for (const fixture_batch& batch : snapshot.partitions[partition].batches)
 		{
-			entry.second.overlaps.clear();
-			
-			for (const auto& other_entry : _fixtures)
+			LXMAX_TRACE_SCOPE_ARG("fixture", "write batch", "fixtures", batch.records.size());
+
+			batch.writer(batch.records.data(), batch.records.size(), buffers, state.updated_universes, is_force);
+		}
+
+		const auto is_writing = [is_force](const fixture_snapshot_entry& entry)
+		{
+			return is_force || entry.instance->is_updated() || entry.instance->is_streaming();
+		};
+
+		// HTP fixtures which are writing clear their channels and have every HTP fixture sharing them write too
+		for (size_t i : indices)
+		{
+			const fixture_snapshot_entry& entry = fixtures[i];
+
+			if (!entry.patch_info.is_htp || !is_writing(entry))
+				continue;
+
+			const timestamp updated = entry.instance->is_streaming() ? time_now : entry.instance->last_updated();
+			state.channel_owners.clear_htp_channels(entry.patch_info, updated, buffers);
+
+			_is_htp_write[i] = true;
+
+			for (size_t overlapping_index : entry.overlaps)
 			{
-				if (entry.first == other_entry.first)
+				if (fixtures[overlapping_index].patch_info.is_htp)
+					_is_htp_write[overlapping_index] = true;
+			}
+		}
+
+		for (size_t i : indices)
+		{
+			const fixture_snapshot_entry& entry = fixtures[i];
+			const bool is_htp = entry.patch_info.is_htp;
+
+			// HTP fixtures updated since their channels were cleared are left until the next frame
+			if (is_htp ? !_is_htp_write[i] : !is_writing(entry))
+				continue;
+
+			const timestamp updated = entry.instance->is_streaming() ? time_now : entry.instance->last_updated();
+
+			LXMAX_TRACE_SCOPE_ARG("fixture", "write_to_buffer", "universe", entry.patch_info.channel_range.start_universe());
+
+			state.channel_owners.begin_write(entry.patch_info, updated, buffers);
+
+			const bool did_write = entry.instance->write_to_buffer(entry.patch_info, buffers, state.updated_universes, is_force || is_htp);
+
+			state.channel_owners.end_write(entry.patch_info, updated, buffers, did_write);
+		}
+	}
+
+	void fixture_manager::set_compose_thread_count(int thread_count)
+	{
+		thread_count = std::max(1, thread_count);
+
+		std::lock_guard<instrumented_mutex> lock(_write_mutex);
+
+		if (thread_count == _compose_thread_count)
+			return;
+
+		_compose_pool.reset();
+
+		if (thread_count > 1)
+			_compose_pool = std::make_unique<work_stealing_pool>(thread_count - 1);
+
+		_compose_thread_count = thread_count;
+	}
+
+	int fixture_manager::get_patched_channel_count(universe_address universe)
+	{
+		const std::shared_ptr<const fixture_snapshot> snapshot = get_snapshot();
+
+		const auto it = snapshot->patched_channel_counts.find(universe);
+		if (it == std::end(snapshot->patched_channel_counts))
+			return 0;
+
+		return it->second;
+	}
+
+	void fixture_manager::publish_snapshot()
+	{
+		auto snapshot = std::make_shared<fixture_snapshot>();
+
+		std::vector<fixture_snapshot_entry>& fixtures = snapshot->fixtures;
+		fixtures.reserve(_fixtures.size());
+
+		for (const auto& f : _fixtures)
+			fixtures.push_back({ f.first, f.second, { } });
+
+		std::sort(std::begin(fixtures), std::end(fixtures), [](const fixture_snapshot_entry& lhs, const fixture_snapshot_entry& rhs)
+		{
+			return lhs.patch_info.channel_range.start() < rhs.patch_info.channel_range.start();
+		});
+
+		// Sorted by start channel, each fixture's overlaps are among the fixtures after it which start before it ends, those
+		// patched in the gaps between its spans don't overlap it
+		for (size_t i = 0; i < fixtures.size(); ++i)
+		{
+			const dmx_channel_range& range = fixtures[i].patch_info.channel_range;
+
+			for (size_t j = i + 1; j < fixtures.size() && fixtures[j].patch_info.channel_range.start() < range.end(); ++j)
+			{
+				if (!fixtures[i].patch_info.is_overlapping_with(fixtures[j].patch_info))
 					continue;
 
-				if (entry.second.patch_info.channel_range.is_overlapping_with(other_entry.second.patch_info.channel_range))
-					entry.second.overlaps.push_back(other_entry.first);
+				fixtures[i].overlaps.push_back(j);
+				fixtures[j].overlaps.push_back(i);
+			}
+		}
+
+		build_partitions(*snapshot);
+
+		for (const auto& entry : fixtures)
+		{
+			entry.patch_info.for_each_span([&](const dmx_channel_range& span)
+			{
+				for (universe_address u = span.start_universe(); u <= span.end_universe(); ++u)
+				{
+					const int count = std::min(k_universe_length, span.end() - u * k_universe_length);
+
+					int& patched_count = snapshot->patched_channel_counts[u];
+					patched_count = std::max(patched_count, count);
+				}
+			});
+
+			if (entry.instance->is_streaming())
+				snapshot->has_streaming_fixtures = true;
+		}
+
+		_has_streaming_fixtures = snapshot->has_streaming_fixtures;
+		_has_pending_registrations = false;
+
+		std::atomic_store(&_snapshot, std::shared_ptr<const fixture_snapshot>(std::move(snapshot)));
+	}
+
+	void fixture_manager::build_partitions(fixture_snapshot& snapshot)
+	{
+		const std::vector<fixture_snapshot_entry>& fixtures = snapshot.fixtures;
+
+		// Fixtures spanning several universes join them into one group, so no two groups write to the same universe
+		std::unordered_map<universe_address, universe_address> universe_groups;
+
+		const auto find_group = [&universe_groups](universe_address u)
+		{
+			universe_groups.emplace(u, u);
+
+			while (universe_groups[u] != u)
+				u = universe_groups[u] = universe_groups[universe_groups[u]];
+
+			return u;
+		};
+
+		for (const auto& entry : fixtures)
+		{
+			const dmx_channel_range& range = entry.patch_info.channel_range;
+			const universe_address group = find_group(range.start_universe());
+
+			for (universe_address u = range.start_universe() + 1; u <= range.end_universe(); ++u)
+				universe_groups[find_group(u)] = group;
+		}
+
+		// Fixtures are in channel order, so groups are numbered in the order of their lowest universe
+		std::unordered_map<universe_address, size_t> group_indices;
+		std::vector<std::vector<size_t>> groups;
+
+		for (size_t i = 0; i < fixtures.size(); ++i)
+		{
+			const universe_address group = find_group(fixtures[i].patch_info.channel_range.start_universe());
+
+			const auto it = group_indices.emplace(group, groups.size()).first;
+			if (it->second == groups.size())
+				groups.emplace_back();
+
+			groups[it->second].push_back(i);
+		}
+
+		// Small neighbouring groups are merged so each partition has enough fixtures to be worth handing to another thread
+		for (auto& group : groups)
+		{
+			if (snapshot.partitions.empty() || snapshot.partitions.back().fixtures.size() >= k_compose_partition_min_fixtures)
+				snapshot.partitions.emplace_back();
+
+			std::vector<size_t>& partition = snapshot.partitions.back().fixtures;
+			partition.insert(std::end(partition), std::begin(group), std::end(group));
+		}
+
+		for (auto& partition : snapshot.partitions)
+			build_batches(snapshot, partition);
+	}
+
+	void fixture_manager::build_batches(const fixture_snapshot& snapshot, fixture_partition& partition)
+	{
+		std::vector<size_t> unbatched;
+
+		for (size_t i : partition.fixtures)
+		{
+			const fixture_snapshot_entry& entry = snapshot.fixtures[i];
+
+			// HTP fixtures merge with what's already in the buffer, so are left to have their channels cleared first
+			const fixture_batch_writer writer = entry.overlaps.empty() && !entry.patch_info.is_htp
+				? entry.instance->batch_writer()
+				: nullptr;
+
+			if (writer == nullptr)
+			{
+				unbatched.push_back(i);
+				continue;
 			}
+
+			auto batch = std::find_if(std::begin(partition.batches), std::end(partition.batches),
+			                          [writer](const fixture_batch& b) { return b.writer == writer; });
+
+			if (batch == std::end(partition.batches))
+				batch = partition.batches.insert(batch, { writer, { } });
+
+			batch->records.push_back({ entry.instance, &entry.patch_info });
 		}
+
+		partition.fixtures = std::move(unbatched);
+	}
+
+	void fixture_manager::try_publish_pending_registrations()
+	{
+		std::unique_lock<instrumented_mutex> lock(_mutex, std::try_to_lock);
+
+		if (!lock.owns_lock() || !_has_pending_registrations)
+			return;
+
+		const timestamp time_now = clock::now();
+
+		if (time_now - _last_registration_time < k_registration_quiet_period
+			&& time_now - _first_pending_registration_time < k_registration_max_delay)
+			return;
+
+		LXMAX_TRACE_SCOPE_ARG("output", "publish registrations", "fixtures", _fixtures.size());
+
+		publish_snapshot();
+	}
+
+	void fixture_manager::wait_for_write_to_buffer() const
+	{
+		// Writes starting after the new snapshot was published will use it, so only a write in progress can be using an old one
+		const uint64_t epoch = _write_epoch.load();
+
+		if (epoch % 2 == 0)
+			return;
+
+		while (_write_epoch.load() == epoch)
+			std::this_thread::yield();
 	}
 }
@@ -5,38 +5,76 @@
 
 #pragma once
 
+#include <atomic>
 #include <cassert>
+#include <memory>
 #include <unordered_map>
 #include <mutex>
 #include <vector>
+#include <Poco/Event.h>
 #include <Poco/Logger.h>
 
+#include "channel_ownership.hpp"
 #include "common.hpp"
 #include "dmx_buffer_manager.hpp"
+#include "emitter_extraction.hpp"
+#include "response_curve.hpp"
+#include "fixture_batch.hpp"
 #include "fixture_patch_info.hpp"
+#include "instrumented_mutex.hpp"
+#include "work_stealing_pool.hpp"
 
 namespace lxmax
 {
+	/// @brief Registrations are published once none have been made for this long, so a patch loading publishes once
+	const milliseconds k_registration_quiet_period { 50 };
+
+	/// @brief Longest registrations wait to be published while more keep being made
+	const milliseconds k_registration_max_delay { 500 };
+
+	/// @brief Universes are grouped into partitions of at least this many fixtures, so each is worth running on another thread
+	const size_t k_compose_partition_min_fixtures = 64;
+
+	/// @brief Patches with fewer fixtures than this are always written on the output thread alone
+	const size_t k_parallel_compose_min_fixtures = 1024;
+
 	class fixture;
 
-	struct fixture_info
+	using fixture_map = std::unordered_map<fixture*, fixture_patch_info>;
+
+	struct fixture_snapshot_entry
 	{
-		explicit fixture_info(fixture_patch_info info)
-			: patch_info(std::move(info))
-		{
-		}
-		
+		fixture* instance;
 		fixture_patch_info patch_info;
-		std::vector<fixture*> overlaps;
+
+		/// @brief Indices of the other entries in the snapshot this fixture's channels overlap with, HTP fixtures sharing
+		/// channels are written together so their values can be merged again
+		std::vector<size_t> overlaps;
 	};
 
-	using fixture_map = std::unordered_map<fixture*, fixture_info>;
-	using fixture_map_entry = std::pair<fixture*, fixture_info>;
-	
+	/// @brief Fixtures patched to a group of universes no other partition's fixtures write to
+	struct fixture_partition
+	{
+		/// @brief Indices of the partition's entries in the snapshot which are written one at a time, in order of their
+		/// start channel
+		std::vector<size_t> fixtures;
 
-	struct fixture_last_updated_compare
+		/// @brief The partition's other fixtures, grouped by type and written by their type's batch writer
+		std::vector<fixture_batch> batches;
+	};
+
+	/// @brief Immutable copy of the fixture registry as seen by the output thread
+	///
+	struct fixture_snapshot
 	{
-		bool operator()(const fixture_map_entry& lhs, const fixture_map_entry& rhs) const;
+		/// @brief Registered fixtures in order of their start channel
+		std::vector<fixture_snapshot_entry> fixtures;
+
+		/// @brief Fixtures grouped so that partitions can be written to the buffers at the same time
+		std::vector<fixture_partition> partitions;
+
+		std::unordered_map<universe_address, int> patched_channel_counts;
+		bool has_streaming_fixtures { false };
 	};
 	
 	class fixture_manager
@@ -45,8 +83,40 @@ namespace lxmax
 
 		std::shared_ptr<dmx_buffer_manager> _buffer_manager;
 		
-		std::mutex _mutex;
+		// Registry lock, only taken when fixtures are registered or unregistered
+		instrumented_mutex _mutex { "fixture_manager" };
 		fixture_map _fixtures;
+		std::atomic<bool> _has_pending_registrations { false };
+		timestamp _first_pending_registration_time;
+		timestamp _last_registration_time;
+
+		// Rebuilt from the registry whenever it changes, only ever accessed through std::atomic_load and std::atomic_store
+		std::shared_ptr<const fixture_snapshot> _snapshot { std::make_shared<fixture_snapshot>() };
+		std::atomic<bool> _has_streaming_fixtures { false };
+
+		// Odd while fixtures from a snapshot are being written, so unregistering can wait for the write to finish
+		std::atomic<uint64_t> _write_epoch { 0 };
+
+		Poco::Event _update_event { Poco::Event::EVENT_AUTORESET };
+
+		struct partition_state
+		{
+			channel_ownership channel_owners;
+			universe_updated_list updated_universes;
+		};
+
+		// Only used while writing to the buffer, kept between frames so they don't allocate
+		instrumented_mutex _write_mutex { "fixture_manager write" };
+		std::shared_ptr<const fixture_snapshot> _written_snapshot;
+		std::vector<std::unique_ptr<partition_state>> _partition_states;
+		std::unique_ptr<work_stealing_pool> _compose_pool;
+		std::atomic<int> _compose_thread_count { 1 };
+
+		// Bytes rather than bits, as partitions are written from different threads
+		std::vector<uint8_t> _is_htp_write;
+
+		emitter_lut_cache _emitter_luts;
+		response_curve_registry _response_curves;
 
 	public:
 		fixture_manager(Poco::Logger& log, std::shared_ptr<dmx_buffer_manager> buffer_manager)
@@ -56,13 +126,105 @@ namespace lxmax
 			
 		}
 		
+		/// @brief Adds a fixture or updates its patch, which is published to the output thread at a later frame
+		///
+		/// Opening a patch registers each fixture several times as its attributes are set, so rather than rebuilding
+		/// the snapshot every time, registrations are queued until they've been quiet for a short period.
 		void register_fixture(fixture* fixture, const fixture_patch_info& patch_info);
 
+		/// @brief Removes a fixture, once this returns the output thread will no longer access it
 		void unregister_fixture(fixture* fixture);
 
 		universe_updated_list write_to_buffer(bool is_force = false);
 
+		/// @brief Writes fixtures to the universe buffers, filling a list of the universes written to
+		///
+		/// Once the list and the manager's own working space have grown to fit the patch, this doesn't allocate. Fixtures
+		/// are read from the latest snapshot, so this never waits for fixtures being registered or unregistered.
+		///
+		/// Where fixtures share channels, each LTP channel keeps the value of the most recently updated fixture and each
+		/// HTP channel the highest value of the fixtures patched to it. When the patch changes every fixture is written.
+		///
+		/// Fixtures sharing no channels whose type has a batch writer are written a type at a time, the rest individually.
+		///
+		/// With more than one compose thread, large patches are written a partition at a time across the threads.
+		void write_to_buffer(universe_updated_list& updated_universes, bool is_force = false);
+
+		/// @brief Publishes any queued registrations immediately
+		void flush_registrations();
+
+		/// @brief Sets the number of threads, including the output thread, fixtures are written to the buffers on
+		void set_compose_thread_count(int thread_count);
+
+		int compose_thread_count() const
+		{
+			return _compose_thread_count;
+		}
+
+		/// @brief Checks if registrations are waiting to be published, frames must keep being written until they are
+		bool has_pending_registrations() const
+		{
+			return _has_pending_registrations;
+		}
+
+		/// @brief Called by fixtures when their values have changed, wakes any thread waiting for an update
+		void notify_fixture_updated()
+		{
+			_update_event.set();
+		}
+
+		/// @brief Blocks until a fixture is updated or the timeout expires
+		/// @returns true if a fixture was updated
+		bool wait_for_fixture_update(milliseconds timeout)
+		{
+			return _update_event.tryWait(static_cast<long>(timeout.count()));
+		}
+
+		/// @brief Checks if any registered fixture changes every frame without notifying updates
+		bool has_streaming_fixtures() const
+		{
+			return _has_streaming_fixtures;
+		}
+
+		/// @brief Gets the emitter LUTs shared by fixtures with the same calibration
+		emitter_lut_cache& get_emitter_luts()
+		{
+			return _emitter_luts;
+		}
+
+		/// @brief Gets the response curves shared by all fixtures
+		response_curve_registry& get_response_curves()
+		{
+			return _response_curves;
+		}
+
+		/// @brief Gets the number of channels up to and including the highest channel patched in a universe
+		/// @returns 0 if no fixtures are patched to the universe
+		int get_patched_channel_count(universe_address universe);
+
 	private:
-		void update_fixture_overlaps();
+		std::shared_ptr<const fixture_snapshot> get_snapshot() const
+		{
+			return std::atomic_load(&_snapshot);
+		}
+
+		/// @brief Builds a snapshot of the registry and makes it current, must be called with the registry lock held
+		void publish_snapshot();
+
+		/// @brief Writes one partition's fixtures to the buffers, may be called from any compose thread
+		void write_partition(const fixture_snapshot& snapshot, size_t partition, universe_buffer_map& buffers,
+		                     bool is_force, timestamp time_now);
+
+		/// @brief Groups a snapshot's fixtures into partitions which share no universes
+		static void build_partitions(fixture_snapshot& snapshot);
+
+		/// @brief Moves fixtures which can be written without resolving channel ownership into their type's batch
+		static void build_batches(const fixture_snapshot& snapshot, fixture_partition& partition);
+
+		/// @brief Publishes queued registrations which have settled, skipping if the registry is locked rather than waiting
+		void try_publish_pending_registrations();
+
+		/// @brief Waits for any write to the buffer which may be using a replaced snapshot to finish
+		void wait_for_write_to_buffer() const;
 	};
 }
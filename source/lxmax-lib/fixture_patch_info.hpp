@@ -6,6 +6,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "common.hpp"
 #include "dmx_channel_range.hpp"
 
@@ -17,6 +18,12 @@ namespace lxmax
 		bool is_htp;
 		dmx_channel_range channel_range;
 
+		/// @brief Parts of the channel range the fixture writes to, empty if it writes to the whole range
+		///
+		/// Fixtures leaving gaps in their range, such as a pixel map ending each universe early, list the channels either
+		/// side of them so that other fixtures can be patched in the gaps.
+		std::vector<dmx_channel_range> spans;
+
 		fixture_patch_info() = default;
 		
 		fixture_patch_info(std::string label, bool is_htp, dmx_channel_range channel_range)
@@ -31,12 +38,49 @@ namespace lxmax
 		{
 			return lhs.label == rhs.label
 				&& lhs.is_htp == rhs.is_htp
-				&& lhs.channel_range == rhs.channel_range;
+				&& lhs.channel_range == rhs.channel_range
+				&& lhs.spans == rhs.spans;
 		}
 
 		friend bool operator!=(const fixture_patch_info& lhs, const fixture_patch_info& rhs)
 		{
 			return !(lhs == rhs);
 		}
+
+		/// @brief Calls f with each range of channels the fixture writes to
+		template <typename F>
+		void for_each_span(F&& f) const
+		{
+			if (spans.empty())
+			{
+				f(channel_range);
+				return;
+			}
+
+			for (const auto& span : spans)
+				f(span);
+		}
+
+		/// @brief Checks if any channel written by one fixture is also written by the other
+		bool is_overlapping_with(const fixture_patch_info& other) const
+		{
+			if (!channel_range.is_overlapping_with(other.channel_range))
+				return false;
+
+			if (spans.empty() && other.spans.empty())
+				return true;
+
+			bool is_overlapping = false;
+
+			for_each_span([&](const dmx_channel_range& span)
+			{
+				other.for_each_span([&](const dmx_channel_range& other_span)
+				{
+					is_overlapping = is_overlapping || span.is_overlapping_with(other_span);
+				});
+			});
+
+			return is_overlapping;
+		}
 	};
 }
@@ -24,11 +24,18 @@ namespace lxmax
 		MEMBER_WITH_KEY(bool, is_force_output_at_framerate, false)
 		MEMBER_WITH_KEY(int, framerate, 44)
 		MEMBER_WITH_KEY(bool, is_allow_nondmx_framerate, false)
+		MEMBER_WITH_KEY(bool, is_output_pacing_enabled, false)
+		MEMBER_WITH_KEY(int, output_pacing_window, 50)
+		MEMBER_WITH_KEY(int, output_pacing_max_packets_per_second, 0)
+		MEMBER_WITH_KEY(bool, is_low_latency_output_enabled, false)
+		MEMBER_WITH_KEY(int, low_latency_min_interval, 23)
+		MEMBER_WITH_KEY(int, compose_thread_count, 1)
 
 		MEMBER_WITH_KEY(Poco::Net::IPAddress, artnet_network_adapter, Poco::Net::IPAddress("0.0.0.0"))
 		MEMBER_WITH_KEY(bool, is_artnet_global_destination_broadcast, false);
 		MEMBER_WITH_KEY(std::vector<Poco::Net::IPAddress>, artnet_global_destination_unicast_addresses, { Poco::Net::IPAddress("127.0.0.1") })
 		MEMBER_WITH_KEY(bool, is_send_artnet_sync_packets, true)
+		MEMBER_WITH_KEY(bool, is_artnet_discovery_enabled, false)
 
 		MEMBER_WITH_KEY(Poco::Net::IPAddress, sacn_network_adapter, Poco::Net::IPAddress("0.0.0.0"))
 		MEMBER_WITH_KEY(bool, is_sacn_global_destination_multicast, true)
@@ -38,15 +45,25 @@ namespace lxmax
 
 		void read_from_configuration(const Poco::AutoPtr<Poco::Util::AbstractConfiguration>& config)
 		{
+			// Keys added since the preferences format was first released may be missing from older files
+			const global_config defaults;
+
 			is_output_empty_universes = config->getBool(key_is_output_empty_universes);
 			is_force_output_at_framerate = config->getBool(key_is_force_output_at_framerate);
 			framerate = config->getInt(key_framerate);
 			is_allow_nondmx_framerate = config->getBool(key_is_allow_nondmx_framerate);
+			is_output_pacing_enabled = config->getBool(key_is_output_pacing_enabled, defaults.is_output_pacing_enabled);
+			output_pacing_window = config->getInt(key_output_pacing_window, defaults.output_pacing_window);
+			output_pacing_max_packets_per_second = config->getInt(key_output_pacing_max_packets_per_second, defaults.output_pacing_max_packets_per_second);
+			is_low_latency_output_enabled = config->getBool(key_is_low_latency_output_enabled, defaults.is_low_latency_output_enabled);
+			low_latency_min_interval = config->getInt(key_low_latency_min_interval, defaults.low_latency_min_interval);
+			compose_thread_count = config->getInt(key_compose_thread_count, defaults.compose_thread_count);
 			
 			artnet_network_adapter = config_helpers::get_ip_address(config, key_artnet_network_adapter);
 			is_artnet_global_destination_broadcast = config->getBool(key_is_artnet_global_destination_broadcast);
 			artnet_global_destination_unicast_addresses = config_helpers::get_ip_address_vector(config, key_artnet_global_destination_unicast_addresses);
 			is_send_artnet_sync_packets = config->getBool(key_is_send_artnet_sync_packets);
+			is_artnet_discovery_enabled = config->getBool(key_is_artnet_discovery_enabled, defaults.is_artnet_discovery_enabled);
 			
 			sacn_network_adapter = config_helpers::get_ip_address(config, key_sacn_network_adapter);
 			is_sacn_global_destination_multicast = config->getBool(key_is_sacn_global_destination_multicast);
@@ -61,11 +78,18 @@ namespace lxmax
 			config->setBool(key_is_force_output_at_framerate, is_force_output_at_framerate);
 			config->setInt(key_framerate, framerate);
 			config->setBool(key_is_allow_nondmx_framerate, is_allow_nondmx_framerate);
+			config->setBool(key_is_output_pacing_enabled, is_output_pacing_enabled);
+			config->setInt(key_output_pacing_window, output_pacing_window);
+			config->setInt(key_output_pacing_max_packets_per_second, output_pacing_max_packets_per_second);
+			config->setBool(key_is_low_latency_output_enabled, is_low_latency_output_enabled);
+			config->setInt(key_low_latency_min_interval, low_latency_min_interval);
+			config->setInt(key_compose_thread_count, compose_thread_count);
 
 			config_helpers::set_ip_address(config, key_artnet_network_adapter, artnet_network_adapter);
 			config->setBool(key_is_artnet_global_destination_broadcast, is_artnet_global_destination_broadcast);
 			config_helpers::set_ip_address_vector(config, key_artnet_global_destination_unicast_addresses, artnet_global_destination_unicast_addresses);
 			config->setBool(key_is_send_artnet_sync_packets, is_send_artnet_sync_packets);
+			config->setBool(key_is_artnet_discovery_enabled, is_artnet_discovery_enabled);
 
 			config_helpers::set_ip_address(config, key_sacn_network_adapter, sacn_network_adapter);
 			config->setBool(key_is_sacn_global_destination_multicast, is_sacn_global_destination_multicast);
@@ -0,0 +1,95 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "instrumented_mutex.hpp"
+
+#include <map>
+#include <memory>
+
+namespace lxmax
+{
+	namespace
+	{
+		struct lock_stats_registry
+		{
+			std::mutex mutex;
+			std::map<std::string, std::unique_ptr<lock_stats>> stats;
+		};
+
+		lock_stats_registry& get_registry()
+		{
+			static lock_stats_registry registry;
+			return registry;
+		}
+	}
+
+	lock_stats_snapshot lock_stats::snapshot() const
+	{
+		lock_stats_snapshot snapshot;
+
+		snapshot.name = _name;
+		snapshot.acquisitions = _acquisitions.load(std::memory_order_relaxed);
+		snapshot.contended_acquisitions = _contended_acquisitions.load(std::memory_order_relaxed);
+		snapshot.wait_nanoseconds = _wait_nanoseconds.load(std::memory_order_relaxed);
+		snapshot.hold_nanoseconds = _hold_nanoseconds.load(std::memory_order_relaxed);
+
+		for (int i = 0; i < k_lock_histogram_bucket_count; ++i)
+		{
+			snapshot.wait_histogram[i] = _wait_histogram[i].load(std::memory_order_relaxed);
+			snapshot.hold_histogram[i] = _hold_histogram[i].load(std::memory_order_relaxed);
+		}
+
+		return snapshot;
+	}
+
+	void lock_stats::reset()
+	{
+		_acquisitions = 0;
+		_contended_acquisitions = 0;
+		_wait_nanoseconds = 0;
+		_hold_nanoseconds = 0;
+
+		for (int i = 0; i < k_lock_histogram_bucket_count; ++i)
+		{
+			_wait_histogram[i] = 0;
+			_hold_histogram[i] = 0;
+		}
+	}
+
+	lock_stats& get_lock_stats(const std::string& name)
+	{
+		lock_stats_registry& registry = get_registry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		auto it = registry.stats.find(name);
+		if (it == std::end(registry.stats))
+			it = registry.stats.emplace(name, std::make_unique<lock_stats>(name)).first;
+
+		return *it->second;
+	}
+
+	std::vector<lock_stats_snapshot> get_all_lock_stats()
+	{
+		lock_stats_registry& registry = get_registry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		std::vector<lock_stats_snapshot> snapshots;
+		snapshots.reserve(registry.stats.size());
+
+		for (const auto& s : registry.stats)
+			snapshots.push_back(s.second->snapshot());
+
+		return snapshots;
+	}
+
+	void reset_all_lock_stats()
+	{
+		lock_stats_registry& registry = get_registry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		for (const auto& s : registry.stats)
+			s.second->reset();
+	}
+}
@@ -0,0 +1,160 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+
+namespace lxmax
+{
+	/// @brief Number of power of two histogram buckets, the first holds times under 2ns and the last everything over ~8ms
+	const int k_lock_histogram_bucket_count = 24;
+
+	using lock_histogram = std::array<uint64_t, k_lock_histogram_bucket_count>;
+
+	struct lock_stats_snapshot
+	{
+		std::string name;
+		uint64_t acquisitions { 0 };
+		uint64_t contended_acquisitions { 0 };
+		uint64_t wait_nanoseconds { 0 };
+		uint64_t hold_nanoseconds { 0 };
+		lock_histogram wait_histogram { };
+		lock_histogram hold_histogram { };
+	};
+
+	/// @brief Counters shared by every mutex with the same name
+	class lock_stats
+	{
+		const std::string _name;
+
+		std::atomic<uint64_t> _acquisitions { 0 };
+		std::atomic<uint64_t> _contended_acquisitions { 0 };
+		std::atomic<uint64_t> _wait_nanoseconds { 0 };
+		std::atomic<uint64_t> _hold_nanoseconds { 0 };
+		std::array<std::atomic<uint64_t>, k_lock_histogram_bucket_count> _wait_histogram { };
+		std::array<std::atomic<uint64_t>, k_lock_histogram_bucket_count> _hold_histogram { };
+
+		static int get_bucket(int64_t nanoseconds)
+		{
+			int bucket = 0;
+
+			while (nanoseconds > 1 && bucket < k_lock_histogram_bucket_count - 1)
+			{
+				nanoseconds >>= 1;
+				++bucket;
+			}
+
+			return bucket;
+		}
+
+	public:
+		explicit lock_stats(std::string name)
+			: _name(std::move(name))
+		{
+		}
+
+		void record_acquire(bool is_contended, clock::duration wait_time)
+		{
+			const int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(wait_time).count();
+
+			_acquisitions.fetch_add(1, std::memory_order_relaxed);
+			if (is_contended)
+				_contended_acquisitions.fetch_add(1, std::memory_order_relaxed);
+
+			_wait_nanoseconds.fetch_add(static_cast<uint64_t>(nanoseconds), std::memory_order_relaxed);
+			_wait_histogram[get_bucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void record_release(clock::duration hold_time)
+		{
+			const int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(hold_time).count();
+
+			_hold_nanoseconds.fetch_add(static_cast<uint64_t>(nanoseconds), std::memory_order_relaxed);
+			_hold_histogram[get_bucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		lock_stats_snapshot snapshot() const;
+
+		void reset();
+	};
+
+	/// @brief Gets the counters for the named lock, creating them the first time the name is used
+	lock_stats& get_lock_stats(const std::string& name);
+
+	/// @brief Gets the counters for every named lock, in name order
+	std::vector<lock_stats_snapshot> get_all_lock_stats();
+
+	void reset_all_lock_stats();
+
+#ifdef LXMAX_ENABLE_LOCK_STATS
+	/// @brief Mutex which records acquisitions, contention and wait and hold times against its name
+	///
+	class instrumented_mutex
+	{
+		std::mutex _mutex;
+		lock_stats& _stats;
+		timestamp _acquired_time;
+
+	public:
+		explicit instrumented_mutex(const char* name)
+			: _stats(get_lock_stats(name))
+		{
+		}
+
+		instrumented_mutex(const instrumented_mutex&) = delete;
+		instrumented_mutex& operator=(const instrumented_mutex&) = delete;
+
+		void lock()
+		{
+			if (_mutex.try_lock())
+			{
+				_acquired_time = clock::now();
+				_stats.record_acquire(false, clock::duration::zero());
+				return;
+			}
+
+			const timestamp wait_start = clock::now();
+			_mutex.lock();
+
+			_acquired_time = clock::now();
+			_stats.record_acquire(true, _acquired_time - wait_start);
+		}
+
+		bool try_lock()
+		{
+			if (!_mutex.try_lock())
+				return false;
+
+			_acquired_time = clock::now();
+			_stats.record_acquire(false, clock::duration::zero());
+			return true;
+		}
+
+		void unlock()
+		{
+			_stats.record_release(clock::now() - _acquired_time);
+			_mutex.unlock();
+		}
+	};
+#else
+	/// @brief Plain mutex, lock stats are only recorded when the LXMAX_ENABLE_LOCK_STATS CMake option is on
+	///
+	class instrumented_mutex : public std::mutex
+	{
+	public:
+		explicit instrumented_mutex(const char*)
+		{
+		}
+	};
+#endif
+}
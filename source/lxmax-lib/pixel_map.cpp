@@ -0,0 +1,251 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "pixel_map.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LXMAX_PIXEL_MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace lxmax
+{
+	namespace
+	{
+		/// @brief Gets the matrix plane written to each channel of a pixel, -1 for channels left at zero
+		std::array<int, 4> get_plane_map(int plane_count)
+		{
+			if (plane_count >= 4)
+				return { 1, 2, 3, 0 };
+
+			if (plane_count == 3)
+				return { 0, 1, 2, -1 };
+
+			return { 0, 0, 0, -1 };
+		}
+
+		template<typename T, typename Convert>
+		void fill_run_scalar(const char* src, ptrdiff_t step, dmx_value* dst, int count, int channels_per_pixel,
+		                     const std::array<int, 4>& plane_map, Convert convert)
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				const T* pixel = reinterpret_cast<const T*>(src);
+
+				for (int c = 0; c < channels_per_pixel; ++c)
+					dst[c] = plane_map[c] < 0 ? 0 : convert(pixel[plane_map[c]]);
+
+				dst += channels_per_pixel;
+				src += step;
+			}
+		}
+
+		/// @brief Copies ARGB pixels to RGBA channels, reversing their order if the run goes right to left
+		/// @returns the number of pixels copied, any remainder is left for the scalar path
+		int fill_run_argb(const char* src, dmx_value* dst, int count, bool is_reversed)
+		{
+			int i = 0;
+
+#ifdef LXMAX_PIXEL_MAP_SSE2
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i pixels;
+
+				if (is_reversed)
+				{
+					pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src - (i + 3) * 4));
+					pixels = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(0, 1, 2, 3));
+				}
+				else
+				{
+					pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+				}
+
+				// Rotate each pixel's bytes from ARGB to RGBA
+				pixels = _mm_or_si128(_mm_srli_epi32(pixels, 8), _mm_slli_epi32(pixels, 24));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), pixels);
+			}
+#endif
+
+			return i;
+		}
+	}
+
+	pixel_map::pixel_map(const pixel_map_config& config)
+		: _config(config)
+	{
+		build_runs();
+	}
+
+	bool pixel_map::set_config(const pixel_map_config& config)
+	{
+		if (config == _config)
+			return false;
+
+		_config = config;
+		build_runs();
+
+		return true;
+	}
+
+	int pixel_map::get_offset(int x, int y) const
+	{
+		for (const auto& r : _runs)
+		{
+			for (int i = 0; i < r.count; ++i)
+			{
+				if (r.x + r.dx * i == x && r.y + r.dy * i == y)
+					return r.offset + i * _config.channels_per_pixel;
+			}
+		}
+
+		return -1;
+	}
+
+	void pixel_map::fill(const pixel_source& source, dmx_value* image) const
+	{
+		const int channels_per_pixel = _config.channels_per_pixel;
+		const auto plane_map = get_plane_map(source.plane_count);
+		const auto convert = [](unsigned char v) { return static_cast<dmx_value>(v); };
+
+		const bool is_argb = source.plane_count == 4 && source.column_stride == 4 && channels_per_pixel == 4;
+		const bool is_rgb = source.plane_count == 3 && source.column_stride == 3 && channels_per_pixel == 3;
+
+		for (const auto& r : _runs)
+		{
+			const char* src = source.data + r.y * source.row_stride + r.x * source.column_stride;
+			const ptrdiff_t step = r.dx * source.column_stride + r.dy * source.row_stride;
+			dmx_value* dst = image + r.offset;
+			int count = r.count;
+
+			if (is_rgb && r.dx == 1)
+			{
+				std::memcpy(dst, src, count * 3);
+				continue;
+			}
+
+			if (is_argb && r.dy == 0)
+			{
+				const int copied = fill_run_argb(src, dst, count, r.dx < 0);
+				src += copied * step;
+				dst += copied * 4;
+				count -= copied;
+			}
+
+			fill_run_scalar<unsigned char>(src, step, dst, count, channels_per_pixel, plane_map, convert);
+		}
+	}
+
+	void pixel_map::fill_float(const pixel_source& source, dmx_value* image) const
+	{
+		const auto plane_map = get_plane_map(source.plane_count);
+		const auto convert = [](float v)
+		{
+			return static_cast<dmx_value>(std::lround(std::clamp(v, 0.f, 1.f) * k_dmx_8bit_max));
+		};
+
+		for (const auto& r : _runs)
+		{
+			const char* src = source.data + r.y * source.row_stride + r.x * source.column_stride;
+			const ptrdiff_t step = r.dx * source.column_stride + r.dy * source.row_stride;
+
+			fill_run_scalar<float>(src, step, image + r.offset, r.count, _config.channels_per_pixel, plane_map, convert);
+		}
+	}
+
+	void pixel_map::build_runs()
+	{
+		_runs.clear();
+		_universe_spans.clear();
+
+		const int width = std::max(_config.width, 0);
+		const int height = std::max(_config.height, 0);
+		const int channels_per_pixel = std::clamp(_config.channels_per_pixel, 1, 4);
+		_config.channels_per_pixel = channels_per_pixel;
+
+		int capacity = k_universe_length / channels_per_pixel;
+		if (_config.pixels_per_universe > 0)
+			capacity = std::min(capacity, _config.pixels_per_universe);
+
+		const channel_address image_start = _config.start_universe * k_universe_length + _config.start_channel - 1;
+
+		universe_address universe = _config.start_universe;
+		int universe_channel = _config.start_channel - 1;
+		int universe_pixels = 0;
+		channel_address image_end = image_start;
+
+		for (int i = 0; i < width * height; ++i)
+		{
+			int x, y;
+
+			switch (_config.layout)
+			{
+				default:
+				case pixel_map_layout::progressive:
+					x = i % width;
+					y = i / width;
+					break;
+				case pixel_map_layout::snake:
+					y = i / width;
+					x = y % 2 == 0 ? i % width : width - 1 - i % width;
+					break;
+				case pixel_map_layout::zigzag:
+					x = i / height;
+					y = x % 2 == 0 ? i % height : height - 1 - i % height;
+					break;
+			}
+
+			if (universe_pixels == capacity || universe_channel + channels_per_pixel > k_universe_length)
+			{
+				++universe;
+				universe_channel = 0;
+				universe_pixels = 0;
+			}
+
+			const channel_address address = universe * k_universe_length + universe_channel;
+			const int offset = address - image_start;
+
+			if (_universe_spans.empty() || _universe_spans.back().start_universe() != universe)
+			{
+				_universe_spans.emplace_back(universe, universe_channel + 1, channels_per_pixel);
+			}
+			else
+			{
+				const dmx_channel_range& span = _universe_spans.back();
+				_universe_spans.back() = dmx_channel_range(universe, span.start_local() + 1, address + channels_per_pixel - span.start());
+			}
+
+			universe_channel += channels_per_pixel;
+			++universe_pixels;
+			image_end = address + channels_per_pixel;
+
+			if (!_runs.empty())
+			{
+				run& last = _runs.back();
+				const int dx = x - (last.x + last.dx * (last.count - 1));
+				const int dy = y - (last.y + last.dy * (last.count - 1));
+				const bool is_adjacent = std::abs(dx) + std::abs(dy) == 1
+					&& (last.count == 1 || (dx == last.dx && dy == last.dy));
+
+				if (is_adjacent && offset == last.offset + last.count * channels_per_pixel)
+				{
+					last.dx = dx;
+					last.dy = dy;
+					++last.count;
+					continue;
+				}
+			}
+
+			_runs.push_back({ x, y, 0, 0, 1, offset });
+		}
+
+		_channel_range = dmx_channel_range(_config.start_universe, _config.start_channel, image_end - image_start);
+	}
+}
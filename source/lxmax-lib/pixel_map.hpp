@@ -0,0 +1,132 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "channel_image.hpp"
+#include "common.hpp"
+#include "dmx_channel_range.hpp"
+
+namespace lxmax
+{
+	/// @brief Order in which a pixel chain is wired through a matrix
+	///
+	enum class pixel_map_layout
+	{
+		progressive,	// Every row left to right
+		snake,			// Rows alternate left to right and right to left
+		zigzag,			// Columns alternate top to bottom and bottom to top
+		enum_count
+	};
+
+	struct pixel_map_config
+	{
+		int width { 1 };
+		int height { 1 };
+		pixel_map_layout layout { pixel_map_layout::progressive };
+		universe_address start_universe { 1 };
+		int start_channel { 1 };
+		int channels_per_pixel { 3 };
+		int pixels_per_universe { 0 };	// 0 to fit as many pixels as possible in each universe
+
+		friend bool operator==(const pixel_map_config& lhs, const pixel_map_config& rhs)
+		{
+			return lhs.width == rhs.width
+				&& lhs.height == rhs.height
+				&& lhs.layout == rhs.layout
+				&& lhs.start_universe == rhs.start_universe
+				&& lhs.start_channel == rhs.start_channel
+				&& lhs.channels_per_pixel == rhs.channels_per_pixel
+				&& lhs.pixels_per_universe == rhs.pixels_per_universe;
+		}
+
+		friend bool operator!=(const pixel_map_config& lhs, const pixel_map_config& rhs)
+		{
+			return !(lhs == rhs);
+		}
+	};
+
+	/// @brief Matrix data to be mapped, strides are in bytes as in a Jitter matrix
+	///
+	struct pixel_source
+	{
+		const char* data;
+		int plane_count;
+		ptrdiff_t column_stride;
+		ptrdiff_t row_stride;
+	};
+
+	/// @brief Maps matrix cells to DMX channels through a precomputed index table
+	///
+	/// The map fills an image of the patched channel range, starting at the first pixel's channel, which can then be
+	/// copied into the universe spans with write_channel_image. Pixels are never split across universes; the start channel
+	/// only offsets the first universe, following universes start at channel 1. Channels after the last pixel in each
+	/// universe are left out of the spans, so other fixtures can be patched to them.
+	///
+	/// Three plane matrices map to RGB. Four plane matrices are ARGB as in Jitter and map to RGB, with alpha
+	/// written to the fourth channel when pixels have four channels.
+	class pixel_map
+	{
+		/// @brief Pixels which are adjacent in both the matrix and the image
+		struct run
+		{
+			int x;
+			int y;
+			int dx;
+			int dy;
+			int count;
+			int offset;
+		};
+
+		pixel_map_config _config;
+		std::vector<run> _runs;
+		dmx_channel_range _channel_range;
+		std::vector<dmx_channel_range> _universe_spans;
+
+	public:
+		explicit pixel_map(const pixel_map_config& config = { });
+
+		const pixel_map_config& config() const
+		{
+			return _config;
+		}
+
+		/// @brief Rebuilds the index table if the config has changed
+		/// @returns true if the table was rebuilt
+		bool set_config(const pixel_map_config& config);
+
+		const dmx_channel_range& channel_range() const
+		{
+			return _channel_range;
+		}
+
+		/// @brief Gets the channels from the first pixel to the end of the last in each universe the map is patched to
+		const std::vector<dmx_channel_range>& universe_spans() const
+		{
+			return _universe_spans;
+		}
+
+		/// @brief Gets the number of runs in the index table
+		size_t run_count() const
+		{
+			return _runs.size();
+		}
+
+		/// @brief Gets the image offset of the first channel of a pixel, or -1 if the pixel isn't mapped
+		int get_offset(int x, int y) const;
+
+		/// @brief Fills the image from an 8-bit matrix the same size as the map
+		void fill(const pixel_source& source, dmx_value* image) const;
+
+		/// @brief Fills the image from a 32-bit float matrix the same size as the map, values are 0-1
+		void fill_float(const pixel_source& source, dmx_value* image) const;
+
+	private:
+		void build_runs();
+	};
+}
@@ -5,7 +5,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <unordered_map>
 #include "common.hpp"
+#include "response_curve.hpp"
 
 namespace lxmax
 {
@@ -61,16 +67,57 @@ namespace lxmax
         inline std::string to_string(value_precision value)
         {
 	        const auto it = k_precision_to_string_map.find(value);
-            assert(it != std::end(k_precision_to_string_map),
-                            "All valid value precisions should exist in map");
+            assert(it != std::end(k_precision_to_string_map)
+                            && "All valid value precisions should exist in map");
             
             return it->second;
         }
+
+        /// @brief Gets the number of DMX channels a value of the precision occupies
+        inline int get_width(value_precision value)
+        {
+	        switch(value)
+	        {
+		        default:
+		        case value_precision::_8bit:
+			        return 1;
+		        case value_precision::_16bit:
+		        case value_precision::_16bit_le:
+			        return 2;
+		        case value_precision::_24bit:
+		        case value_precision::_24bit_le:
+			        return 3;
+		        case value_precision::_32bit:
+		        case value_precision::_32bit_le:
+			        return 4;
+	        }
+        }
+
+        /// @brief Gets the maximum raw value of the precision
+        inline uint32_t get_max(value_precision value)
+        {
+	        switch(value)
+	        {
+		        default:
+		        case value_precision::_8bit:
+			        return k_dmx_8bit_max;
+		        case value_precision::_16bit:
+		        case value_precision::_16bit_le:
+			        return k_dmx_16bit_max;
+		        case value_precision::_24bit:
+		        case value_precision::_24bit_le:
+			        return k_dmx_24bit_max;
+		        case value_precision::_32bit:
+		        case value_precision::_32bit_le:
+			        return k_dmx_32bit_max;
+	        }
+        }
     }
 
-	inline void write_with_precision_ltp(double value, double max, dmx_value* data, value_precision precision)
+	inline void write_with_precision_ltp(double value, double max, dmx_value* data, value_precision precision,
+	                                     const response_curve* curve = nullptr)
 	{
-		const double norm_value = value / max;
+		const double norm_value = curve ? curve->apply(value / max) : value / max;
 
 		uint32_t ranged_value = 0;
 		
@@ -104,9 +151,9 @@ namespace lxmax
 				break;
 			case value_precision::_24bit_le:
 				ranged_value = (uint32_t)std::round(norm_value * k_dmx_24bit_max);
-				*data =  ranged_value & 0x0000FF;
+				*data++ =  ranged_value & 0x0000FF;
 				*data++ =  (ranged_value & 0x00FF00) >> 8;
-				*data++ =  ranged_value >> 16;
+				*data =  ranged_value >> 16;
 				break;
 			case value_precision::_32bit_le:
 				ranged_value = (uint32_t)std::round(norm_value * k_dmx_32bit_max);
@@ -120,55 +167,75 @@ namespace lxmax
 		}
 	}
 
-	inline void write_with_precision_htp(double value, double max, dmx_value* data, value_precision precision)
+	/// @brief Reads the raw value of the precision from the buffer
+	inline uint32_t read_with_precision(const dmx_value* data, value_precision precision)
 	{
-		const double norm_value = value / max;
-
-		uint32_t ranged_value = 0;
-		
 		switch(precision)
 		{
 			case value_precision::_8bit:
-				*data = std::max(*data, (dmx_value)std::round(norm_value * k_dmx_8bit_max));
-				break;
+				return data[0];
 			case value_precision::_16bit:
-				ranged_value = (uint32_t)std::round(norm_value * k_dmx_16bit_max);
-				*data++ = std::max(*data, (dmx_value)(ranged_value >> 8));
-				*data = std::max(*data, (dmx_value)(ranged_value & 0x00FF));
-				break;
+				return ((uint32_t)data[0] << 8) | data[1];
 			case value_precision::_24bit:
-				ranged_value = (uint32_t)std::round(norm_value * k_dmx_24bit_max);
-				*data++ = std::max(*data, (dmx_value)(ranged_value >> 16));
-				*data++ = std::max(*data, (dmx_value)((ranged_value & 0x00FF00) >> 8));
-				*data = std::max(*data, (dmx_value)(ranged_value & 0x0000FF));
-				break;
+				return ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
 			case value_precision::_32bit:
-				ranged_value = (uint32_t)std::round(norm_value * k_dmx_32bit_max);
-				*data++ = std::max(*data, (dmx_value)(ranged_value >> 24));
-				*data++ = std::max(*data, (dmx_value)((ranged_value & 0x00FF0000) >> 16));
-				*data++ = std::max(*data, (dmx_value)((ranged_value & 0x0000FF00) >> 8));
-				*data = std::max(*data, (dmx_value)(ranged_value & 0x000000FF));
-				break;
+				return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
 			case value_precision::_16bit_le:
-				ranged_value = (uint32_t)std::round(norm_value * k_dmx_16bit_max);
-				*data++ = std::max(*data, (dmx_value)(ranged_value & 0x00FF));
-				*data = std::max(*data, (dmx_value)(ranged_value >> 8));
-				break;
+				return ((uint32_t)data[1] << 8) | data[0];
 			case value_precision::_24bit_le:
-				ranged_value = (uint32_t)std::round(norm_value * k_dmx_24bit_max);
-				*data = std::max(*data, (dmx_value)(ranged_value & 0x0000FF));
-				*data++ = std::max(*data, (dmx_value)((ranged_value & 0x00FF00) >> 8));
-				*data++ = std::max(*data, (dmx_value)(ranged_value >> 16));
-				break;
+				return ((uint32_t)data[2] << 16) | ((uint32_t)data[1] << 8) | data[0];
 			case value_precision::_32bit_le:
-				ranged_value = (uint32_t)std::round(norm_value * k_dmx_32bit_max);
-				*data++ = std::max(*data, (dmx_value)(ranged_value & 0x000000FF));
-				*data++ = std::max(*data, (dmx_value)((ranged_value & 0x0000FF00) >> 8));
-				*data++ = std::max(*data, (dmx_value)((ranged_value & 0x00FF0000) >> 16));
-				*data = std::max(*data, (dmx_value)(ranged_value >> 24));
-				break;
+				return ((uint32_t)data[3] << 24) | ((uint32_t)data[2] << 16) | ((uint32_t)data[1] << 8) | data[0];
 			default:
-				break;
+				return 0;
+		}
+	}
+
+	/// @brief Writes the value only if it is larger than the value of the same precision already in the buffer
+	///
+	/// Multi-byte values are compared whole, as taking the larger of each byte separately can combine the coarse
+	/// byte of one value with the fine byte of another.
+	inline void write_with_precision_htp(double value, double max, dmx_value* data, value_precision precision,
+	                                     const response_curve* curve = nullptr)
+	{
+		const double norm_value = curve ? curve->apply(value / max) : value / max;
+
+		const uint32_t ranged_value = (uint32_t)std::round(norm_value * precision_helper::get_max(precision));
+
+		if (ranged_value <= read_with_precision(data, precision))
+			return;
+
+		write_with_precision_ltp(norm_value, 1., data, precision);
+	}
+
+	/// @brief Writes a normalized value at a fixed precision, chosen once with get_ltp_writer rather than per value
+	using precision_writer = void (*)(double norm_value, dmx_value* data);
+
+	template<value_precision P>
+	void write_normalized_ltp(double norm_value, dmx_value* data)
+	{
+		write_with_precision_ltp(norm_value, 1., data, P);
+	}
+
+	inline precision_writer get_ltp_writer(value_precision precision)
+	{
+		switch(precision)
+		{
+			default:
+			case value_precision::_8bit:
+				return &write_normalized_ltp<value_precision::_8bit>;
+			case value_precision::_16bit:
+				return &write_normalized_ltp<value_precision::_16bit>;
+			case value_precision::_24bit:
+				return &write_normalized_ltp<value_precision::_24bit>;
+			case value_precision::_32bit:
+				return &write_normalized_ltp<value_precision::_32bit>;
+			case value_precision::_16bit_le:
+				return &write_normalized_ltp<value_precision::_16bit_le>;
+			case value_precision::_24bit_le:
+				return &write_normalized_ltp<value_precision::_24bit_le>;
+			case value_precision::_32bit_le:
+				return &write_normalized_ltp<value_precision::_32bit_le>;
 		}
 	}
 }
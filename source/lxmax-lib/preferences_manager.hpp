@@ -20,6 +20,7 @@
 #include "version_info.hpp"
 #include "global_config.hpp"
 #include "dmx_universe_config.hpp"
+#include "trace.hpp"
 
 namespace lxmax
 {
@@ -103,17 +104,27 @@ namespace lxmax
 		void fire_global_config_changed()
 		{
 			if (_is_events_disabled)
+			{
 				_is_pending_global_config_event = true;
+			}
 			else
+			{
+				LXMAX_TRACE_SCOPE("config", "global_config_changed");
 				global_config_changed(this);
+			}
 		}
 
 		void fire_universe_config_changed()
 		{
 			if (_is_events_disabled)
+			{
 				_is_pending_universe_config_event = true;
+			}
 			else
+			{
+				LXMAX_TRACE_SCOPE("config", "universe_config_changed");
 				universe_config_changed(this);
+			}
 		}
 		
 		void create_default()
@@ -128,6 +139,8 @@ namespace lxmax
 
 		void load()
 		{
+			LXMAX_TRACE_SCOPE("config", "load");
+
 			if (!Poco::File(_preferences_path).exists())
 			{
 				poco_information(_log, "No preference file found. Creating default LXMax preferences...");
@@ -198,6 +211,8 @@ namespace lxmax
 		
 		void save()
 		{
+			LXMAX_TRACE_SCOPE("config", "save");
+
 			Poco::Util::JSONConfiguration preferences;
 
 			preferences.setInt(k_lxmax_version_major, GIT_VERSION_MAJOR);
@@ -0,0 +1,73 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "response_curve.hpp"
+
+#include <cmath>
+
+namespace lxmax
+{
+	response_curve::response_curve(std::string name, const std::function<double(double)>& function)
+		: _name(std::move(name))
+	{
+		_table.reserve(k_table_size);
+
+		for (size_t i = 0; i < k_table_size; ++i)
+			_table.push_back(static_cast<float>(std::clamp(function(double(i) / (k_table_size - 1)), 0., 1.)));
+	}
+
+	response_curve_registry::response_curve_registry()
+	{
+		_functions.emplace("linear", [](double x) { return x; });
+
+		_functions.emplace("square", [](double x) { return x * x; });
+
+		_functions.emplace("s_curve", [](double x) { return x * x * (3. - 2. * x); });
+
+		// Inverse of CIE 1976 lightness, so equal steps in level look like equal steps in brightness
+		_functions.emplace("led", [](double x)
+		{
+			const double l = x * 100.;
+			return l > 8. ? std::pow((l + 16.) / 116., 3.) : l / 903.3;
+		});
+	}
+
+	void response_curve_registry::define(const std::string& name, std::function<double(double)> function)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_functions[name] = std::move(function);
+		_curves.erase(name);
+	}
+
+	std::shared_ptr<const response_curve> response_curve_registry::get(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		const auto curve = _curves.find(name);
+		if (curve != std::end(_curves))
+			return curve->second;
+
+		const auto function = _functions.find(name);
+		if (function == std::end(_functions))
+			return nullptr;
+
+		auto compiled = std::make_shared<const response_curve>(name, function->second);
+		_curves.emplace(name, compiled);
+
+		return compiled;
+	}
+
+	std::vector<std::string> response_curve_registry::get_names()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		std::vector<std::string> names;
+		for (const auto& f : _functions)
+			names.push_back(f.first);
+
+		return names;
+	}
+}
@@ -0,0 +1,69 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lxmax
+{
+	/// @brief Response curve compiled into a lookup table, mapping normalized levels to normalized output
+	///
+	class response_curve
+	{
+	public:
+		static const size_t k_table_size = 4096;
+
+	private:
+		std::string _name;
+		std::vector<float> _table;
+
+	public:
+		response_curve(std::string name, const std::function<double(double)>& function);
+
+		const std::string& name() const
+		{
+			return _name;
+		}
+
+		/// @brief Applies the curve, interpolating between table entries
+		double apply(double norm_value) const
+		{
+			const double position = std::clamp(norm_value, 0., 1.) * (k_table_size - 1);
+			const size_t index = std::min(static_cast<size_t>(position), k_table_size - 2);
+			const double fraction = position - index;
+
+			return _table[index] + (_table[index + 1] - _table[index]) * fraction;
+		}
+	};
+
+	/// @brief Named response curves shared by all fixtures using them
+	///
+	/// The built in curves are linear, square (square law), s_curve and led (perceptual lightness to linear
+	/// LED output). Tables are only built when a curve is first used.
+	class response_curve_registry
+	{
+		std::mutex _mutex;
+		std::map<std::string, std::function<double(double)>> _functions;
+		std::map<std::string, std::shared_ptr<const response_curve>> _curves;
+
+	public:
+		response_curve_registry();
+
+		/// @brief Adds or replaces a named curve, fixtures already using the old curve keep its table
+		void define(const std::string& name, std::function<double(double)> function);
+
+		/// @returns nullptr if no curve has the name
+		std::shared_ptr<const response_curve> get(const std::string& name);
+
+		std::vector<std::string> get_names();
+	};
+}
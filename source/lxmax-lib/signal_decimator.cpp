@@ -0,0 +1,141 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "signal_decimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lxmax
+{
+	signal_decimator::signal_decimator(size_t channel_count)
+		: _accumulators(channel_count),
+		_vector_accumulators(channel_count),
+		_values(new std::atomic<float>[channel_count * 2]),
+		_frame_values(channel_count, 0.f)
+	{
+		for (size_t i = 0; i < channel_count * 2; ++i)
+			_values[i].store(0.f, std::memory_order_relaxed);
+
+		_has_samples[0].store(false, std::memory_order_relaxed);
+		_has_samples[1].store(false, std::memory_order_relaxed);
+	}
+
+	void signal_decimator::begin_vector()
+	{
+		std::fill(std::begin(_vector_accumulators), std::end(_vector_accumulators), accumulator());
+
+		const uint32_t frame = _frame.load(std::memory_order_acquire);
+
+		if (frame == _accumulator_frame)
+			return;
+
+		std::fill(std::begin(_accumulators), std::end(_accumulators), accumulator());
+		_accumulator_frame = frame;
+	}
+
+	void signal_decimator::process(size_t channel, const double* samples, size_t count)
+	{
+		if (channel >= _vector_accumulators.size() || count == 0)
+			return;
+
+		accumulator& a = _vector_accumulators[channel];
+
+		double peak = a.peak;
+		double sum = a.sum;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			peak = std::max(peak, std::abs(samples[i]));
+			sum += samples[i];
+		}
+
+		a.peak = peak;
+		a.sum = sum;
+		a.count += count;
+		a.last = samples[count - 1];
+	}
+
+	void signal_decimator::end_vector()
+	{
+		for (size_t i = 0; i < _accumulators.size(); ++i)
+		{
+			accumulator& a = _accumulators[i];
+			const accumulator& v = _vector_accumulators[i];
+
+			if (v.count == 0)
+				continue;
+
+			a.peak = std::max(a.peak, v.peak);
+			a.sum += v.sum;
+			a.count += v.count;
+			a.last = v.last;
+		}
+
+		publish(_accumulator_frame);
+
+		// Either the output thread sees this vector in the frame it ends, or the vector is seen here to have finished
+		// after the frame ended and is published again as the start of the next one
+		const uint32_t frame = _frame.load(std::memory_order_seq_cst);
+
+		if (frame == _accumulator_frame)
+			return;
+
+		_accumulators = _vector_accumulators;
+		_accumulator_frame = frame;
+
+		publish(frame);
+	}
+
+	void signal_decimator::publish(uint32_t frame)
+	{
+		const decimation_mode mode = _mode.load(std::memory_order_relaxed);
+		std::atomic<float>* values = _values.get() + (frame % 2) * _accumulators.size();
+
+		for (size_t i = 0; i < _accumulators.size(); ++i)
+		{
+			const accumulator& a = _accumulators[i];
+
+			double value;
+
+			switch (mode)
+			{
+				default:
+				case decimation_mode::peak:
+					value = a.peak;
+					break;
+				case decimation_mode::mean:
+					value = a.count > 0 ? a.sum / a.count : 0.;
+					break;
+				case decimation_mode::last:
+					value = a.last;
+					break;
+			}
+
+			values[i].store(static_cast<float>(value), std::memory_order_relaxed);
+		}
+
+		_has_samples[frame % 2].store(true, std::memory_order_seq_cst);
+	}
+
+	bool signal_decimator::end_frame()
+	{
+		// Only this thread changes the frame, the next frame's slot was last read two frames ago
+		const uint32_t frame = _frame.load(std::memory_order_relaxed);
+		_has_samples[(frame + 1) % 2].store(false, std::memory_order_relaxed);
+
+		_frame.fetch_add(1, std::memory_order_seq_cst);
+
+		if (!_has_samples[frame % 2].load(std::memory_order_seq_cst))
+			return false;
+
+		const std::atomic<float>* values = _values.get() + (frame % 2) * _frame_values.size();
+
+		for (size_t i = 0; i < _frame_values.size(); ++i)
+			_frame_values[i] = values[i].load(std::memory_order_relaxed);
+
+		return true;
+	}
+}
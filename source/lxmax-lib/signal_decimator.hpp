@@ -0,0 +1,101 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lxmax
+{
+	/// @brief How the samples received during a DMX frame are reduced to a single value
+	///
+	enum class decimation_mode
+	{
+		peak,	// Largest absolute sample
+		mean,
+		last,
+		enum_count
+	};
+
+	/// @brief Reduces signal vectors to one value per channel per DMX frame without locking
+	///
+	/// The audio thread calls begin_vector, process for each channel and end_vector, publishing the frame's value
+	/// so far after every vector. The output thread calls end_frame and then reads the values of the frame it ended.
+	///
+	/// Frames alternate between two slots of published values, so ending a frame and reading it is a single step. A
+	/// vector which was still being processed when its frame ended is carried into the next frame, so no samples are
+	/// lost between frames.
+	class signal_decimator
+	{
+		struct accumulator
+		{
+			double peak { 0. };
+			double sum { 0. };
+			size_t count { 0 };
+			double last { 0. };
+		};
+
+		// Only touched by the audio thread
+		std::vector<accumulator> _accumulators;
+		std::vector<accumulator> _vector_accumulators;
+		uint32_t _accumulator_frame { 0 };
+
+		// Two slots of channel values, written by the audio thread in the slot of the frame's parity
+		std::unique_ptr<std::atomic<float>[]> _values;
+		std::atomic<bool> _has_samples[2];
+		std::atomic<decimation_mode> _mode { decimation_mode::peak };
+		std::atomic<uint32_t> _frame { 0 };
+
+		// Only touched by the output thread
+		std::vector<float> _frame_values;
+
+		void publish(uint32_t frame);
+
+	public:
+		explicit signal_decimator(size_t channel_count);
+
+		size_t channel_count() const
+		{
+			return _accumulators.size();
+		}
+
+		decimation_mode mode() const
+		{
+			return _mode;
+		}
+
+		void set_mode(decimation_mode mode)
+		{
+			_mode = mode;
+		}
+
+		/// @brief Starts a signal vector, resetting the accumulators if the output thread has ended the frame
+		void begin_vector();
+
+		void process(size_t channel, const double* samples, size_t count);
+
+		/// @brief Publishes the frame's values including the vector just processed
+		void end_vector();
+
+		/// @returns true if any samples have been published since the last frame ended
+		bool has_samples() const
+		{
+			return _has_samples[_frame.load(std::memory_order_acquire) % 2].load(std::memory_order_acquire);
+		}
+
+		/// @brief Gets a channel's value from the last frame ended with samples
+		float value(size_t channel) const
+		{
+			return _frame_values[channel];
+		}
+
+		/// @brief Ends the current frame and reads its values, a new frame starts at the audio thread's next vector
+		/// @returns true if any samples were published during the frame, otherwise the values are left unchanged
+		bool end_frame();
+	};
+}
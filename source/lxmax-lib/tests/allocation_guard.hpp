@@ -0,0 +1,29 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include "allocation_counter.hpp"
+
+namespace lxmax
+{
+	/// @brief Counts the allocations made by any thread while in scope
+	///
+	class allocation_guard
+	{
+		const uint64_t _start_count;
+
+	public:
+		allocation_guard()
+			: _start_count(get_allocation_count())
+		{
+		}
+
+		uint64_t allocation_count() const
+		{
+			return get_allocation_count() - _start_count;
+		}
+	};
+}
@@ -0,0 +1,178 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <atomic>
+#include <thread>
+#include <Poco/Net/NetException.h>
+
+#include "artnet_discovery.hpp"
+
+using namespace lxmax;
+
+/// @brief Stand-in for an Art-Net node which answers polls on loopback
+///
+class artnet_node_simulator
+{
+	Poco::Net::DatagramSocket _socket;
+	std::thread _thread;
+	std::atomic<bool> _is_running { true };
+	std::atomic<bool> _is_replying { true };
+	artpollreply_packet _reply;
+
+	void run()
+	{
+		std::vector<char> buffer(1024);
+
+		while (_is_running)
+		{
+			if (!_socket.poll(Poco::Timespan(0, 10000), Poco::Net::Socket::SELECT_READ))
+				continue;
+
+			Poco::Net::SocketAddress sender;
+			const int length = _socket.receiveFrom(buffer.data(), static_cast<int>(buffer.size()), sender);
+
+			artpoll_packet poll;
+			if (!_is_replying || !artpoll_packet::deserialize(buffer.data(), length, poll))
+				continue;
+
+			const auto reply_buffer = _reply.serialize();
+			_socket.sendTo(reply_buffer.data(), static_cast<int>(reply_buffer.size()), sender);
+		}
+	}
+
+public:
+	artnet_node_simulator(uint8_t net, uint8_t sub_net, std::vector<uint8_t> output_universes)
+		: _socket(Poco::Net::SocketAddress("127.0.0.1", 0))
+	{
+		const uint8_t loopback[] { 127, 0, 0, 1 };
+		memcpy(_reply.ip_address, loopback, sizeof(loopback));
+		strncpy(_reply.short_name, "Simulator", sizeof(_reply.short_name));
+		_reply.net_switch = net;
+		_reply.sub_switch = sub_net;
+		_reply.num_ports = static_cast<uint16_t>(output_universes.size());
+
+		for (size_t i = 0; i < output_universes.size() && i < 4; ++i)
+		{
+			_reply.port_types[i] = k_artnet_port_type_output;
+			_reply.sw_out[i] = output_universes[i];
+		}
+
+		_thread = std::thread(&artnet_node_simulator::run, this);
+	}
+
+	~artnet_node_simulator()
+	{
+		_is_running = false;
+		_thread.join();
+	}
+
+	Poco::Net::SocketAddress address() const
+	{
+		return _socket.address();
+	}
+
+	void set_replying(bool value)
+	{
+		_is_replying = value;
+	}
+};
+
+template<typename Predicate>
+bool wait_for(Predicate predicate, milliseconds timeout = milliseconds(3000))
+{
+	const auto end = clock::now() + timeout;
+
+	while (clock::now() < end)
+	{
+		if (predicate())
+			return true;
+
+		std::this_thread::sleep_for(milliseconds(10));
+	}
+
+	return predicate();
+}
+
+SCENARIO("ArtPollReply port-addresses are decoded")
+{
+	GIVEN("A reply with two output ports and one input port")
+	{
+		artpollreply_packet reply;
+		reply.net_switch = 0x01;
+		reply.sub_switch = 0x02;
+		reply.num_ports = 3;
+		reply.port_types[0] = k_artnet_port_type_output;
+		reply.port_types[1] = k_artnet_port_type_output;
+		reply.port_types[2] = 0x40;
+		reply.sw_out[0] = 0x03;
+		reply.sw_out[1] = 0x04;
+
+		const auto buffer = reply.serialize();
+
+		THEN("it deserializes to the same ports")
+		{
+			artpollreply_packet decoded;
+			REQUIRE(artpollreply_packet::deserialize(buffer.data(), buffer.size(), decoded));
+			REQUIRE(decoded.is_output_port(0));
+			REQUIRE(decoded.is_output_port(1));
+			REQUIRE(!decoded.is_output_port(2));
+			REQUIRE(decoded.port_address(0, true) == 0x0123);
+			REQUIRE(decoded.port_address(1, true) == 0x0124);
+		}
+
+		THEN("truncated packets are rejected")
+		{
+			artpollreply_packet decoded;
+			REQUIRE(!artpollreply_packet::deserialize(buffer.data(), 100, decoded));
+		}
+	}
+}
+
+SCENARIO("Art-Net discovery builds a subscriber table from a simulated node")
+{
+	GIVEN("A node simulator outputting two universes on loopback")
+	{
+		artnet_node_simulator simulator(0x00, 0x01, { 0x00, 0x05 });
+
+		Poco::Net::DatagramSocket controller_socket(Poco::Net::SocketAddress("127.0.0.1", 0));
+
+		artnet_discovery discovery(Poco::Logger::get("Art-Net Discovery Test"), milliseconds(100), milliseconds(500));
+		discovery.start(&controller_socket, simulator.address());
+
+		THEN("the node's universes are subscribed to by its address")
+		{
+			REQUIRE(wait_for([&] { return !discovery.get_subscribers(0x0010).empty(); }));
+
+			const auto subscribers = discovery.get_subscribers(0x0015);
+			REQUIRE(subscribers.size() == 1);
+			REQUIRE(subscribers[0] == Poco::Net::IPAddress("127.0.0.1"));
+
+			REQUIRE(discovery.get_subscribers(0x0011).empty());
+
+			const auto nodes = discovery.get_nodes();
+			REQUIRE(nodes.size() == 1);
+			REQUIRE(nodes.begin()->second.short_name == "Simulator");
+		}
+
+		WHEN("the node stops replying")
+		{
+			REQUIRE(wait_for([&] { return !discovery.get_subscribers(0x0010).empty(); }));
+
+			const uint64_t generation = discovery.generation();
+			simulator.set_replying(false);
+
+			THEN("it is removed from the table once it times out")
+			{
+				REQUIRE(wait_for([&] { return discovery.get_subscribers(0x0010).empty(); }));
+				REQUIRE(discovery.generation() > generation);
+				REQUIRE(discovery.get_nodes().empty());
+			}
+		}
+
+		discovery.stop();
+	}
+}
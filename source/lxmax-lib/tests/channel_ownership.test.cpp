@@ -0,0 +1,155 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <algorithm>
+
+#include "channel_ownership.hpp"
+
+using namespace lxmax;
+
+namespace
+{
+	/// @brief Writes a value to every channel of a range as a fixture does, resolved against the channel owners
+	void write_range(channel_ownership& owners, universe_buffer_map& buffers, const dmx_channel_range& range,
+	                 timestamp updated, bool is_htp, dmx_value value)
+	{
+		owners.begin_write(range, updated, is_htp, buffers);
+
+		for (channel_address c = range.start(); c < range.end(); ++c)
+		{
+			dmx_value& channel = buffers[c / k_universe_length][c % k_universe_length];
+			channel = is_htp ? std::max(channel, value) : value;
+		}
+
+		owners.end_write(range, updated, is_htp, buffers, true);
+	}
+}
+
+SCENARIO("Channel ownership resolves LTP and HTP per channel")
+{
+	GIVEN("Two overlapping ranges in one universe")
+	{
+		universe_buffer_map buffers;
+		buffers[1] = universe_buffer();
+
+		channel_ownership owners;
+
+		const dmx_channel_range older_range(1, 1, 10);
+		const dmx_channel_range newer_range(1, 6, 10);
+
+		const timestamp older = clock::now();
+		const timestamp newer = older + milliseconds(1);
+
+		THEN("an older LTP write only changes the channels the newer write doesn't own")
+		{
+			write_range(owners, buffers, newer_range, newer, false, 200);
+			write_range(owners, buffers, older_range, older, false, 100);
+
+			REQUIRE(buffers[1][0] == 100);
+			REQUIRE(buffers[1][4] == 100);
+			REQUIRE(buffers[1][5] == 200);
+			REQUIRE(buffers[1][14] == 200);
+
+			REQUIRE((owners.get_owner(1, 4).updated == older));
+			REQUIRE((owners.get_owner(1, 5).updated == newer));
+		}
+
+		THEN("a newer LTP write replaces the overlapping channels")
+		{
+			write_range(owners, buffers, older_range, older, false, 100);
+			write_range(owners, buffers, newer_range, newer, false, 200);
+
+			REQUIRE(buffers[1][4] == 100);
+			REQUIRE(buffers[1][5] == 200);
+			REQUIRE(buffers[1][9] == 200);
+		}
+
+		THEN("HTP writes merge whichever was updated last")
+		{
+			write_range(owners, buffers, newer_range, newer, true, 50);
+			write_range(owners, buffers, older_range, older, true, 100);
+
+			REQUIRE(buffers[1][5] == 100);
+			REQUIRE(buffers[1][14] == 50);
+			REQUIRE(owners.get_owner(1, 5).is_htp);
+			REQUIRE((owners.get_owner(1, 5).updated == newer));
+		}
+
+		THEN("cleared HTP channels can be merged to a lower value")
+		{
+			write_range(owners, buffers, older_range, older, true, 100);
+			write_range(owners, buffers, newer_range, newer, true, 50);
+
+			const timestamp latest = newer + milliseconds(1);
+			owners.clear_htp_channels(older_range, latest, buffers);
+
+			REQUIRE(buffers[1][5] == 0);
+			REQUIRE(buffers[1][14] == 50);
+
+			write_range(owners, buffers, older_range, latest, true, 20);
+			write_range(owners, buffers, newer_range, newer, true, 50);
+
+			REQUIRE(buffers[1][0] == 20);
+			REQUIRE(buffers[1][5] == 50);
+		}
+
+		THEN("a newer LTP write isn't changed by older HTP writes or cleared by them")
+		{
+			write_range(owners, buffers, newer_range, newer, false, 30);
+
+			owners.clear_htp_channels(older_range, older, buffers);
+			write_range(owners, buffers, older_range, older, true, 100);
+
+			REQUIRE(buffers[1][4] == 100);
+			REQUIRE(buffers[1][5] == 30);
+		}
+
+		THEN("reset forgets every owner")
+		{
+			write_range(owners, buffers, newer_range, newer, false, 200);
+			owners.reset();
+
+			REQUIRE(!owners.get_owner(1, 5).is_owned());
+
+			write_range(owners, buffers, older_range, older, false, 100);
+			REQUIRE(buffers[1][5] == 100);
+		}
+	}
+
+	GIVEN("A range spanning two universes")
+	{
+		universe_buffer_map buffers;
+		buffers[1] = universe_buffer();
+		buffers[2] = universe_buffer();
+
+		channel_ownership owners;
+
+		const timestamp older = clock::now();
+		const timestamp newer = older + milliseconds(1);
+
+		write_range(owners, buffers, dmx_channel_range(2, 1, 4), newer, false, 200);
+		write_range(owners, buffers, dmx_channel_range(1, 509, 8), older, false, 100);
+
+		THEN("channels in each universe are resolved")
+		{
+			REQUIRE(buffers[1][508] == 100);
+			REQUIRE(buffers[1][511] == 100);
+			REQUIRE(buffers[2][0] == 200);
+			REQUIRE(buffers[2][3] == 200);
+			REQUIRE(buffers[2][4] == 0);
+		}
+	}
+
+	GIVEN("Adjacent ranges")
+	{
+		THEN("they don't overlap")
+		{
+			REQUIRE(!dmx_channel_range(1, 1, 4).is_overlapping_with(dmx_channel_range(1, 5, 4)));
+			REQUIRE(dmx_channel_range(1, 1, 5).is_overlapping_with(dmx_channel_range(1, 5, 4)));
+		}
+	}
+}
@@ -0,0 +1,220 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#include "color_processor.hpp"
+#include "common.hpp"
+
+using namespace lxmax;
+
+template<typename T>
+struct color_planes
+{
+	std::vector<T> a;
+	std::vector<T> b;
+	std::vector<T> c;
+
+	void push_back(T x, T y, T z)
+	{
+		a.push_back(x);
+		b.push_back(y);
+		c.push_back(z);
+	}
+
+	void resize(size_t size)
+	{
+		a.resize(size);
+		b.resize(size);
+		c.resize(size);
+	}
+
+	size_t size() const
+	{
+		return a.size();
+	}
+
+	bool is_bit_exact(const color_planes& other) const
+	{
+		return size() == other.size()
+			&& memcmp(a.data(), other.a.data(), a.size() * sizeof(T)) == 0
+			&& memcmp(b.data(), other.b.data(), b.size() * sizeof(T)) == 0
+			&& memcmp(c.data(), other.c.data(), c.size() * sizeof(T)) == 0;
+	}
+};
+
+/// @brief Every combination of 0-1 in eighths, including greys, black and the primaries, plus random colors.
+/// The odd count leaves a scalar tail after the vector loop.
+template<typename T>
+color_planes<T> make_test_vectors()
+{
+	color_planes<T> values;
+
+	for (int x = 0; x <= 8; ++x)
+	{
+		for (int y = 0; y <= 8; ++y)
+		{
+			for (int z = 0; z <= 8; ++z)
+				values.push_back(T(x) / T(8), T(y) / T(8), T(z) / T(8));
+		}
+	}
+
+	std::mt19937 generator(1234);
+	std::uniform_real_distribution<T> distribution(T(0), T(1));
+
+	for (int i = 0; i < 1001; ++i)
+		values.push_back(distribution(generator), distribution(generator), distribution(generator));
+
+	return values;
+}
+
+template<typename T>
+void require_batch_matches_scalar()
+{
+	const auto input = make_test_vectors<T>();
+
+	color_planes<T> scalar;
+	scalar.resize(input.size());
+
+	color_planes<T> batch;
+	batch.resize(input.size());
+
+	for (size_t i = 0; i < input.size(); ++i)
+		color_conversion::rgb_to_hsb(input.a[i], input.b[i], input.c[i], scalar.a[i], scalar.b[i], scalar.c[i]);
+
+	color_processor::rgb_to_hsb_batch(input.a.data(), input.b.data(), input.c.data(),
+	                                  batch.a.data(), batch.b.data(), batch.c.data(), input.size());
+
+	REQUIRE(batch.is_bit_exact(scalar));
+
+	for (size_t i = 0; i < input.size(); ++i)
+		color_conversion::hsb_to_rgb(input.a[i], input.b[i], input.c[i], scalar.a[i], scalar.b[i], scalar.c[i]);
+
+	color_processor::hsb_to_rgb_batch(input.a.data(), input.b.data(), input.c.data(),
+	                                  batch.a.data(), batch.b.data(), batch.c.data(), input.size());
+
+	REQUIRE(batch.is_bit_exact(scalar));
+
+	for (size_t i = 0; i < input.size(); ++i)
+		scalar.a[i] = T(1) - input.a[i];
+
+	color_processor::invert_batch(input.a.data(), batch.a.data(), input.size());
+
+	REQUIRE(memcmp(batch.a.data(), scalar.a.data(), input.size() * sizeof(T)) == 0);
+}
+
+SCENARIO("Batch color conversions match single conversions")
+{
+	THEN("float conversions are bit-exact")
+	{
+		require_batch_matches_scalar<float>();
+	}
+
+	THEN("double conversions are bit-exact")
+	{
+		require_batch_matches_scalar<double>();
+	}
+}
+
+SCENARIO("Grey and fully saturated colors convert cleanly")
+{
+	GIVEN("A grey")
+	{
+		color_processor processor;
+		processor.set_rgb(0.5, 0.5, 0.5);
+
+		THEN("its hue is zero rather than undefined")
+		{
+			const auto hsb = processor.get_hsb();
+			REQUIRE(hsb[0] == 0.);
+			REQUIRE(hsb[1] == 0.);
+			REQUIRE(hsb[2] == 0.5);
+		}
+	}
+
+	GIVEN("A hue of 1")
+	{
+		color_processor processor;
+		processor.set_hsb(1., 1., 1.);
+
+		THEN("it wraps around to red")
+		{
+			const auto rgb = processor.get_rgb();
+			REQUIRE(rgb[0] == 1.);
+			REQUIRE(rgb[1] == 0.);
+			REQUIRE(rgb[2] == 0.);
+		}
+	}
+}
+
+TEST_CASE("Batch color conversion of 170 pixels x 100 universes", "[.][benchmark]")
+{
+	const size_t pixel_count = 170 * 100;
+	const int frame_count = 200;
+
+	color_planes<double> input;
+	std::mt19937 generator(1234);
+	std::uniform_real_distribution<double> distribution(0., 1.);
+
+	for (size_t i = 0; i < pixel_count; ++i)
+		input.push_back(distribution(generator), distribution(generator), distribution(generator));
+
+	color_planes<float> input_float;
+	for (size_t i = 0; i < pixel_count; ++i)
+		input_float.push_back(static_cast<float>(input.a[i]), static_cast<float>(input.b[i]), static_cast<float>(input.c[i]));
+
+	color_planes<double> output;
+	output.resize(pixel_count);
+
+	color_planes<float> output_float;
+	output_float.resize(pixel_count);
+
+	const auto measure = [&](const std::string& name, auto&& convert)
+	{
+		const auto start = clock::now();
+
+		for (int frame = 0; frame < frame_count; ++frame)
+			convert();
+
+		const auto per_frame = std::chrono::duration<double, std::micro>(clock::now() - start).count() / frame_count;
+		std::cout << name << ": " << per_frame << " us/frame" << std::endl;
+	};
+
+	measure("color_processor::get_hsb", [&]
+	{
+		color_processor processor;
+
+		for (size_t i = 0; i < pixel_count; ++i)
+		{
+			processor.set_rgb(input.a[i], input.b[i], input.c[i]);
+			const auto hsb = processor.get_hsb();
+			output.a[i] = hsb[0];
+			output.b[i] = hsb[1];
+			output.c[i] = hsb[2];
+		}
+	});
+
+	measure("rgb_to_hsb_batch (double)", [&]
+	{
+		color_processor::rgb_to_hsb_batch(input.a.data(), input.b.data(), input.c.data(),
+		                                  output.a.data(), output.b.data(), output.c.data(), pixel_count);
+	});
+
+	measure("rgb_to_hsb_batch (float)", [&]
+	{
+		color_processor::rgb_to_hsb_batch(input_float.a.data(), input_float.b.data(), input_float.c.data(),
+		                                  output_float.a.data(), output_float.b.data(), output_float.c.data(), pixel_count);
+	});
+
+	measure("hsb_to_rgb_batch (float)", [&]
+	{
+		color_processor::hsb_to_rgb_batch(input_float.a.data(), input_float.b.data(), input_float.c.data(),
+		                                  output_float.a.data(), output_float.b.data(), output_float.c.data(), pixel_count);
+	});
+}
@@ -0,0 +1,141 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include "color_write_plan.hpp"
+
+using namespace lxmax;
+
+SCENARIO("Color personality elements are parsed from strings")
+{
+	GIVEN("Elements with and without precision and data")
+	{
+		color_personality personality;
+		REQUIRE(from_string("R16 G16! Br F{200} F16{1000} _", personality));
+
+		THEN("each element is parsed")
+		{
+			REQUIRE(personality.size() == 6);
+
+			REQUIRE(personality[0].component == color_component::red);
+			REQUIRE(personality[0].precision == value_precision::_16bit);
+
+			REQUIRE(personality[1].component == color_component::green);
+			REQUIRE(personality[1].precision == value_precision::_16bit_le);
+
+			REQUIRE(personality[2].component == color_component::brightness);
+			REQUIRE(personality[2].precision == value_precision::_8bit);
+			REQUIRE(!personality[2].data.has_value());
+
+			REQUIRE(personality[3].component == color_component::fixed);
+			REQUIRE(personality[3].data.value() == 200);
+
+			REQUIRE(personality[4].precision == value_precision::_16bit);
+			REQUIRE(personality[4].data.value() == 1000);
+
+			REQUIRE(personality[5].component == color_component::none);
+		}
+
+		THEN("they convert back to the same string")
+		{
+			REQUIRE(to_string(personality) == "R16 G16! Br F{200} F16{1000} _");
+		}
+	}
+
+	GIVEN("Invalid elements")
+	{
+		color_personality_element e;
+
+		THEN("parsing fails")
+		{
+			REQUIRE(!color_personality_element::from_string("X", e));
+			REQUIRE(!color_personality_element::from_string("R12", e));
+			REQUIRE(!color_personality_element::from_string("R{", e));
+		}
+	}
+}
+
+SCENARIO("Color write plans write a color in the personality's layout")
+{
+	universe_buffer buffer { };
+
+	GIVEN("An RGB personality")
+	{
+		color_write_plan plan(color_personality_presets::k_rgb);
+
+		color_processor processor;
+		processor.set_rgb(1., 0.5, 0.);
+
+		plan.write(processor, 1., buffer.data(), k_universe_length);
+
+		THEN("one channel is written per component")
+		{
+			REQUIRE(plan.channel_count() == 3);
+			REQUIRE(buffer[0] == 255);
+			REQUIRE(buffer[1] == 128);
+			REQUIRE(buffer[2] == 0);
+			REQUIRE(buffer[3] == 0);
+		}
+	}
+
+	GIVEN("A personality mixing precisions, fixed values and intensity")
+	{
+		color_personality personality;
+		REQUIRE(from_string("I R16 F{200} C", personality));
+
+		color_write_plan plan(personality);
+
+		color_processor processor;
+		processor.set_rgb(1., 0., 0.);
+
+		WHEN("the whole plan fits")
+		{
+			plan.write(processor, 0.5, buffer.data(), k_universe_length);
+
+			THEN("each entry is written at its offset")
+			{
+				REQUIRE(plan.channel_count() == 5);
+				REQUIRE(buffer[0] == 128);
+				REQUIRE(buffer[1] == 0xFF);
+				REQUIRE(buffer[2] == 0xFF);
+				REQUIRE(buffer[3] == 200);
+				REQUIRE(buffer[4] == 0);
+			}
+		}
+
+		WHEN("the plan runs off the end of the universe")
+		{
+			plan.write(processor, 0.5, buffer.data(), 2);
+
+			THEN("entries which don't fit are not written")
+			{
+				REQUIRE(buffer[0] == 128);
+				REQUIRE(buffer[1] == 0);
+				REQUIRE(buffer[2] == 0);
+			}
+		}
+	}
+
+	GIVEN("An HSB personality fed an RGB color")
+	{
+		color_personality personality;
+		REQUIRE(from_string("H S Br", personality));
+
+		color_write_plan plan(personality);
+
+		color_processor processor;
+		processor.set_rgb(0., 0., 1.);
+
+		plan.write(processor, 1., buffer.data(), k_universe_length);
+
+		THEN("the color is converted")
+		{
+			REQUIRE(buffer[0] == 170);
+			REQUIRE(buffer[1] == 255);
+			REQUIRE(buffer[2] == 255);
+		}
+	}
+}
@@ -0,0 +1,148 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include "color_write_plan.hpp"
+#include "emitter_extraction.hpp"
+
+using namespace lxmax;
+
+/// @brief Emitters matching the sRGB primaries, with a D65 white and an amber between red and green
+emitter_calibration make_srgb_calibration()
+{
+	emitter_calibration calibration;
+	calibration.red = { 0.64, 0.33, 0.2126729 };
+	calibration.green = { 0.30, 0.60, 0.7151522 };
+	calibration.blue = { 0.15, 0.06, 0.0721750 };
+	calibration.white = { 0.3127, 0.3290, 1.0 };
+	calibration.amber = { 0.57, 0.42, 0.6 };
+
+	return calibration;
+}
+
+SCENARIO("White and amber are extracted from RGB without calibration")
+{
+	GIVEN("An RGBW fixture")
+	{
+		const auto values = extract_emitters({ 1., 0.8, 0.5 }, emitter_set::rgbw);
+
+		THEN("white takes the level common to all three")
+		{
+			REQUIRE(values.white == Approx(0.5));
+			REQUIRE(values.red == Approx(0.5));
+			REQUIRE(values.green == Approx(0.3));
+			REQUIRE(values.blue == Approx(0.));
+			REQUIRE(values.amber == 0.);
+		}
+	}
+
+	GIVEN("An RGBA fixture")
+	{
+		const auto values = extract_emitters({ 1., 0.5, 0. }, emitter_set::rgba);
+
+		THEN("amber replaces red with half green")
+		{
+			REQUIRE(values.amber == Approx(1.));
+			REQUIRE(values.red == Approx(0.));
+			REQUIRE(values.green == Approx(0.));
+		}
+	}
+
+	GIVEN("An RGBWA fixture")
+	{
+		const auto values = extract_emitters({ 1., 0.75, 0.5 }, emitter_set::rgbwa);
+
+		THEN("white is extracted before amber")
+		{
+			REQUIRE(values.white == Approx(0.5));
+			REQUIRE(values.amber == Approx(0.5));
+			REQUIRE(values.red == Approx(0.));
+			REQUIRE(values.green == Approx(0.));
+			REQUIRE(values.blue == Approx(0.));
+		}
+	}
+}
+
+SCENARIO("Calibrated emitter levels are looked up from a table")
+{
+	const auto calibration = make_srgb_calibration();
+
+	GIVEN("An RGBW fixture with sRGB emitters and a D65 white")
+	{
+		emitter_lut lut(calibration, emitter_set::rgbw);
+
+		THEN("white input is reproduced by the white emitter alone")
+		{
+			const auto values = lut.lookup({ 1., 1., 1. });
+			REQUIRE(values.white == Approx(1.).margin(1e-3));
+			REQUIRE(values.red == Approx(0.).margin(1e-3));
+			REQUIRE(values.green == Approx(0.).margin(1e-3));
+			REQUIRE(values.blue == Approx(0.).margin(1e-3));
+		}
+
+		THEN("primaries use only their own emitter")
+		{
+			const auto values = lut.lookup({ 0., 0., 1. });
+			REQUIRE(values.blue > 0.);
+			REQUIRE(values.red == Approx(0.).margin(1e-3));
+			REQUIRE(values.green == Approx(0.).margin(1e-3));
+			REQUIRE(values.white == Approx(0.).margin(1e-3));
+		}
+
+		THEN("lookups between grid points stay close to the exact solution")
+		{
+			const color_values rgb { 0.31, 0.77, 0.42 };
+			const auto looked_up = lut.lookup(rgb);
+			const auto solved = emitter_lut::solve(calibration, emitter_set::rgbw, rgb);
+
+			REQUIRE(looked_up.red == Approx(solved.red).margin(0.02));
+			REQUIRE(looked_up.green == Approx(solved.green).margin(0.02));
+			REQUIRE(looked_up.blue == Approx(solved.blue).margin(0.02));
+			REQUIRE(looked_up.white == Approx(solved.white).margin(0.02));
+		}
+	}
+
+	GIVEN("A cache of tables")
+	{
+		emitter_lut_cache cache;
+
+		const auto a = cache.get(calibration, emitter_set::rgbwa);
+		const auto b = cache.get(calibration, emitter_set::rgbwa);
+		const auto c = cache.get(calibration, emitter_set::rgbw);
+
+		THEN("fixtures with the same calibration share a table")
+		{
+			REQUIRE(a == b);
+			REQUIRE(a != c);
+		}
+	}
+}
+
+SCENARIO("Write plans output extracted emitters")
+{
+	GIVEN("An RGBW personality")
+	{
+		color_personality personality;
+		REQUIRE(from_string("R G B W", personality));
+
+		color_write_plan plan(personality);
+		REQUIRE(plan.get_emitter_set() == emitter_set::rgbw);
+
+		color_processor processor;
+		processor.set_rgb(1., 1., 0.);
+
+		universe_buffer buffer { };
+		plan.write(processor, 1., buffer.data(), k_universe_length);
+
+		THEN("red, green and blue carry only what white can't")
+		{
+			REQUIRE(buffer[0] == 255);
+			REQUIRE(buffer[1] == 255);
+			REQUIRE(buffer[2] == 0);
+			REQUIRE(buffer[3] == 0);
+		}
+	}
+}
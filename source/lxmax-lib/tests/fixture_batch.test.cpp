@@ -0,0 +1,96 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <thread>
+
+#include "fixture_manager_test_harness.hpp"
+
+using namespace lxmax;
+
+namespace
+{
+	const int k_fixture_channel_count = 4;
+}
+
+SCENARIO("Fixtures of a type with a batch writer are written together")
+{
+	GIVEN("Batched fixtures across two universes, two of which overlap, alongside a fixture without a batch writer")
+	{
+		fixture_manager_test_harness harness(2);
+
+		std::vector<std::unique_ptr<test_fixture>> fixtures;
+		for (int i = 0; i < 100; ++i)
+		{
+			auto f = std::make_unique<test_fixture>(true);
+			f->set_manager(harness.manager);
+			f->patch(1 + i % 2, 1 + (i / 2) * k_fixture_channel_count, k_fixture_channel_count);
+			f->set_value(static_cast<dmx_value>(i + 1));
+			fixtures.push_back(std::move(f));
+		}
+
+		// Both share channels 401-404 of universe 1, so are written one at a time with their channel owners resolved
+		test_fixture older_overlapping(true);
+		older_overlapping.set_manager(harness.manager);
+		older_overlapping.patch(1, 401, k_fixture_channel_count);
+		older_overlapping.set_value(200);
+
+		std::this_thread::sleep_for(milliseconds(1));
+
+		test_fixture newer_overlapping(true);
+		newer_overlapping.set_manager(harness.manager);
+		newer_overlapping.patch(1, 403, k_fixture_channel_count);
+		newer_overlapping.set_value(201);
+
+		test_fixture unbatched;
+		unbatched.set_manager(harness.manager);
+		unbatched.patch(2, 401, k_fixture_channel_count);
+		unbatched.set_value(202);
+
+		harness.manager->flush_registrations();
+
+		universe_updated_list updated_universes;
+		harness.manager->write_to_buffer(updated_universes);
+
+		THEN("only the fixtures sharing no channels are written by batch")
+		{
+			for (const auto& f : fixtures)
+				REQUIRE(f->batched_write_count() == 1);
+
+			REQUIRE(older_overlapping.batched_write_count() == 0);
+			REQUIRE(newer_overlapping.batched_write_count() == 0);
+		}
+
+		THEN("every fixture's channels are written")
+		{
+			const auto universe_1 = harness.buffer_manager->get_universe_buffer(1);
+			const auto universe_2 = harness.buffer_manager->get_universe_buffer(2);
+
+			for (int i = 0; i < 100; ++i)
+			{
+				const auto& buffer = i % 2 == 0 ? *universe_1 : *universe_2;
+				const int start = (i / 2) * k_fixture_channel_count;
+
+				REQUIRE(buffer[start] == i + 1);
+				REQUIRE(buffer[start + k_fixture_channel_count - 1] == i + 1);
+			}
+
+			REQUIRE((*universe_1)[400] == 200);
+			REQUIRE((*universe_1)[402] == 201);
+			REQUIRE((*universe_1)[405] == 201);
+			REQUIRE((*universe_2)[400] == 202);
+		}
+
+		THEN("a batched fixture updated on its own only writes its own universe")
+		{
+			fixtures[3]->set_value(50);
+			harness.manager->write_to_buffer(updated_universes);
+
+			REQUIRE((updated_universes == universe_updated_list { 2 }));
+			REQUIRE((*harness.buffer_manager->get_universe_buffer(2))[k_fixture_channel_count] == 50);
+		}
+	}
+}
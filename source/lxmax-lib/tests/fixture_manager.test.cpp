@@ -0,0 +1,233 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <thread>
+
+#include "fixture_manager_test_harness.hpp"
+
+using namespace lxmax;
+
+namespace
+{
+	const int k_fixture_channel_count = 4;
+	const int k_fixtures_per_universe = 100;
+}
+
+SCENARIO("Fixture values are published to the output thread without locking")
+{
+	GIVEN("1000 fixtures updated from another thread while frames are written")
+	{
+		const int fixture_count = 1000;
+		const int universe_count = fixture_count / k_fixtures_per_universe;
+
+		fixture_manager_test_harness harness(universe_count);
+
+		// Leave a gap between fixtures so none of them overlap
+		std::vector<std::unique_ptr<test_fixture>> fixtures;
+		for (int i = 0; i < fixture_count; ++i)
+		{
+			auto f = std::make_unique<test_fixture>();
+			f->set_manager(harness.manager);
+			f->patch(1 + i / k_fixtures_per_universe, 1 + (i % k_fixtures_per_universe) * (k_fixture_channel_count + 1), k_fixture_channel_count);
+			fixtures.push_back(std::move(f));
+		}
+
+		harness.manager->flush_registrations();
+
+		std::atomic<bool> is_running { true };
+		std::atomic<int> last_value { 0 };
+
+		// Stands in for a fast metro driving every fixture from the Max scheduler
+		std::thread metro_thread([&]()
+		{
+			int value = 0;
+
+			while (is_running)
+			{
+				value = (value + 1) % 256;
+
+				for (auto& f : fixtures)
+					f->set_value(static_cast<dmx_value>(value));
+
+				last_value = value;
+				std::this_thread::sleep_for(milliseconds(1));
+			}
+		});
+
+		bool is_every_snapshot_consistent = true;
+
+		const auto check_buffers = [&]()
+		{
+			for (int i = 0; i < fixture_count; ++i)
+			{
+				const auto buffer = harness.buffer_manager->get_universe_buffer(1 + i / k_fixtures_per_universe);
+				const int start = (i % k_fixtures_per_universe) * (k_fixture_channel_count + 1);
+
+				for (int c = 1; c < k_fixture_channel_count; ++c)
+					is_every_snapshot_consistent &= (*buffer)[start + c] == (*buffer)[start];
+			}
+		};
+
+		const auto end = clock::now() + milliseconds(500);
+
+		while (clock::now() < end)
+		{
+			harness.manager->write_to_buffer();
+
+			check_buffers();
+			std::this_thread::sleep_for(milliseconds(1));
+		}
+
+		is_running = false;
+		metro_thread.join();
+
+		harness.manager->write_to_buffer();
+
+		THEN("every fixture's channels come from a single published version")
+		{
+			REQUIRE(is_every_snapshot_consistent);
+		}
+
+		THEN("the last version published is written")
+		{
+			for (int i = 0; i < fixture_count; ++i)
+			{
+				const auto buffer = harness.buffer_manager->get_universe_buffer(1 + i / k_fixtures_per_universe);
+				REQUIRE((*buffer)[(i % k_fixtures_per_universe) * (k_fixture_channel_count + 1)] == last_value);
+			}
+		}
+	}
+}
+
+
+SCENARIO("Fixtures are registered and unregistered while frames are written")
+{
+	GIVEN("A thread writing frames while fixtures are repeatedly created and destroyed")
+	{
+		const int universe_count = 4;
+
+		fixture_manager_test_harness harness(universe_count);
+
+		std::atomic<bool> is_running { true };
+		std::atomic<int> frame_count { 0 };
+
+		// Stands in for the output thread, which only reads the published snapshot of the patch
+		std::thread output_thread([&]()
+		{
+			while (is_running)
+			{
+				harness.manager->write_to_buffer(true);
+				++frame_count;
+			}
+		});
+
+		const auto end = clock::now() + milliseconds(500);
+		int patch_count = 0;
+
+		while (clock::now() < end || frame_count < 10)
+		{
+			std::vector<std::unique_ptr<test_fixture>> fixtures;
+
+			for (int i = 0; i < 100; ++i)
+			{
+				auto f = std::make_unique<test_fixture>();
+				f->set_manager(harness.manager);
+				f->patch(1 + i % universe_count, 1 + (i / universe_count) * (k_fixture_channel_count + 1), k_fixture_channel_count);
+				f->set_value(static_cast<dmx_value>(i));
+				fixtures.push_back(std::move(f));
+			}
+
+			// Publish straight away rather than waiting for the patch to settle, so frames use the fixtures before they're destroyed
+			harness.manager->flush_registrations();
+
+			// Fixtures unregister as they're destroyed, after which frames must no longer touch them
+			fixtures.clear();
+			++patch_count;
+		}
+
+		is_running = false;
+		output_thread.join();
+
+		THEN("frames were written throughout and no fixtures remain patched")
+		{
+			REQUIRE(patch_count > 0);
+			REQUIRE(frame_count >= 10);
+
+			for (int u = 1; u <= universe_count; ++u)
+				REQUIRE(harness.manager->get_patched_channel_count(u) == 0);
+		}
+
+		THEN("a patched fixture's channels are published once registrations are flushed")
+		{
+			test_fixture f;
+			f.set_manager(harness.manager);
+			f.patch(2, 11, k_fixture_channel_count);
+
+			REQUIRE(harness.manager->has_pending_registrations());
+			REQUIRE(harness.manager->get_patched_channel_count(2) == 0);
+
+			harness.manager->flush_registrations();
+
+			REQUIRE(!harness.manager->has_pending_registrations());
+			REQUIRE(harness.manager->get_patched_channel_count(2) == 10 + k_fixture_channel_count);
+			REQUIRE(harness.manager->get_patched_channel_count(1) == 0);
+		}
+	}
+}
+
+
+SCENARIO("Registrations made while a patch loads are published together")
+{
+	GIVEN("Fixtures registered several times each, as attribute setters do when a patch opens")
+	{
+		fixture_manager_test_harness harness(1);
+
+		std::vector<std::unique_ptr<test_fixture>> fixtures;
+		for (int i = 0; i < 20; ++i)
+		{
+			auto f = std::make_unique<test_fixture>();
+			f->set_manager(harness.manager);
+
+			for (int channel = 1; channel <= 1 + i * (k_fixture_channel_count + 1); channel += k_fixture_channel_count + 1)
+				f->patch(1, channel, k_fixture_channel_count);
+
+			f->set_value(static_cast<dmx_value>(i + 1));
+			fixtures.push_back(std::move(f));
+		}
+
+		const int patched_channel_count = 19 * (k_fixture_channel_count + 1) + k_fixture_channel_count;
+
+		THEN("frames written before registrations settle don't publish them")
+		{
+			harness.manager->write_to_buffer();
+
+			REQUIRE(harness.manager->has_pending_registrations());
+			REQUIRE(harness.manager->get_patched_channel_count(1) == 0);
+		}
+
+		THEN("the first frame after the quiet period publishes and writes every fixture")
+		{
+			std::this_thread::sleep_for(k_registration_quiet_period + milliseconds(10));
+			harness.manager->write_to_buffer();
+
+			REQUIRE(!harness.manager->has_pending_registrations());
+			REQUIRE(harness.manager->get_patched_channel_count(1) == patched_channel_count);
+
+			const auto buffer = harness.buffer_manager->get_universe_buffer(1);
+			for (int i = 0; i < 20; ++i)
+				REQUIRE((*buffer)[i * (k_fixture_channel_count + 1)] == i + 1);
+		}
+
+		THEN("destroying fixtures which were never published doesn't need a new snapshot")
+		{
+			fixtures.clear();
+
+			harness.manager->flush_registrations();
+			REQUIRE(harness.manager->get_patched_channel_count(1) == 0);
+		}
+	}
+}
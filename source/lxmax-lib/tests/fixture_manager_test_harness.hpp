@@ -0,0 +1,153 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <vector>
+
+#include <Poco/File.h>
+#include <Poco/Path.h>
+
+#include "channel_image.hpp"
+#include "dmx_buffer_manager.hpp"
+#include "fixture.hpp"
+#include "fixture_manager.hpp"
+#include "preferences_manager.hpp"
+#include "triple_buffer.hpp"
+
+namespace lxmax
+{
+	/// @brief Fixture writing one value to every channel it's patched to, configured for each fixture manager test
+	///
+	/// Values are published through a triple buffer as a four channel snapshot repeated across the patch, so a frame
+	/// written mid-update shows up as channels which differ. The patch may span several universes, or be limited to
+	/// spans as a pixel map's is, and must be set before frames are written. Batched fixtures are written by
+	/// write_universe_fixture_batch, so only to their start universe.
+	class test_fixture : public fixture
+	{
+		static constexpr size_t k_snapshot_length = 4;
+
+		const bool _is_batched;
+		triple_buffer<std::array<dmx_value, k_snapshot_length>> _values;
+		std::vector<dmx_value> _image;
+		size_t _batched_write_count { 0 };
+		std::thread::id _writer_thread;
+
+		/// @brief Fills the image from the latest published snapshot
+		void update_image()
+		{
+			clear_updated();
+			_values.update();
+
+			const auto& values = _values.read_buffer();
+			for (size_t i = 0; i < _image.size(); ++i)
+				_image[i] = values[i % k_snapshot_length];
+
+			_writer_thread = std::this_thread::get_id();
+		}
+
+	public:
+		explicit test_fixture(bool is_batched = false)
+			: _is_batched(is_batched)
+		{
+
+		}
+
+		~test_fixture() override
+		{
+			unregister_from_manager();
+		}
+
+		void patch(universe_address universe, int channel, int channel_count)
+		{
+			patch(fixture_patch_info("Test Fixture", false, dmx_channel_range(universe, channel, channel_count)));
+		}
+
+		void patch(fixture_patch_info patch_info)
+		{
+			_image.resize(patch_info.channel_range.channel_count());
+			set_patch_info(std::move(patch_info));
+		}
+
+		void set_value(dmx_value value)
+		{
+			_values.write_buffer().fill(value);
+			_values.publish();
+			set_updated();
+		}
+
+		bool write_to_buffer(const fixture_patch_info& patch_info, universe_buffer_map& buffer_map, universe_updated_list& updated_universes, bool is_force) override
+		{
+			if (!is_force && !is_updated())
+				return false;
+
+			update_image();
+			write_channel_image(patch_info, _image.data(), _image.size(), buffer_map, updated_universes);
+
+			return true;
+		}
+
+		fixture_batch_writer batch_writer() const override
+		{
+			return _is_batched ? &write_universe_fixture_batch<test_fixture> : nullptr;
+		}
+
+		void write_to_universe(const fixture_patch_info& patch_info, universe_buffer& buffer)
+		{
+			update_image();
+
+			const size_t start = patch_info.channel_range.start_local();
+			std::copy_n(_image.data(), std::min(_image.size(), buffer.size() - start), &buffer[start]);
+
+			++_batched_write_count;
+		}
+
+		/// @brief Number of times the fixture has been written by batch rather than through write_to_buffer
+		size_t batched_write_count() const
+		{
+			return _batched_write_count;
+		}
+
+		/// @brief Gets the thread which last wrote the fixture
+		std::thread::id writer_thread() const
+		{
+			return _writer_thread;
+		}
+	};
+
+	/// @brief Fixture manager writing to a buffer manager with buffers for universes 1 to universe_count
+	///
+	class fixture_manager_test_harness
+	{
+	public:
+		std::shared_ptr<dmx_buffer_manager> buffer_manager;
+		std::shared_ptr<fixture_manager> manager;
+
+		explicit fixture_manager_test_harness(int universe_count, Poco::Logger& log = Poco::Logger::get("Fixture Manager Test"))
+			: buffer_manager(std::make_shared<dmx_buffer_manager>(log)),
+			manager(std::make_shared<fixture_manager>(log, buffer_manager))
+		{
+			const std::string preferences_path = Poco::Path::temp() + "lxmax-fixture-manager-test.json";
+
+			{
+				preferences_manager preferences(log, preferences_path);
+
+				for (int u = 1; u <= universe_count; ++u)
+				{
+					auto universe = std::make_unique<dmx_output_universe_config>();
+					universe->internal_universe = u;
+					preferences.add_universe(u, std::move(universe));
+				}
+
+				buffer_manager->update_universe_configs(&preferences);
+			}
+
+			Poco::File(preferences_path).remove();
+		}
+	};
+}
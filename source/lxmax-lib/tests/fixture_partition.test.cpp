@@ -0,0 +1,108 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <set>
+#include <thread>
+
+#include "fixture_manager_test_harness.hpp"
+
+using namespace lxmax;
+
+SCENARIO("Fixtures are written to separate universes on several threads")
+{
+	GIVEN("2000 fixtures across 40 universes, some of them spanning two universes")
+	{
+		const int universe_count = 40;
+		const int fixtures_per_universe = 50;
+		const int channel_count = 8;
+
+		fixture_manager_test_harness harness(universe_count);
+		harness.manager->set_compose_thread_count(4);
+
+		// The last fixture in every fourth universe runs on into the start of the next one, joining them into one partition
+		std::vector<std::unique_ptr<test_fixture>> fixtures;
+		for (int u = 1; u <= universe_count; ++u)
+		{
+			for (int i = 0; i < fixtures_per_universe; ++i)
+			{
+				const bool is_spanning = u % 4 == 0 && u < universe_count && i == fixtures_per_universe - 1;
+				const int channel = is_spanning ? k_universe_length - channel_count / 2 + 1 : 1 + (i + 1) * channel_count;
+
+				auto f = std::make_unique<test_fixture>();
+				f->set_manager(harness.manager);
+				f->patch(u, channel, channel_count);
+				f->set_value(static_cast<dmx_value>(u + i));
+				fixtures.push_back(std::move(f));
+			}
+		}
+
+		harness.manager->flush_registrations();
+
+		universe_updated_list updated_universes;
+		harness.manager->write_to_buffer(updated_universes);
+
+		THEN("the patch is split into partitions across the compose threads")
+		{
+			REQUIRE(harness.manager->compose_thread_count() == 4);
+			REQUIRE(updated_universes.size() >= static_cast<size_t>(universe_count));
+
+			std::set<std::thread::id> writer_threads;
+			bool is_every_joined_partition_on_one_thread = true;
+
+			// The calling thread can run every partition before the workers wake, so keep writing until one of them has
+			for (int frame = 0; frame < 1000 && writer_threads.size() < 2; ++frame)
+			{
+				harness.manager->write_to_buffer(updated_universes, true);
+
+				for (const auto& f : fixtures)
+					writer_threads.insert(f->writer_thread());
+
+				for (int u = 4; u < universe_count; u += 4)
+				{
+					const std::thread::id writer_thread = fixtures[(u - 1) * fixtures_per_universe]->writer_thread();
+
+					for (int i = (u - 1) * fixtures_per_universe; i < (u + 1) * fixtures_per_universe; ++i)
+						is_every_joined_partition_on_one_thread &= fixtures[i]->writer_thread() == writer_thread;
+				}
+			}
+
+			REQUIRE(writer_threads.size() > 1);
+			REQUIRE(is_every_joined_partition_on_one_thread);
+		}
+
+		THEN("every fixture's channels are written, including those in the next universe")
+		{
+			for (int u = 1; u <= universe_count; ++u)
+			{
+				const auto buffer = harness.buffer_manager->get_universe_buffer(u);
+
+				for (int i = 0; i < fixtures_per_universe - 1; ++i)
+					REQUIRE((*buffer)[(i + 1) * channel_count] == u + i);
+
+				if (u % 4 == 0 && u < universe_count)
+				{
+					const dmx_value value = static_cast<dmx_value>(u + fixtures_per_universe - 1);
+					const auto next_buffer = harness.buffer_manager->get_universe_buffer(u + 1);
+
+					REQUIRE((*buffer)[k_universe_length - 1] == value);
+					REQUIRE((*next_buffer)[channel_count / 2 - 1] == value);
+				}
+			}
+		}
+
+		THEN("the same buffers are written on one thread")
+		{
+			const auto buffer_before = harness.buffer_manager->get_universe_buffer(5);
+
+			harness.manager->set_compose_thread_count(1);
+			harness.manager->write_to_buffer(updated_universes, true);
+
+			REQUIRE(harness.manager->compose_thread_count() == 1);
+			REQUIRE((harness.buffer_manager->get_universe_buffer(5) == buffer_before));
+		}
+	}
+}
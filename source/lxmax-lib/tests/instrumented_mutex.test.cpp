@@ -0,0 +1,90 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <thread>
+
+#include "instrumented_mutex.hpp"
+
+using namespace lxmax;
+
+SCENARIO("Lock stats record acquisitions and times into histograms")
+{
+	GIVEN("A named lock's stats")
+	{
+		lock_stats& stats = get_lock_stats("test lock");
+		stats.reset();
+
+		THEN("the same stats are returned for the same name")
+		{
+			REQUIRE(&get_lock_stats("test lock") == &stats);
+			REQUIRE(&get_lock_stats("other test lock") != &stats);
+		}
+
+		THEN("acquisitions, contention and times are counted")
+		{
+			stats.record_acquire(false, clock::duration::zero());
+			stats.record_release(std::chrono::nanoseconds(100));
+			stats.record_acquire(true, std::chrono::microseconds(10));
+			stats.record_release(std::chrono::milliseconds(100));
+
+			const lock_stats_snapshot snapshot = stats.snapshot();
+
+			REQUIRE(snapshot.name == "test lock");
+			REQUIRE(snapshot.acquisitions == 2);
+			REQUIRE(snapshot.contended_acquisitions == 1);
+			REQUIRE(snapshot.wait_nanoseconds == 10000);
+			REQUIRE(snapshot.hold_nanoseconds == 100000100);
+
+			// 10us falls in the [8192, 16384) bucket, 100ms is beyond the last bucket so is counted in it
+			REQUIRE(snapshot.wait_histogram[0] == 1);
+			REQUIRE(snapshot.wait_histogram[13] == 1);
+			REQUIRE(snapshot.hold_histogram[6] == 1);
+			REQUIRE(snapshot.hold_histogram[k_lock_histogram_bucket_count - 1] == 1);
+		}
+
+		THEN("reset clears the counters")
+		{
+			stats.record_acquire(true, std::chrono::microseconds(1));
+			stats.reset();
+
+			const lock_stats_snapshot snapshot = stats.snapshot();
+
+			REQUIRE(snapshot.acquisitions == 0);
+			REQUIRE(snapshot.contended_acquisitions == 0);
+			REQUIRE(snapshot.wait_histogram[9] == 0);
+		}
+	}
+
+#ifdef LXMAX_ENABLE_LOCK_STATS
+	GIVEN("An instrumented mutex locked from two threads")
+	{
+		instrumented_mutex mutex("test contended lock");
+		get_lock_stats("test contended lock").reset();
+
+		std::unique_lock<instrumented_mutex> lock(mutex);
+
+		std::thread other_thread([&]()
+		{
+			std::lock_guard<instrumented_mutex> other_lock(mutex);
+		});
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		lock.unlock();
+		other_thread.join();
+
+		THEN("the blocked acquisition is counted as contended")
+		{
+			const lock_stats_snapshot snapshot = get_lock_stats("test contended lock").snapshot();
+
+			REQUIRE(snapshot.acquisitions == 2);
+			REQUIRE(snapshot.contended_acquisitions == 1);
+			REQUIRE(snapshot.wait_nanoseconds > 0);
+			REQUIRE(snapshot.hold_nanoseconds >= 20000000);
+		}
+	}
+#endif
+}
@@ -0,0 +1,10 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+// Unit tests for lxmax-lib, which run without Max. Tests are written using the Catch framework
+// bundled with min-api, as described at https://github.com/philsquared/Catch/blob/master/docs/tutorial.md
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
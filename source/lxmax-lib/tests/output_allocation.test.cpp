@@ -0,0 +1,97 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <thread>
+
+#include "allocation_guard.hpp"
+#include "fixture_manager_test_harness.hpp"
+#include "output_test_harness.hpp"
+
+using namespace lxmax;
+
+SCENARIO("Steady state output frames don't allocate")
+{
+	GIVEN("Fixtures patched across several universes")
+	{
+		const int universe_count = 4;
+		const int fixtures_per_universe = 50;
+
+		fixture_manager_test_harness harness(universe_count);
+
+		// Leave a gap between fixtures so none of them overlap
+		std::vector<std::unique_ptr<test_fixture>> fixtures;
+		for (int i = 0; i < universe_count * fixtures_per_universe; ++i)
+		{
+			auto f = std::make_unique<test_fixture>();
+			f->set_manager(harness.manager);
+			f->patch(1 + i / fixtures_per_universe, 1 + (i % fixtures_per_universe) * 2, 1);
+			fixtures.push_back(std::move(f));
+		}
+
+		harness.manager->flush_registrations();
+
+		universe_updated_list updated_universes;
+
+		const auto write_frame = [&](int frame)
+		{
+			for (auto& f : fixtures)
+				f->set_value(static_cast<dmx_value>(frame));
+
+			harness.manager->write_to_buffer(updated_universes, frame % 10 == 0);
+		};
+
+		for (int frame = 0; frame < 10; ++frame)
+			write_frame(frame);
+
+		THEN("writing fixtures to the universe buffers doesn't allocate after warm-up")
+		{
+			allocation_guard guard;
+
+			for (int frame = 10; frame < 100; ++frame)
+				write_frame(frame);
+
+			const uint64_t allocation_count = guard.allocation_count();
+			REQUIRE(allocation_count == 0);
+		}
+	}
+
+	GIVEN("An output service sending to loopback")
+	{
+		output_test_harness harness(global_config { });
+		harness.output.start();
+
+		// Warm up with a full update, which writes and sends the most
+		harness.fixture.set_value(1);
+		REQUIRE(harness.wait_for_value(1));
+		std::this_thread::sleep_for(milliseconds(1100));
+
+		THEN("the output thread doesn't allocate while the fixture changes every frame")
+		{
+			const auto stats_before = harness.output.get_stats();
+
+			uint64_t allocation_count;
+
+			{
+				allocation_guard guard;
+
+				// Spans a full update as well as frames sent for changes
+				for (int i = 0; i < 60; ++i)
+				{
+					harness.fixture.set_value(static_cast<dmx_value>(2 + i));
+					std::this_thread::sleep_for(milliseconds(25));
+				}
+
+				allocation_count = guard.allocation_count();
+			}
+
+			const auto stats_after = harness.output.get_stats();
+
+			REQUIRE(stats_after.packets_sent - stats_before.packets_sent > 30);
+			REQUIRE(allocation_count == 0);
+		}
+	}
+}
@@ -0,0 +1,81 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+#include "output_test_harness.hpp"
+
+using namespace lxmax;
+
+SCENARIO("The output loop sleeps while no fixtures change")
+{
+	GIVEN("A running output service with one patched fixture")
+	{
+		output_test_harness harness(global_config { });
+		harness.output.start();
+
+		REQUIRE(harness.wait_for_value(0));
+
+		WHEN("nothing changes for a second")
+		{
+			const auto stats_before = harness.output.get_stats();
+			std::this_thread::sleep_for(milliseconds(1000));
+			const auto stats_after = harness.output.get_stats();
+
+			THEN("the loop wakes only for keep-alive updates rather than every frame")
+			{
+				REQUIRE(stats_after.wakeups - stats_before.wakeups <= 4);
+				REQUIRE(stats_after.frames_sent - stats_before.frames_sent <= 2);
+			}
+		}
+
+		WHEN("a fixture changes")
+		{
+			harness.fixture.set_value(100);
+
+			THEN("the change is sent straight away")
+			{
+				REQUIRE(harness.wait_for_value(100, milliseconds(100)));
+			}
+		}
+	}
+}
+
+TEST_CASE("Output loop wake-ups and CPU time while idle", "[.][benchmark]")
+{
+	const int seconds = 10;
+
+	const auto measure_idle = [&](const std::string& name, global_config config)
+	{
+		output_test_harness harness(config);
+		harness.output.start();
+
+		REQUIRE(harness.wait_for_value(0));
+
+		const auto stats_before = harness.output.get_stats();
+		const std::clock_t cpu_before = std::clock();
+
+		std::this_thread::sleep_for(std::chrono::seconds(seconds));
+
+		const std::clock_t cpu_after = std::clock();
+		const auto stats_after = harness.output.get_stats();
+
+		std::cout << name << ": " << static_cast<double>(stats_after.wakeups - stats_before.wakeups) / seconds
+			<< " wake-ups/s, " << static_cast<double>(stats_after.frames_sent - stats_before.frames_sent) / seconds
+			<< " frames/s, " << 1000. * (cpu_after - cpu_before) / CLOCKS_PER_SEC / seconds << " ms CPU/s" << std::endl;
+	};
+
+	measure_idle("Idle output loop", global_config { });
+
+	// Forcing output at the frame rate wakes once per frame regardless of activity, as the loop used to
+	global_config fixed_rate_config;
+	fixed_rate_config.is_force_output_at_framerate = true;
+
+	measure_idle("Idle fixed-rate output loop", fixed_rate_config);
+}
@@ -0,0 +1,68 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+#include "output_test_harness.hpp"
+
+using namespace lxmax;
+
+/// @brief Measures the time from a fixture value changing to the packet carrying it arriving on loopback
+///
+std::vector<clock::duration> measure_output_latency(bool is_low_latency, int sample_count)
+{
+	global_config config;
+	config.is_low_latency_output_enabled = is_low_latency;
+
+	output_test_harness harness(config);
+	harness.output.start();
+
+	std::vector<clock::duration> latencies;
+
+	for (int i = 0; i < sample_count; ++i)
+	{
+		// Offset each change so it lands at a different point in the output frame
+		std::this_thread::sleep_for(milliseconds(25 + i % 11));
+
+		const auto value = static_cast<dmx_value>(1 + i % 254);
+
+		const auto start = clock::now();
+		harness.fixture.set_value(value);
+
+		if (harness.wait_for_value(value))
+			latencies.push_back(clock::now() - start);
+	}
+
+	return latencies;
+}
+
+void report_output_latency(const std::string& name, std::vector<clock::duration> latencies)
+{
+	std::sort(std::begin(latencies), std::end(latencies));
+
+	const auto to_ms = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+	std::cout << name << ": median " << to_ms(latencies[latencies.size() / 2])
+		<< " ms, p99 " << to_ms(latencies[latencies.size() * 99 / 100])
+		<< " ms, max " << to_ms(latencies.back()) << " ms" << std::endl;
+}
+
+TEST_CASE("Output latency from fixture change to packet arrival", "[.][benchmark]")
+{
+	const int sample_count = 200;
+
+	const auto periodic = measure_output_latency(false, sample_count);
+	const auto low_latency = measure_output_latency(true, sample_count);
+
+	REQUIRE(periodic.size() == sample_count);
+	REQUIRE(low_latency.size() == sample_count);
+
+	report_output_latency("Periodic output", periodic);
+	report_output_latency("Low latency output", low_latency);
+}
@@ -0,0 +1,81 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <Poco/File.h>
+#include <Poco/Path.h>
+
+#include "dmx_output_service.hpp"
+#include "fixture_manager_test_harness.hpp"
+
+namespace lxmax
+{
+	/// @brief Output service sending a single sACN universe to a receiver socket on loopback
+	///
+	class output_test_harness
+	{
+		const std::string _preferences_path { Poco::Path::temp() + "lxmax-output-test.json" };
+
+		std::shared_ptr<dmx_buffer_manager> _buffer_manager;
+		std::shared_ptr<lxmax::fixture_manager> _fixture_manager;
+		preferences_manager _preferences;
+		Poco::Net::DatagramSocket _receiver { Poco::Net::SocketAddress("127.0.0.1", k_sacn_port), true };
+		std::vector<char> _receive_buffer = std::vector<char>(1024);
+
+	public:
+		dmx_output_service output;
+		test_fixture fixture;
+
+		explicit output_test_harness(global_config config, Poco::Logger& log = Poco::Logger::get("Output Test"))
+			: _buffer_manager(std::make_shared<dmx_buffer_manager>(log)),
+			_fixture_manager(std::make_shared<lxmax::fixture_manager>(log, _buffer_manager)),
+			_preferences(log, _preferences_path),
+			output(log, _fixture_manager, _buffer_manager)
+		{
+			config.is_sacn_global_destination_multicast = false;
+			config.sacn_global_destination_unicast_addresses = { Poco::Net::IPAddress("127.0.0.1") };
+			_preferences.set_global_config(config);
+
+			auto universe = std::make_unique<dmx_output_universe_config>();
+			universe->protocol = dmx_protocol::sacn;
+			_preferences.add_universe(1, std::move(universe));
+
+			_buffer_manager->update_universe_configs(&_preferences);
+			output.update_global_config(&_preferences);
+			output.update_universe_configs(&_preferences);
+
+			fixture.set_manager(_fixture_manager);
+			fixture.patch(1, 1, 1);
+		}
+
+		~output_test_harness()
+		{
+			output.stop();
+			Poco::File(_preferences_path).remove();
+		}
+
+		/// @brief Waits for a packet carrying the value in the fixture's channel
+		/// @returns false if no such packet arrived before the timeout
+		bool wait_for_value(dmx_value value, milliseconds timeout = milliseconds(1000))
+		{
+			const auto end = clock::now() + timeout;
+
+			while (clock::now() < end)
+			{
+				if (!_receiver.poll(Poco::Timespan(0, 1000), Poco::Net::Socket::SELECT_READ))
+					continue;
+
+				const int length = _receiver.receiveBytes(_receive_buffer.data(), static_cast<int>(_receive_buffer.size()));
+
+				if (length > static_cast<int>(k_min_sacn_dmx_packet_length)
+					&& static_cast<dmx_value>(_receive_buffer[k_min_sacn_dmx_packet_length]) == value)
+					return true;
+			}
+
+			return false;
+		}
+	};
+}
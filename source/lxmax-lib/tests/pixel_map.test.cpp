@@ -0,0 +1,309 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <iostream>
+
+#include "fixture_manager_test_harness.hpp"
+#include "pixel_map.hpp"
+
+using namespace lxmax;
+
+namespace
+{
+	pixel_map_config make_config(int width, int height, pixel_map_layout layout)
+	{
+		pixel_map_config config;
+		config.width = width;
+		config.height = height;
+		config.layout = layout;
+		return config;
+	}
+
+	/// @brief Builds a char matrix where each plane of each cell holds a distinct value
+	std::vector<char> make_matrix(int width, int height, int plane_count)
+	{
+		std::vector<char> matrix(width * height * plane_count);
+
+		for (size_t i = 0; i < matrix.size(); ++i)
+			matrix[i] = static_cast<char>(i * 7 + 3);
+
+		return matrix;
+	}
+}
+
+SCENARIO("Pixels are mapped in wiring order")
+{
+	GIVEN("A 4x3 matrix")
+	{
+		THEN("progressive layouts run left to right on every row")
+		{
+			const pixel_map map(make_config(4, 3, pixel_map_layout::progressive));
+
+			REQUIRE(map.get_offset(0, 0) == 0);
+			REQUIRE(map.get_offset(3, 0) == 9);
+			REQUIRE(map.get_offset(0, 1) == 12);
+			REQUIRE(map.channel_range().channel_count() == 36);
+		}
+
+		THEN("snake layouts reverse every other row")
+		{
+			const pixel_map map(make_config(4, 3, pixel_map_layout::snake));
+
+			REQUIRE(map.get_offset(3, 1) == 12);
+			REQUIRE(map.get_offset(0, 1) == 21);
+			REQUIRE(map.get_offset(0, 2) == 24);
+			REQUIRE(map.run_count() == 3);
+		}
+
+		THEN("zigzag layouts reverse every other column")
+		{
+			const pixel_map map(make_config(4, 3, pixel_map_layout::zigzag));
+
+			REQUIRE(map.get_offset(0, 2) == 6);
+			REQUIRE(map.get_offset(1, 2) == 9);
+			REQUIRE(map.get_offset(1, 0) == 15);
+			REQUIRE(map.run_count() == 4);
+		}
+	}
+
+	GIVEN("More pixels than fit in one universe")
+	{
+		auto config = make_config(200, 1, pixel_map_layout::progressive);
+		config.start_universe = 2;
+		config.start_channel = 10;
+		config.pixels_per_universe = 150;
+
+		const pixel_map map(config);
+
+		THEN("pixels carry on from channel 1 of the next universe")
+		{
+			REQUIRE(map.get_offset(149, 0) == 149 * 3);
+			REQUIRE(map.get_offset(150, 0) == k_universe_length - 9);
+			REQUIRE(map.channel_range().start_universe() == 2);
+			REQUIRE(map.channel_range().end_universe() == 3);
+		}
+
+		THEN("each universe's span ends after its last pixel")
+		{
+			REQUIRE(map.universe_spans().size() == 2);
+			REQUIRE((map.universe_spans()[0] == dmx_channel_range(2, 10, 150 * 3)));
+			REQUIRE((map.universe_spans()[1] == dmx_channel_range(3, 1, 50 * 3)));
+		}
+	}
+
+	GIVEN("A map whose config is set again")
+	{
+		pixel_map map(make_config(4, 3, pixel_map_layout::snake));
+
+		THEN("the table is only rebuilt when the layout changes")
+		{
+			REQUIRE_FALSE(map.set_config(make_config(4, 3, pixel_map_layout::snake)));
+			REQUIRE(map.set_config(make_config(4, 3, pixel_map_layout::zigzag)));
+		}
+	}
+}
+
+SCENARIO("Matrices are filled into the channel image")
+{
+	GIVEN("A 3 plane char matrix")
+	{
+		const int width = 9;
+		const int height = 4;
+		const auto matrix = make_matrix(width, height, 3);
+		const pixel_source source { matrix.data(), 3, 3, width * 3 };
+
+		const pixel_map map(make_config(width, height, pixel_map_layout::snake));
+		std::vector<dmx_value> image(map.channel_range().channel_count());
+		map.fill(source, image.data());
+
+		THEN("each pixel's planes are written as RGB")
+		{
+			for (int y = 0; y < height; ++y)
+				for (int x = 0; x < width; ++x)
+					for (int c = 0; c < 3; ++c)
+						REQUIRE(image[map.get_offset(x, y) + c] == static_cast<dmx_value>(matrix[(y * width + x) * 3 + c]));
+		}
+	}
+
+	GIVEN("A 4 plane char matrix mapped to four channel pixels")
+	{
+		const int width = 11;
+		const int height = 3;
+		const auto matrix = make_matrix(width, height, 4);
+		const pixel_source source { matrix.data(), 4, 4, width * 4 };
+
+		auto config = make_config(width, height, pixel_map_layout::snake);
+		config.channels_per_pixel = 4;
+
+		const pixel_map map(config);
+		std::vector<dmx_value> image(map.channel_range().channel_count());
+		map.fill(source, image.data());
+
+		THEN("ARGB planes are written as RGBA in both directions")
+		{
+			for (int y = 0; y < height; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					const char* cell = &matrix[(y * width + x) * 4];
+					const dmx_value* pixel = &image[map.get_offset(x, y)];
+
+					REQUIRE(pixel[0] == static_cast<dmx_value>(cell[1]));
+					REQUIRE(pixel[1] == static_cast<dmx_value>(cell[2]));
+					REQUIRE(pixel[2] == static_cast<dmx_value>(cell[3]));
+					REQUIRE(pixel[3] == static_cast<dmx_value>(cell[0]));
+				}
+			}
+		}
+	}
+
+	GIVEN("A 3 plane float matrix")
+	{
+		const std::vector<float> matrix { 0.f, 0.5f, 1.f, -1.f, 2.f, 0.25f };
+		const pixel_source source { reinterpret_cast<const char*>(matrix.data()), 3, 12, 24 };
+
+		const pixel_map map(make_config(2, 1, pixel_map_layout::progressive));
+		std::vector<dmx_value> image(map.channel_range().channel_count());
+		map.fill_float(source, image.data());
+
+		THEN("values are clamped and scaled to 8-bit")
+		{
+			REQUIRE((image == std::vector<dmx_value> { 0, 128, 255, 0, 255, 64 }));
+		}
+	}
+}
+
+SCENARIO("Channel images are written to each universe they span")
+{
+	GIVEN("An image starting near the end of a universe")
+	{
+		universe_buffer_map buffers;
+		buffers[1].fill(0);
+		buffers[2].fill(0);
+
+		const dmx_channel_range range(1, 511, 4);
+		const std::vector<dmx_value> image { 10, 20, 30, 40 };
+		universe_updated_list updated;
+
+		write_channel_image(range, image.data(), image.size(), false, buffers, updated);
+
+		THEN("the image is split across the universes")
+		{
+			REQUIRE(buffers[1][510] == 10);
+			REQUIRE(buffers[1][511] == 20);
+			REQUIRE(buffers[2][0] == 30);
+			REQUIRE(buffers[2][1] == 40);
+			REQUIRE((updated == universe_updated_list { 1, 2 }));
+		}
+	}
+
+	GIVEN("A patch whose spans leave the end of the first universe unused")
+	{
+		universe_buffer_map buffers;
+		buffers[1].fill(7);
+		buffers[2].fill(7);
+
+		fixture_patch_info patch_info("Pixel Map", false, dmx_channel_range(1, 1, k_universe_length + 6));
+		patch_info.spans = { dmx_channel_range(1, 1, 6), dmx_channel_range(2, 1, 6) };
+
+		const std::vector<dmx_value> image(patch_info.channel_range.channel_count(), 100);
+		universe_updated_list updated;
+
+		write_channel_image(patch_info, image.data(), image.size(), buffers, updated);
+
+		THEN("only the spans are written")
+		{
+			REQUIRE(buffers[1][5] == 100);
+			REQUIRE(buffers[1][6] == 7);
+			REQUIRE(buffers[1][511] == 7);
+			REQUIRE(buffers[2][5] == 100);
+			REQUIRE(buffers[2][6] == 7);
+		}
+	}
+}
+
+TEST_CASE("Pixel map fill throughput", "[.][benchmark]")
+{
+	const int width = 128;
+	const int height = 96;
+	const int frame_count = 1000;
+
+	for (int plane_count : { 3, 4 })
+	{
+		const auto matrix = make_matrix(width, height, plane_count);
+		const pixel_source source { matrix.data(), plane_count, plane_count, width * plane_count };
+
+		auto config = make_config(width, height, pixel_map_layout::snake);
+		config.channels_per_pixel = plane_count;
+
+		const pixel_map map(config);
+		std::vector<dmx_value> image(map.channel_range().channel_count());
+
+		const auto start = clock::now();
+
+		for (int i = 0; i < frame_count; ++i)
+			map.fill(source, image.data());
+
+		const auto elapsed = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+
+		std::cout << plane_count << " plane " << width << "x" << height << " fill: "
+			<< elapsed / frame_count << " us per frame" << std::endl;
+	}
+}
+
+SCENARIO("Fixtures can be patched after the last pixel of a pixel map's universe")
+{
+	GIVEN("A continually updated pixel map of 100 pixels per universe, with a fixture patched after the first universe's pixels")
+	{
+		fixture_manager_test_harness harness(2);
+
+		pixel_map_config config;
+		config.width = 200;
+		config.pixels_per_universe = 100;
+
+		const pixel_map map(config);
+
+		// Patched to the map's universe spans, as lx.pixelmap is
+		fixture_patch_info patch_info("Test Pixel Map", false, map.channel_range());
+		patch_info.spans = map.universe_spans();
+
+		test_fixture pixels;
+		pixels.set_manager(harness.manager);
+		pixels.patch(std::move(patch_info));
+		pixels.set_value(255);
+
+		test_fixture gap_fixture;
+		gap_fixture.set_manager(harness.manager);
+		gap_fixture.patch(1, 401, 4);
+		gap_fixture.set_value(7);
+
+		harness.manager->flush_registrations();
+
+		for (int frame = 0; frame < 3; ++frame)
+		{
+			pixels.set_updated();
+			harness.manager->write_to_buffer();
+		}
+
+		THEN("the fixture in the gap keeps its values")
+		{
+			const auto buffer = harness.buffer_manager->get_universe_buffer(1);
+
+			REQUIRE((*buffer)[299] == 255);
+			REQUIRE((*buffer)[300] == 0);
+			REQUIRE((*buffer)[400] == 7);
+			REQUIRE((*buffer)[403] == 7);
+			REQUIRE((*buffer)[511] == 0);
+		}
+
+		THEN("only patched channels count towards trimming the universe")
+		{
+			REQUIRE(harness.manager->get_patched_channel_count(1) == 404);
+			REQUIRE(harness.manager->get_patched_channel_count(2) == 300);
+		}
+	}
+}
@@ -0,0 +1,67 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include "precision_helpers.hpp"
+
+using namespace lxmax;
+
+SCENARIO("Little endian values are written least significant byte first")
+{
+	dmx_value data[3] { };
+	write_with_precision_ltp(1., 1., data, value_precision::_24bit_le);
+
+	REQUIRE(data[0] == 0xFF);
+	REQUIRE(data[1] == 0xFF);
+	REQUIRE(data[2] == 0xFF);
+
+	write_with_precision_ltp(double(0x010203) / k_dmx_24bit_max, 1., data, value_precision::_24bit_le);
+
+	REQUIRE(data[0] == 0x03);
+	REQUIRE(data[1] == 0x02);
+	REQUIRE(data[2] == 0x01);
+}
+
+SCENARIO("Multi-byte HTP values are compared as whole values")
+{
+	GIVEN("A 16-bit value with a low coarse byte and a high fine byte")
+	{
+		dmx_value data[2] { };
+		write_with_precision_ltp(double(0x01FF) / k_dmx_16bit_max, 1., data, value_precision::_16bit);
+
+		THEN("a larger value with a lower fine byte replaces it entirely")
+		{
+			write_with_precision_htp(double(0x0200) / k_dmx_16bit_max, 1., data, value_precision::_16bit);
+
+			REQUIRE(data[0] == 0x02);
+			REQUIRE(data[1] == 0x00);
+		}
+
+		THEN("a smaller value with a higher coarse byte leaves it unchanged")
+		{
+			write_with_precision_ltp(double(0x0200) / k_dmx_16bit_max, 1., data, value_precision::_16bit);
+			write_with_precision_htp(double(0x01FF) / k_dmx_16bit_max, 1., data, value_precision::_16bit);
+
+			REQUIRE(data[0] == 0x02);
+			REQUIRE(data[1] == 0x00);
+		}
+	}
+
+	GIVEN("A little endian 24-bit value")
+	{
+		dmx_value data[3] { };
+		write_with_precision_ltp(double(0x0100FF) / k_dmx_24bit_max, 1., data, value_precision::_24bit_le);
+
+		THEN("a smaller value with larger low bytes leaves it unchanged")
+		{
+			write_with_precision_htp(double(0x00FFFE) / k_dmx_24bit_max, 1., data, value_precision::_24bit_le);
+
+			REQUIRE(data[0] == 0xFF);
+			REQUIRE(data[1] == 0x00);
+			REQUIRE(data[2] == 0x01);
+		}
+	}
+}
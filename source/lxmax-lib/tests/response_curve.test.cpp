@@ -0,0 +1,69 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include "precision_helpers.hpp"
+
+using namespace lxmax;
+
+SCENARIO("Response curves are shared from the registry")
+{
+	GIVEN("A registry with the built in curves")
+	{
+		response_curve_registry registry;
+
+		THEN("each built in curve maps the ends of the range to themselves")
+		{
+			for (const auto& name : registry.get_names())
+			{
+				const auto curve = registry.get(name);
+				REQUIRE(curve);
+				REQUIRE(curve->apply(0.) == Approx(0.).margin(1e-4));
+				REQUIRE(curve->apply(1.) == Approx(1.).margin(1e-4));
+			}
+		}
+
+		THEN("fixtures asking for the same curve share its table")
+		{
+			REQUIRE(registry.get("led") == registry.get("led"));
+		}
+
+		THEN("unknown curves are not found")
+		{
+			REQUIRE(registry.get("not_a_curve") == nullptr);
+		}
+
+		THEN("values between table entries are interpolated")
+		{
+			const auto curve = registry.get("square");
+			REQUIRE(curve->apply(0.5) == Approx(0.25).margin(1e-6));
+			REQUIRE(curve->apply(0.123456) == Approx(0.123456 * 0.123456).margin(1e-6));
+		}
+	}
+}
+
+SCENARIO("Response curves are applied when values are written")
+{
+	GIVEN("The square law curve")
+	{
+		response_curve_registry registry;
+		const auto curve = registry.get("square");
+
+		THEN("8-bit values are curved before being scaled")
+		{
+			dmx_value data[1] { };
+			write_with_precision_ltp(128., 255., data, value_precision::_8bit, curve.get());
+			REQUIRE(data[0] == 64);
+		}
+
+		THEN("values are unchanged without a curve")
+		{
+			dmx_value data[1] { };
+			write_with_precision_ltp(128., 255., data, value_precision::_8bit);
+			REQUIRE(data[0] == 128);
+		}
+	}
+}
@@ -0,0 +1,154 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <thread>
+
+#include "common.hpp"
+#include "signal_decimator.hpp"
+
+using namespace lxmax;
+
+namespace
+{
+	void process_vector(signal_decimator& decimator, const std::vector<double>& samples)
+	{
+		decimator.begin_vector();
+		decimator.process(0, samples.data(), samples.size());
+		decimator.end_vector();
+	}
+}
+
+SCENARIO("Signal vectors are decimated to one value per frame")
+{
+	GIVEN("Two vectors processed within a frame")
+	{
+		signal_decimator decimator(1);
+
+		REQUIRE_FALSE(decimator.has_samples());
+
+		const auto process_frame = [&](decimation_mode mode)
+		{
+			decimator.set_mode(mode);
+			process_vector(decimator, { 0.2, -0.9, 0.4 });
+			process_vector(decimator, { 0.5, 0.1, 0.3 });
+			REQUIRE(decimator.end_frame());
+		};
+
+		THEN("peak mode gives the largest absolute sample")
+		{
+			process_frame(decimation_mode::peak);
+			REQUIRE(decimator.value(0) == Approx(0.9f));
+		}
+
+		THEN("mean mode gives the mean of every sample")
+		{
+			process_frame(decimation_mode::mean);
+			REQUIRE(decimator.value(0) == Approx(0.1f));
+		}
+
+		THEN("last mode gives the last sample")
+		{
+			process_frame(decimation_mode::last);
+			REQUIRE(decimator.value(0) == Approx(0.3f));
+		}
+	}
+
+	GIVEN("A frame which has been read")
+	{
+		signal_decimator decimator(1);
+
+		process_vector(decimator, { 1.0 });
+		REQUIRE(decimator.has_samples());
+		REQUIRE(decimator.end_frame());
+		REQUIRE(decimator.value(0) == Approx(1.f));
+
+		THEN("the next frame starts from the following vector")
+		{
+			REQUIRE_FALSE(decimator.has_samples());
+			REQUIRE_FALSE(decimator.end_frame());
+			REQUIRE(decimator.value(0) == Approx(1.f));
+
+			process_vector(decimator, { 0.25 });
+
+			REQUIRE(decimator.has_samples());
+			REQUIRE(decimator.end_frame());
+			REQUIRE(decimator.value(0) == Approx(0.25f));
+		}
+	}
+
+	GIVEN("A vector which finishes after its frame has been ended")
+	{
+		signal_decimator decimator(1);
+
+		const std::vector<double> samples { 0.75 };
+
+		decimator.begin_vector();
+		decimator.process(0, samples.data(), samples.size());
+
+		REQUIRE_FALSE(decimator.end_frame());
+
+		decimator.end_vector();
+
+		THEN("the vector is read with the next frame")
+		{
+			REQUIRE(decimator.end_frame());
+			REQUIRE(decimator.value(0) == Approx(0.75f));
+		}
+	}
+}
+
+TEST_CASE("Signal decimator values are read while the audio thread is processing")
+{
+	const size_t channel_count = 8;
+	signal_decimator decimator(channel_count);
+
+	std::atomic<bool> is_running { true };
+	std::atomic<bool> is_started { false };
+
+	std::thread audio_thread([&]()
+	{
+		const std::vector<double> samples(64, 0.5);
+
+		while (is_running)
+		{
+			decimator.begin_vector();
+			for (size_t c = 0; c < channel_count; ++c)
+				decimator.process(c, samples.data(), samples.size());
+			decimator.end_vector();
+
+			is_started = true;
+		}
+	});
+
+	while (!is_started)
+		std::this_thread::yield();
+
+	bool is_every_value_valid = true;
+	int frame_count = 0;
+
+	const auto end = clock::now() + milliseconds(500);
+
+	while (clock::now() < end && frame_count < 1000)
+	{
+		if (!decimator.end_frame())
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		for (size_t c = 0; c < channel_count; ++c)
+			is_every_value_valid &= decimator.value(c) == 0.5f;
+
+		++frame_count;
+	}
+
+	is_running = false;
+	audio_thread.join();
+
+	REQUIRE(frame_count > 0);
+	REQUIRE(is_every_value_valid);
+}
@@ -0,0 +1,81 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <sstream>
+#include <thread>
+
+#include "trace.hpp"
+
+using namespace lxmax;
+
+SCENARIO("Trace events are dumped as Chrome trace JSON")
+{
+	GIVEN("Events recorded on two threads")
+	{
+		trace_clear();
+
+		{
+			const trace_scope scope("test", "outer", "universe", 7);
+			trace_write(trace_phase::instant, "test", "instant \"quoted\"");
+		}
+
+		std::thread other_thread([]()
+		{
+			trace_set_thread_name("Trace Test");
+			trace_write(trace_phase::instant, "test", "other thread");
+		});
+		other_thread.join();
+
+		std::stringstream stream;
+		const size_t event_count = trace_dump(stream);
+		const std::string json = stream.str();
+
+		THEN("every event is written")
+		{
+			REQUIRE(event_count == 4);
+			REQUIRE(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+			REQUIRE(json.find("\"name\":\"outer\",\"cat\":\"test\",\"ph\":\"B\"") != std::string::npos);
+			REQUIRE(json.find("\"name\":\"outer\",\"cat\":\"test\",\"ph\":\"E\"") != std::string::npos);
+			REQUIRE(json.find("\"args\":{\"universe\":7}") != std::string::npos);
+		}
+
+		THEN("names are escaped and threads are named")
+		{
+			REQUIRE(json.find("\"name\":\"instant \\\"quoted\\\"\"") != std::string::npos);
+			REQUIRE(json.find("\"ph\":\"M\"") != std::string::npos);
+			REQUIRE(json.find("\"args\":{\"name\":\"Trace Test\"}") != std::string::npos);
+		}
+
+		THEN("cleared events aren't dumped again")
+		{
+			trace_clear();
+
+			std::stringstream cleared_stream;
+			REQUIRE(trace_dump(cleared_stream) == 0);
+		}
+	}
+
+	GIVEN("More events than a thread's ring holds")
+	{
+		trace_clear();
+
+		for (size_t i = 0; i < k_trace_ring_capacity + 100; ++i)
+			trace_write(trace_phase::instant, "test", "overflow", "index", static_cast<int64_t>(i));
+
+		std::stringstream stream;
+		const size_t event_count = trace_dump(stream);
+		const std::string json = stream.str();
+
+		THEN("only the most recent events are kept, less the oldest whose slot the thread writes next")
+		{
+			REQUIRE(event_count == k_trace_ring_capacity - 1);
+			REQUIRE(json.find("\"args\":{\"index\":100}") == std::string::npos);
+			REQUIRE(json.find("\"args\":{\"index\":101}") != std::string::npos);
+			REQUIRE(json.find("\"args\":{\"index\":" + std::to_string(k_trace_ring_capacity + 99) + "}") != std::string::npos);
+		}
+	}
+}
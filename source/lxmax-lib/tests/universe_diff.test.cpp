@@ -0,0 +1,86 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include "universe_diff.hpp"
+#include "universe_monitor.hpp"
+
+using namespace lxmax;
+
+SCENARIO("Changed channels are found by comparing frames")
+{
+	GIVEN("Two copies of a universe")
+	{
+		universe_buffer previous { };
+		for (int i = 0; i < k_universe_length; ++i)
+			previous[i] = static_cast<dmx_value>(i * 7);
+
+		universe_buffer current = previous;
+		std::vector<int> changed;
+
+		THEN("identical frames have no changes")
+		{
+			REQUIRE(find_changed_channels(previous.data(), current.data(), current.size(), changed) == 0);
+			REQUIRE(changed.empty());
+		}
+
+		THEN("changes within a block, across blocks and in the final channels are found in order")
+		{
+			for (int i : { 0, 3, 15, 16, 200, 510, 511 })
+				current[i] ^= 0xFF;
+
+			REQUIRE(find_changed_channels(previous.data(), current.data(), current.size(), changed) == 7);
+			REQUIRE((changed == std::vector<int> { 0, 3, 15, 16, 200, 510, 511 }));
+		}
+
+		THEN("ranges which aren't a multiple of the block size are compared up to their end")
+		{
+			current[20] = 1;
+			current[21] = 2;
+			current[30] = 3;
+
+			REQUIRE(find_changed_channels(&previous[5], &current[5], 17, changed) == 2);
+			REQUIRE((changed == std::vector<int> { 15, 16 }));
+		}
+
+		THEN("every channel is found when the whole universe changes")
+		{
+			for (auto& v : current)
+				v = static_cast<dmx_value>(v + 1);
+
+			REQUIRE(find_changed_channels(previous.data(), current.data(), current.size(), changed) == k_universe_length);
+			REQUIRE(changed.back() == k_universe_length - 1);
+		}
+	}
+}
+
+SCENARIO("Universe monitors coalesce frames written before they are read")
+{
+	GIVEN("A monitor which has been written to several times")
+	{
+		int notification_count = 0;
+		universe_monitor monitor(1, [&]() { ++notification_count; });
+
+		universe_buffer frame { };
+
+		for (int i = 1; i <= 3; ++i)
+		{
+			frame[0] = static_cast<dmx_value>(i);
+			monitor.write_frame(frame);
+		}
+
+		THEN("the reader sees only the latest frame, then nothing until the next write")
+		{
+			REQUIRE(notification_count == 3);
+
+			REQUIRE(monitor.update());
+			REQUIRE(monitor.frame()[0] == 3);
+
+			REQUIRE_FALSE(monitor.update());
+			REQUIRE(monitor.frame()[0] == 3);
+		}
+	}
+}
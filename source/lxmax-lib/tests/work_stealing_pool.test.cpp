@@ -0,0 +1,92 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "work_stealing_pool.hpp"
+
+using namespace lxmax;
+
+SCENARIO("Work stealing pools run every task of a batch once")
+{
+	GIVEN("A pool with three workers")
+	{
+		work_stealing_pool pool(3);
+
+		THEN("every task runs exactly once, however many there are")
+		{
+			for (size_t task_count : { 1, 2, 4, 5, 100, 1000 })
+			{
+				std::vector<std::atomic<int>> run_counts(task_count);
+
+				auto task = [&](size_t index) { ++run_counts[index]; };
+				pool.run(task_count, task);
+
+				for (const auto& count : run_counts)
+					REQUIRE(count == 1);
+			}
+		}
+
+		THEN("a slow task's range is stolen by the other threads")
+		{
+			std::mutex mutex;
+			std::set<std::thread::id> thread_ids;
+			std::atomic<int> run_count { 0 };
+
+			// The first quarter of the tasks belongs to the first worker, which is held up by task 0
+			auto task = [&](size_t index)
+			{
+				if (index == 0)
+					std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					thread_ids.insert(std::this_thread::get_id());
+				}
+
+				++run_count;
+			};
+
+			pool.run(400, task);
+
+			REQUIRE(run_count == 400);
+			REQUIRE(thread_ids.size() > 1);
+		}
+
+		THEN("batches can be run repeatedly")
+		{
+			std::atomic<int> total { 0 };
+			auto task = [&](size_t index) { total += static_cast<int>(index); };
+
+			for (int i = 0; i < 1000; ++i)
+				pool.run(10, task);
+
+			REQUIRE(total == 45 * 1000);
+		}
+	}
+
+	GIVEN("A pool with no workers")
+	{
+		work_stealing_pool pool(0);
+
+		THEN("tasks run on the calling thread")
+		{
+			const auto caller_id = std::this_thread::get_id();
+			bool is_every_task_on_caller = true;
+
+			auto task = [&](size_t) { is_every_task_on_caller &= std::this_thread::get_id() == caller_id; };
+			pool.run(10, task);
+
+			REQUIRE(pool.worker_count() == 0);
+			REQUIRE(is_every_task_on_caller);
+		}
+	}
+}
@@ -0,0 +1,77 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <algorithm>
+#include "common.hpp"
+
+namespace lxmax
+{
+	/// @brief Limits the rate of an event to a number per second, allowing short bursts up to a set capacity
+	/// 
+	class token_bucket
+	{
+		double _rate { 0 };
+		double _capacity { 0 };
+		double _tokens { 0 };
+		timestamp _last_refill { timestamp::min() };
+
+		void refill(timestamp now)
+		{
+			if (_last_refill == timestamp::min())
+			{
+				_tokens = _capacity;
+			}
+			else if (now > _last_refill)
+			{
+				const double elapsed = std::chrono::duration<double>(now - _last_refill).count();
+				_tokens = std::min(_capacity, _tokens + elapsed * _rate);
+			}
+
+			_last_refill = now;
+		}
+
+	public:
+		token_bucket() = default;
+
+		token_bucket(double rate, double capacity)
+			: _rate(rate),
+			_capacity(std::max(1., capacity))
+		{
+			
+		}
+
+		/// @brief Consumes a token if one is available
+		/// @returns true if a token was consumed
+		bool try_consume(timestamp now)
+		{
+			if (_rate <= 0)
+				return true;
+
+			refill(now);
+
+			if (_tokens < 1.)
+				return false;
+
+			_tokens -= 1.;
+			return true;
+		}
+
+		/// @brief Gets the time at which the next token will be available
+		timestamp next_available(timestamp now)
+		{
+			if (_rate <= 0)
+				return now;
+
+			refill(now);
+
+			if (_tokens >= 1.)
+				return now;
+
+			return now + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>((1. - _tokens) / _rate));
+		}
+	};
+}
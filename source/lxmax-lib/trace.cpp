@@ -0,0 +1,214 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common.hpp"
+
+namespace lxmax
+{
+	namespace
+	{
+		/// @brief Events recorded by a single thread, only that thread writes to it
+		struct trace_ring
+		{
+			std::array<trace_event, k_trace_ring_capacity> events;
+			std::atomic<uint64_t> write_count { 0 };
+			std::atomic<uint64_t> cleared_count { 0 };
+			std::atomic<const char*> thread_name { nullptr };
+			int thread_id { 0 };
+		};
+
+		struct trace_registry
+		{
+			const timestamp epoch { clock::now() };
+
+			// Rings outlive their threads so events from threads which have since stopped can still be dumped
+			std::mutex mutex;
+			std::vector<std::shared_ptr<trace_ring>> rings;
+		};
+
+		trace_registry& get_registry()
+		{
+			static trace_registry registry;
+			return registry;
+		}
+
+		trace_ring& get_thread_ring()
+		{
+			thread_local trace_ring* ring = nullptr;
+
+			if (!ring)
+			{
+				trace_registry& registry = get_registry();
+				std::lock_guard<std::mutex> lock(registry.mutex);
+
+				auto new_ring = std::make_shared<trace_ring>();
+				new_ring->thread_id = static_cast<int>(registry.rings.size()) + 1;
+				registry.rings.push_back(new_ring);
+
+				ring = new_ring.get();
+			}
+
+			return *ring;
+		}
+
+		void write_json_string(std::ostream& stream, const char* s)
+		{
+			stream << '"';
+
+			for (; *s != '\0'; ++s)
+			{
+				switch (*s)
+				{
+					case '"':
+						stream << "\\\"";
+						break;
+					case '\\':
+						stream << "\\\\";
+						break;
+					default:
+						if (static_cast<unsigned char>(*s) < 0x20)
+							stream << ' ';
+						else
+							stream << *s;
+						break;
+				}
+			}
+
+			stream << '"';
+		}
+
+		void write_json_event(std::ostream& stream, const trace_event& event, int thread_id)
+		{
+			stream << "{\"name\":";
+			write_json_string(stream, event.name);
+			stream << ",\"cat\":";
+			write_json_string(stream, event.category);
+			stream << ",\"ph\":\"" << static_cast<char>(event.phase) << '"';
+
+			// Timestamps are in microseconds, written without going through floating point
+			const int64_t fraction = event.time_ns % 1000;
+			stream << ",\"ts\":" << event.time_ns / 1000 << '.'
+				<< static_cast<char>('0' + fraction / 100)
+				<< static_cast<char>('0' + fraction / 10 % 10)
+				<< static_cast<char>('0' + fraction % 10);
+
+			stream << ",\"pid\":1,\"tid\":" << thread_id;
+
+			if (event.phase == trace_phase::instant)
+				stream << ",\"s\":\"t\"";
+
+			if (event.arg_name)
+			{
+				stream << ",\"args\":{";
+				write_json_string(stream, event.arg_name);
+				stream << ':' << event.arg_value << '}';
+			}
+
+			stream << '}';
+		}
+	}
+
+	void trace_write(trace_phase phase, const char* category, const char* name,
+	                 const char* arg_name, int64_t arg_value) noexcept
+	{
+		trace_ring& ring = get_thread_ring();
+
+		const int64_t time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			clock::now() - get_registry().epoch).count();
+
+		const uint64_t index = ring.write_count.load(std::memory_order_relaxed);
+		ring.events[index % k_trace_ring_capacity] = { category, name, arg_name, arg_value, std::max<int64_t>(0, time_ns), phase };
+		ring.write_count.store(index + 1, std::memory_order_release);
+	}
+
+	void trace_set_thread_name(const char* name) noexcept
+	{
+		get_thread_ring().thread_name = name;
+	}
+
+	size_t trace_dump(std::ostream& stream)
+	{
+		std::vector<std::shared_ptr<trace_ring>> rings;
+
+		{
+			trace_registry& registry = get_registry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			rings = registry.rings;
+		}
+
+		std::vector<trace_event> events;
+		size_t event_count = 0;
+		bool is_first = true;
+
+		const auto write_separator = [&]()
+		{
+			if (!is_first)
+				stream << ",\n";
+
+			is_first = false;
+		};
+
+		stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+		for (const auto& ring : rings)
+		{
+			const uint64_t end = ring->write_count.load(std::memory_order_acquire);
+			const uint64_t start = std::max(ring->cleared_count.load(),
+			                                end > k_trace_ring_capacity ? end - k_trace_ring_capacity : 0);
+
+			events.clear();
+			for (uint64_t i = start; i < end; ++i)
+				events.push_back(ring->events[i % k_trace_ring_capacity]);
+
+			// The thread keeps writing while we copy, so drop any events which may have been overwritten meanwhile. The
+			// slot after its last complete event may be part way through being written, so that event is dropped too.
+			//
+			// The copy reads events without synchronising with the thread writing them, a race thread sanitizer reports.
+			// Any event it tears is one dropped here, so the race is accepted rather than slowing every trace_write.
+			const uint64_t end_after_copy = ring->write_count.load(std::memory_order_acquire);
+			const uint64_t first_intact = end_after_copy + 1 > k_trace_ring_capacity ? end_after_copy + 1 - k_trace_ring_capacity : 0;
+			const size_t overwritten_count = first_intact > start
+				                                 ? static_cast<size_t>(std::min<uint64_t>(first_intact - start, events.size()))
+				                                 : 0;
+
+			if (const char* thread_name = ring->thread_name.load())
+			{
+				write_separator();
+				stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->thread_id << ",\"args\":{\"name\":";
+				write_json_string(stream, thread_name);
+				stream << "}}";
+			}
+
+			for (size_t i = overwritten_count; i < events.size(); ++i)
+			{
+				write_separator();
+				write_json_event(stream, events[i], ring->thread_id);
+				++event_count;
+			}
+		}
+
+		stream << "\n]}\n";
+
+		return event_count;
+	}
+
+	void trace_clear()
+	{
+		trace_registry& registry = get_registry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		for (const auto& ring : registry.rings)
+			ring->cleared_count = ring->write_count.load();
+	}
+}
@@ -0,0 +1,98 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace lxmax
+{
+	/// @brief Number of events each thread keeps, older events are overwritten
+	const size_t k_trace_ring_capacity = 1 << 16;
+
+	enum class trace_phase : char
+	{
+		begin = 'B',
+		end = 'E',
+		instant = 'i'
+	};
+
+	/// @brief A single timeline event, names must be string literals as only the pointer is kept
+	struct trace_event
+	{
+		const char* category;
+		const char* name;
+		const char* arg_name;
+		int64_t arg_value;
+		int64_t time_ns;
+		trace_phase phase;
+	};
+
+	/// @brief Records an event in the calling thread's ring buffer
+	///
+	/// Only takes a lock the first time a thread records an event, after that the thread writes to its own ring.
+	void trace_write(trace_phase phase, const char* category, const char* name,
+	                 const char* arg_name = nullptr, int64_t arg_value = 0) noexcept;
+
+	/// @brief Names the calling thread in dumped traces
+	void trace_set_thread_name(const char* name) noexcept;
+
+	/// @brief Writes the events recorded by every thread as Chrome trace JSON, readable by chrome://tracing and Perfetto
+	///
+	/// Threads may keep tracing during the dump. Events they overwrite while it copies their ring are left out.
+	/// @returns The number of events written
+	size_t trace_dump(std::ostream& stream);
+
+	/// @brief Discards all recorded events
+	void trace_clear();
+
+	/// @brief Records begin and end events around its lifetime
+	class trace_scope
+	{
+		const char* _category;
+		const char* _name;
+
+	public:
+		trace_scope(const char* category, const char* name, const char* arg_name = nullptr, int64_t arg_value = 0) noexcept
+			: _category(category),
+			_name(name)
+		{
+			trace_write(trace_phase::begin, category, name, arg_name, arg_value);
+		}
+
+		~trace_scope()
+		{
+			trace_write(trace_phase::end, _category, _name);
+		}
+
+		trace_scope(const trace_scope&) = delete;
+		trace_scope& operator=(const trace_scope&) = delete;
+	};
+}
+
+#define LXMAX_TRACE_CONCAT_INNER(a, b) a##b
+#define LXMAX_TRACE_CONCAT(a, b) LXMAX_TRACE_CONCAT_INNER(a, b)
+
+// Tracing is compiled out unless the LXMAX_ENABLE_TRACING CMake option is on
+#ifdef LXMAX_ENABLE_TRACING
+#define LXMAX_TRACE_SCOPE(category, name) \
+	const ::lxmax::trace_scope LXMAX_TRACE_CONCAT(lxmax_trace_scope_, __LINE__) { category, name }
+#define LXMAX_TRACE_SCOPE_ARG(category, name, arg_name, arg_value) \
+	const ::lxmax::trace_scope LXMAX_TRACE_CONCAT(lxmax_trace_scope_, __LINE__) { category, name, arg_name, static_cast<int64_t>(arg_value) }
+#define LXMAX_TRACE_INSTANT(category, name) \
+	::lxmax::trace_write(::lxmax::trace_phase::instant, category, name)
+#define LXMAX_TRACE_INSTANT_ARG(category, name, arg_name, arg_value) \
+	::lxmax::trace_write(::lxmax::trace_phase::instant, category, name, arg_name, static_cast<int64_t>(arg_value))
+#define LXMAX_TRACE_THREAD_NAME(name) \
+	::lxmax::trace_set_thread_name(name)
+#else
+#define LXMAX_TRACE_SCOPE(category, name) do { } while (false)
+#define LXMAX_TRACE_SCOPE_ARG(category, name, arg_name, arg_value) do { } while (false)
+#define LXMAX_TRACE_INSTANT(category, name) do { } while (false)
+#define LXMAX_TRACE_INSTANT_ARG(category, name, arg_name, arg_value) do { } while (false)
+#define LXMAX_TRACE_THREAD_NAME(name) do { } while (false)
+#endif
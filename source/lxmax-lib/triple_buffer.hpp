@@ -0,0 +1,74 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace lxmax
+{
+	/// @brief Passes the latest version of a value from one writer thread to one reader thread without locking
+	///
+	/// The writer fills write_buffer() and publishes it, the reader calls update() and reads read_buffer(). Neither side
+	/// ever waits for the other; if the writer publishes several versions between reads the reader only sees the last.
+	/// Several writer threads must serialize their access to the write side between themselves.
+	template <typename T>
+	class triple_buffer
+	{
+		static const uint8_t k_index_mask = 0x03;
+		static const uint8_t k_unread_flag = 0x04;
+
+		std::array<T, 3> _buffers;
+
+		std::atomic<uint8_t> _middle { 1 };
+		uint8_t _write_index { 0 };
+		uint8_t _read_index { 2 };
+
+	public:
+		triple_buffer() = default;
+
+		explicit triple_buffer(const T& initial_value)
+			: _buffers { initial_value, initial_value, initial_value }
+		{
+		}
+
+		/// @brief Gets the buffer to fill with the next version, it holds the version from two publishes ago
+		T& write_buffer()
+		{
+			return _buffers[_write_index];
+		}
+
+		/// @brief Makes the write buffer the latest version
+		void publish()
+		{
+			_write_index = _middle.exchange(_write_index | k_unread_flag, std::memory_order_seq_cst) & k_index_mask;
+		}
+
+		/// @brief Moves the read buffer to the latest published version
+		/// @returns true if a version has been published since the last update
+		bool update()
+		{
+			// Sequentially consistent so a reader clearing its own updated flag first can't miss a publish
+			if ((_middle.load(std::memory_order_seq_cst) & k_unread_flag) == 0)
+				return false;
+
+			_read_index = _middle.exchange(_read_index, std::memory_order_acq_rel) & k_index_mask;
+			return true;
+		}
+
+		/// @brief Gets the latest version read by update, which belongs to the reader until its next update
+		T& read_buffer()
+		{
+			return _buffers[_read_index];
+		}
+
+		const T& read_buffer() const
+		{
+			return _buffers[_read_index];
+		}
+	};
+}
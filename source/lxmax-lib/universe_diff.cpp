@@ -0,0 +1,63 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "universe_diff.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LXMAX_UNIVERSE_DIFF_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace lxmax
+{
+	namespace
+	{
+		int lowest_set_bit(unsigned int mask)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return static_cast<int>(index);
+#else
+			return __builtin_ctz(mask);
+#endif
+		}
+	}
+
+	size_t find_changed_channels(const dmx_value* previous, const dmx_value* current, size_t count,
+	                             std::vector<int>& changed)
+	{
+		const size_t initial_size = changed.size();
+		size_t i = 0;
+
+#ifdef LXMAX_UNIVERSE_DIFF_SSE2
+		for (; i + 16 <= count; i += 16)
+		{
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + i));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + i));
+
+			unsigned int mask = ~static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) & 0xFFFF;
+
+			while (mask != 0)
+			{
+				changed.push_back(static_cast<int>(i) + lowest_set_bit(mask));
+				mask &= mask - 1;
+			}
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			if (previous[i] != current[i])
+				changed.push_back(static_cast<int>(i));
+		}
+
+		return changed.size() - initial_size;
+	}
+}
@@ -0,0 +1,22 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "common.hpp"
+
+namespace lxmax
+{
+	/// @brief Appends the index of every channel which differs between two frames, in ascending order
+	///
+	/// Frames are compared 16 channels at a time where SSE2 is available, so unchanged universes cost a few
+	/// instructions per block.
+	/// @returns the number of changed channels found
+	size_t find_changed_channels(const dmx_value* previous, const dmx_value* current, size_t count,
+	                             std::vector<int>& changed);
+}
@@ -0,0 +1,68 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <functional>
+#include <utility>
+
+#include "common.hpp"
+#include "triple_buffer.hpp"
+
+namespace lxmax
+{
+	/// @brief Receives copies of a universe's buffer each frame it changes
+	///
+	/// Frames are written by the output thread while the monitor is registered with the dmx_buffer_manager. The
+	/// callback is run after each write and should only schedule the read, e.g. by setting a qelem, so however many
+	/// frames arrive before the reader gets to them it only sees the latest.
+	class universe_monitor
+	{
+		universe_address _universe;
+		triple_buffer<universe_buffer> _frames;
+		std::function<void()> _on_frame;
+
+	public:
+		universe_monitor(universe_address universe, std::function<void()> on_frame)
+			: _universe(universe),
+			_frames(universe_buffer { }),
+			_on_frame(std::move(on_frame))
+		{
+		}
+
+		universe_address universe() const
+		{
+			return _universe;
+		}
+
+		/// @brief Changes the monitored universe, only call this while the monitor isn't registered
+		void set_universe(universe_address universe)
+		{
+			_universe = universe;
+		}
+
+		/// @brief Publishes a frame to the reader, only called by the dmx_buffer_manager
+		void write_frame(const universe_buffer& buffer)
+		{
+			_frames.write_buffer() = buffer;
+			_frames.publish();
+
+			if (_on_frame)
+				_on_frame();
+		}
+
+		/// @brief Moves to the latest frame written
+		/// @returns true if a frame has been written since the last update
+		bool update()
+		{
+			return _frames.update();
+		}
+
+		const universe_buffer& frame() const
+		{
+			return _frames.read_buffer();
+		}
+	};
+}
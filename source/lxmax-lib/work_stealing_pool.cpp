@@ -0,0 +1,130 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+
+#include "trace.hpp"
+
+namespace lxmax
+{
+	work_stealing_pool::work_stealing_pool(int worker_count)
+		: _ranges(static_cast<size_t>(std::max(0, worker_count)) + 1)
+	{
+		for (int i = 0; i < worker_count; ++i)
+			_workers.emplace_back(&work_stealing_pool::run_worker, this, static_cast<size_t>(i));
+	}
+
+	work_stealing_pool::~work_stealing_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_is_stopping = true;
+		}
+
+		_batch_started.notify_all();
+
+		for (auto& w : _workers)
+			w.join();
+	}
+
+	void work_stealing_pool::run_batch(size_t task_count, void* context, void (*invoke)(void*, size_t))
+	{
+		if (task_count == 0)
+			return;
+
+		_task_context = context;
+		_invoke_task = invoke;
+		_remaining_task_count = task_count;
+
+		for (size_t i = 0; i < _ranges.size(); ++i)
+		{
+			std::lock_guard<std::mutex> lock(_ranges[i].mutex);
+			_ranges[i].begin = task_count * i / _ranges.size();
+			_ranges[i].end = task_count * (i + 1) / _ranges.size();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			++_batch_generation;
+		}
+
+		_batch_started.notify_all();
+
+		run_tasks(_ranges.size() - 1);
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_batch_finished.wait(lock, [this]() { return _remaining_task_count == 0; });
+	}
+
+	void work_stealing_pool::run_worker(size_t index)
+	{
+		LXMAX_TRACE_THREAD_NAME("Compose Worker");
+
+		uint64_t generation = 0;
+
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_batch_started.wait(lock, [&]() { return _is_stopping || _batch_generation != generation; });
+
+				if (_is_stopping)
+					return;
+
+				generation = _batch_generation;
+			}
+
+			run_tasks(index);
+		}
+	}
+
+	void work_stealing_pool::run_tasks(size_t index)
+	{
+		size_t task;
+
+		while (take_task(index, task) || steal_task(index, task))
+		{
+			_invoke_task(_task_context, task);
+
+			if (_remaining_task_count.fetch_sub(1) == 1)
+			{
+				// Taking the lock stops the notification being missed between the batch thread's check and its wait
+				std::lock_guard<std::mutex> lock(_mutex);
+				_batch_finished.notify_one();
+			}
+		}
+	}
+
+	bool work_stealing_pool::take_task(size_t index, size_t& task)
+	{
+		task_range& range = _ranges[index];
+		std::lock_guard<std::mutex> lock(range.mutex);
+
+		if (range.begin == range.end)
+			return false;
+
+		task = range.begin++;
+		return true;
+	}
+
+	bool work_stealing_pool::steal_task(size_t index, size_t& task)
+	{
+		for (size_t i = 1; i < _ranges.size(); ++i)
+		{
+			task_range& range = _ranges[(index + i) % _ranges.size()];
+			std::lock_guard<std::mutex> lock(range.mutex);
+
+			if (range.begin == range.end)
+				continue;
+
+			task = --range.end;
+			return true;
+		}
+
+		return false;
+	}
+}
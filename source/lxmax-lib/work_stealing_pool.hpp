@@ -0,0 +1,83 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lxmax
+{
+	/// @brief Fixed set of worker threads which run a batch of indexed tasks alongside the calling thread
+	///
+	/// Each batch is split into a contiguous range of task indices per thread. Threads take tasks from the front of their
+	/// own range, and once it's empty steal from the back of the others, so uneven tasks still finish together. Running
+	/// a batch doesn't allocate.
+	class work_stealing_pool
+	{
+		struct alignas(64) task_range
+		{
+			std::mutex mutex;
+			size_t begin { 0 };
+			size_t end { 0 };
+		};
+
+		std::vector<std::thread> _workers;
+
+		// One per worker followed by one for the calling thread
+		std::vector<task_range> _ranges;
+
+		// Task of the current batch, set before its ranges so any thread taking one of its tasks sees it
+		void* _task_context { nullptr };
+		void (*_invoke_task)(void*, size_t) { nullptr };
+
+		std::atomic<size_t> _remaining_task_count { 0 };
+
+		std::mutex _mutex;
+		std::condition_variable _batch_started;
+		std::condition_variable _batch_finished;
+		uint64_t _batch_generation { 0 };
+		bool _is_stopping { false };
+
+		void run_worker(size_t index);
+
+		/// @brief Runs tasks from a thread's own range, then from the others, until none are left
+		void run_tasks(size_t index);
+
+		bool take_task(size_t index, size_t& task);
+
+		bool steal_task(size_t index, size_t& task);
+
+		void run_batch(size_t task_count, void* context, void (*invoke)(void*, size_t));
+
+	public:
+		/// @param worker_count Number of threads to start, in addition to the thread which runs batches
+		explicit work_stealing_pool(int worker_count);
+
+		~work_stealing_pool();
+
+		work_stealing_pool(const work_stealing_pool&) = delete;
+		work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+		int worker_count() const
+		{
+			return static_cast<int>(_workers.size());
+		}
+
+		/// @brief Calls task(index) for every index below task_count, returning once all have finished
+		///
+		/// Only one thread may run a batch at a time.
+		template <typename F>
+		void run(size_t task_count, F& task)
+		{
+			run_batch(task_count, &task, [](void* context, size_t index) { (*static_cast<F*>(context))(index); });
+		}
+	};
+}
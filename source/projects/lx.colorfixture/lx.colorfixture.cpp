@@ -7,8 +7,12 @@
 #include "c74_min.h"
 #include "color_personality.hpp"
 #include "color_processor.hpp"
+#include "color_write_plan.hpp"
 #include "fixture.hpp"
+#include "fixture_manager.hpp"
+#include "instrumented_mutex.hpp"
 #include "precision_helpers.hpp"
+#include "triple_buffer.hpp"
 #include "common.hpp"
 
 using namespace c74;
@@ -24,17 +28,127 @@ atoms to_atoms(const lxmax::color_personality& value)
 	return a;
 }
 
+/// @brief Everything the output thread needs to write the fixture
+struct lx_colorfixture_state
+{
+	lxmax::color_processor processor;
+	lxmax::color_write_plan write_plan;
+	double intensity { 1. };
+	std::shared_ptr<const lxmax::response_curve> curve;
+};
+
 class lx_colorfixture : public object<lx_colorfixture>, public lxmax::fixture {
 
 	instance _lxmax_service { };
+	std::shared_ptr<lxmax::fixture_manager> _fixture_manager;
 	
-	std::mutex _value_mutex;
+	// Only taken by Max threads, the output thread reads the state they publish
+	lxmax::instrumented_mutex _value_mutex { "fixture value" };
 
-	lxmax::color_personality _personality;
+	lxmax::color_personality _personality { lxmax::color_personality_presets::k_rgb };
+	lxmax::color_write_plan _write_plan { _personality };
 	lxmax::color_processor _processor;
+	double _intensity { 1. };
+	std::shared_ptr<const lxmax::response_curve> _curve;
+	lxmax::triple_buffer<lx_colorfixture_state> _state;
+
+	int _channel_count { _write_plan.channel_count() };
+
+	/// @brief Publishes the current color and settings to the output thread, call with the value lock held
+	void publish_state()
+	{
+		lx_colorfixture_state& state = _state.write_buffer();
+
+		state.processor = _processor;
+		state.write_plan = _write_plan;
+		state.intensity = _intensity;
+		state.curve = _curve;
+
+		_state.publish();
+	}
+
+	void update_color(const ui::color& c)
+	{
+		std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
 
-	int _channel_count { 0 };
+		_processor.set_rgb(c.red(), c.green(), c.blue());
+		_intensity = c.alpha();
+		publish_state();
+	}
 	
+	void update_emitter_lut(const atoms& calibration)
+	{
+		lxmax::emitter_set set;
+
+		{
+			std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+			set = _write_plan.get_emitter_set();
+		}
+
+		const size_t expected_count = 9 + (lxmax::has_white(set) ? 3 : 0) + (lxmax::has_amber(set) ? 3 : 0);
+
+		std::shared_ptr<const lxmax::emitter_lut> lut;
+
+		if (_fixture_manager && set != lxmax::emitter_set::rgb && calibration.size() == expected_count)
+		{
+			lxmax::emitter_calibration c;
+			size_t i = 0;
+
+			const auto read_emitter = [&](lxmax::emitter_chromaticity& e)
+			{
+				e.x = calibration[i++];
+				e.y = calibration[i++];
+				e.luminance = calibration[i++];
+			};
+
+			read_emitter(c.red);
+			read_emitter(c.green);
+			read_emitter(c.blue);
+
+			if (lxmax::has_white(set))
+				read_emitter(c.white);
+
+			if (lxmax::has_amber(set))
+				read_emitter(c.amber);
+
+			lut = _fixture_manager->get_emitter_luts().get(c, set);
+		}
+		else if (set != lxmax::emitter_set::rgb && !calibration.empty())
+		{
+			cerr << "Emitter calibration for this personality needs " << expected_count << " values" << endl;
+		}
+
+		{
+			std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+			_processor.set_emitter_lut(lut);
+			publish_state();
+		}
+
+		set_updated();
+	}
+
+	bool update_curve(const symbol& name)
+	{
+		auto curve = _fixture_manager->get_response_curves().get(name);
+
+		if (!curve)
+		{
+			cerr << "Unknown response curve '" << name << "'" << endl;
+			return false;
+		}
+
+		{
+			std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+
+			// Skip the table for linear so values aren't rounded through it
+			_curve = name == symbol("linear") ? nullptr : std::move(curve);
+			publish_state();
+		}
+
+		set_updated();
+		return true;
+	}
+
 	void update_patch_info(int universe, int channel)
     {
 	    set_patch_info(lxmax::fixture_patch_info("Color Fixture", false, 
@@ -58,9 +172,20 @@ public:
 		
         _lxmax_service = get_lxmax_service_and_check_version(*this, lxmax::GIT_VERSION_STR);
 		
-		set_manager(get_fixture_manager(*this, _lxmax_service));
+		update_color(attr_fixture_color.get());
+
+		_fixture_manager = get_fixture_manager(*this, _lxmax_service);
+		set_manager(_fixture_manager);
+		update_emitter_lut(attr_emitter_calibration.get());
+		update_curve(attr_curve.get());
 		update_patch_info(attr_universe.get(), attr_channel.get());
     }
+
+	~lx_colorfixture()
+	{
+		// The output thread must stop using this object before its members are destroyed
+		unregister_from_manager();
+	}
     
     attribute<int, threadsafe::no, limit::clamp> attr_channel { this, "channel", 1,
         range { 1, 512 },
@@ -106,7 +231,19 @@ public:
 				personality.push_back(e);
 			}
 
-			_personality = personality;
+			{
+				std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+
+				_personality = personality;
+				_write_plan = lxmax::color_write_plan(_personality);
+				_channel_count = _write_plan.channel_count();
+				publish_state();
+			}
+
+			update_patch_info(attr_universe.get(), attr_channel.get());
+
+			if (_fixture_manager)
+				update_emitter_lut(attr_emitter_calibration.get());
 			
 			return to_atoms(_personality);
 		}}
@@ -115,7 +252,39 @@ public:
 	attribute<ui::color> attr_fixture_color { this, "fixture_color", ui::color(1, 1, 1, 1),
 		title { "Fixture Color"},
 		description { "Sets the color of the fixture"},
-		category { "lx.colorfixture"}, order { 5 }
+		category { "lx.colorfixture"}, order { 5 },
+		setter { MIN_FUNCTION {
+
+			update_color(ui::color(args[0], args[1], args[2], args.size() > 3 ? double(args[3]) : 1.));
+			set_updated();
+			return args;
+		}}
+	};
+
+	attribute<numbers> attr_emitter_calibration { this, "emitter_calibration", { },
+		title { "Emitter Calibration" },
+		description { "CIE x, y and relative luminance of each emitter, in the order red, green, blue, then white and amber when the personality has them. Leave empty to extract white and amber without calibration." },
+		category { "lx.colorfixture"}, order { 6 },
+		setter { MIN_FUNCTION {
+
+			if (_fixture_manager)
+				update_emitter_lut(args);
+
+			return args;
+		}}
+	};
+    
+	attribute<symbol> attr_curve { this, "curve", "linear",
+		title { "Response Curve" },
+		description { "Response curve applied to emitter and intensity levels: linear, square, s_curve or led" },
+		category { "lx.colorfixture"}, order { 7 },
+		setter { MIN_FUNCTION {
+
+			if (_fixture_manager && !update_curve(args[0]))
+				return { attr_curve.get() };
+
+			return args;
+		}}
 	};
     
 	argument<number> arg_channel { this, "channel", "DMX start channel for fixture",
@@ -135,37 +304,27 @@ public:
 	bool write_to_buffer(const lxmax::fixture_patch_info& patch_info, lxmax::universe_buffer_map& buffer_map,
 	                     lxmax::universe_updated_list& updated_universes, bool is_force) override
     {
-	    if (!is_force && !is_updated())
-			return false;
-		
-	    const lxmax::universe_address universe = patch_info.channel_range.start_universe();
-    	
-    	updated_universes.push_back(universe);
-
-	    const auto it = buffer_map.find(universe);
-
-    	if (it == std::end(buffer_map))
-			return false;
-
-    	lxmax::universe_buffer& buffer = it->second;
-		
-		{
-    		std::lock_guard<std::mutex> lock(_value_mutex);
+		return lxmax::write_universe_fixture(*this, patch_info, buffer_map, updated_universes, is_force);
+    }
 
-	    	for (const auto& e : _personality)
-	    	{
-	    		
-	    	}
+	lxmax::fixture_batch_writer batch_writer() const override
+	{
+		return &lxmax::write_universe_fixture_batch<lx_colorfixture>;
+	}
 
-			int channel = patch_info.channel_range.start_local();
+	/// @brief Writes the fixture's channels to the buffer of its start universe, called for updated or forced writes
+	void write_to_universe(const lxmax::fixture_patch_info& patch_info, lxmax::universe_buffer& buffer)
+	{
+		// Clear first so a version published while writing marks the fixture as updated again
+		clear_updated();
 
-			
+		_state.update();
+		lx_colorfixture_state& state = _state.read_buffer();
 
-	    	clear_updated(); 
-		}
+		const int channel = patch_info.channel_range.start_local();
 
-    	return true;
-    }
+		state.write_plan.write(state.processor, state.intensity, &buffer[channel], lxmax::k_universe_length - channel, state.curve.get());
+	}
 };
 
 
@@ -193,6 +193,42 @@ public:
 			return { };
 		}
 	};
+
+	message<> get_output_stats {
+		this, "get_output_stats", "Outputs a dictionary containing the DMX output service counters",
+		MIN_FUNCTION
+		{
+			max::t_atom rv;
+			max::object_method_typed(_lxmax_service, symbol("get_output_stats"), 0, nullptr, &rv);
+
+			max::t_dictionary* d = static_cast<max::t_dictionary*>(max::atom_getobj(&rv));
+
+			max::t_symbol* name = nullptr;
+			dictobj_register(d, &name);
+
+			dump_outlet.send({ symbol("output_stats"), symbol("dictionary"), name });
+
+			return { };
+		}
+	};
+
+	message<> get_artnet_nodes {
+		this, "get_artnet_nodes", "Outputs a dictionary containing the Art-Net nodes found by discovery",
+		MIN_FUNCTION
+		{
+			max::t_atom rv;
+			max::object_method_typed(_lxmax_service, symbol("get_artnet_nodes"), 0, nullptr, &rv);
+
+			max::t_dictionary* d = static_cast<max::t_dictionary*>(max::atom_getobj(&rv));
+
+			max::t_symbol* name = nullptr;
+			dictobj_register(d, &name);
+
+			dump_outlet.send({ symbol("artnet_nodes"), symbol("dictionary"), name });
+
+			return { };
+		}
+	};
 };
 
 MIN_EXTERNAL(lx_config);
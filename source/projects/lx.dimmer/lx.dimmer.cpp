@@ -6,7 +6,10 @@
 #include "version_info.hpp"
 #include "c74_min.h"
 #include "fixture.hpp"
+#include "fixture_manager.hpp"
+#include "instrumented_mutex.hpp"
 #include "precision_helpers.hpp"
+#include "triple_buffer.hpp"
 #include "common.hpp"
 
 using namespace c74;
@@ -50,22 +53,51 @@ enum_map lx_dimmer_priority_info {
 	"LTP (Latest Takes Precedence)"
 };
 
+/// @brief Everything the output thread needs to write the dimmers
+struct lx_dimmer_state
+{
+	std::vector<double> values;
+	number value_max { 1. };
+	lxmax::value_precision precision { lxmax::value_precision::_8bit };
+	int precision_width { 1 };
+	std::shared_ptr<const lxmax::response_curve> curve;
+};
+
 class lx_dimmer : public object<lx_dimmer>, public lxmax::fixture {
 
 	instance _lxmax_service { };
+	std::shared_ptr<lxmax::fixture_manager> _fixture_manager;
 	
-	std::mutex _value_mutex;
-    atoms _values;
+	// Only taken by Max threads, the output thread reads the state they publish
+	lxmax::instrumented_mutex _value_mutex { "fixture value" };
+	std::vector<double> _values;
+	std::shared_ptr<const lxmax::response_curve> _curve;
+	lxmax::triple_buffer<lx_dimmer_state> _state;
 
 	number _value_max { 1. };
+	lxmax::value_precision _precision { lxmax::value_precision::_8bit };
 	bool _is_little_endian { false };
 	bool _is_int_only { false };
 	int _precision_width { 1 };
 	int _channel_count { 0 };
+
+	/// @brief Publishes the current values and settings to the output thread, call with the value lock held
+	void publish_state()
+	{
+		lx_dimmer_state& state = _state.write_buffer();
+
+		state.values.assign(std::begin(_values), std::end(_values));
+		state.value_max = _value_max;
+		state.precision = _precision;
+		state.precision_width = _precision_width;
+		state.curve = _curve;
+
+		_state.publish();
+	}
 	
     void update_range(lx_dimmer_range r, lxmax::value_precision p)
     {
-		std::lock_guard<std::mutex> lock(_value_mutex);
+		std::unique_lock<lxmax::instrumented_mutex> lock(_value_mutex);
     	
 	    const number old_max = _value_max;
         
@@ -112,17 +144,18 @@ class lx_dimmer : public object<lx_dimmer>, public lxmax::fixture {
                 break;
         }
         
+        _precision = p;
         _is_little_endian = (p == lxmax::value_precision::_16bit_le
             || p == lxmax::value_precision::_24bit_le
             || p == lxmax::value_precision::_32bit_le);
         
         if (old_max != _value_max)
 		{
-            for (auto& _value : _values)
+            for (double& value : _values)
             {
-	            _value = scale<number>(_value, 0., old_max, 0., _value_max);
+	            value = value * _value_max / old_max;
                 if (_is_int_only)
-	                _value = round(double(_value));
+	                value = std::round(value);
             }
         }
 
@@ -150,9 +183,55 @@ class lx_dimmer : public object<lx_dimmer>, public lxmax::fixture {
                 break;
         }
 
+		publish_state();
+
+		// Patch outside the value lock, the fixture manager holds its own lock while writing fixtures
+		lock.unlock();
     	update_patch_info(attr_universe.get(), attr_channel.get(), attr_priority.get());
     }
 
+	bool update_curve(const symbol& name)
+	{
+		auto curve = _fixture_manager->get_response_curves().get(name);
+
+		if (!curve)
+		{
+			cerr << "Unknown response curve '" << name << "'" << endl;
+			return false;
+		}
+
+		{
+			std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+
+			// Skip the table for linear so values aren't rounded through it
+			_curve = name == symbol("linear") ? nullptr : std::move(curve);
+			publish_state();
+		}
+
+		set_updated();
+		return true;
+	}
+
+	/// @brief Sets dimmer values from the start of a list, ignoring any beyond the number of dimmers
+	void set_values(const atoms& args)
+	{
+		{
+			std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+
+			const size_t count = std::min(args.size(), _values.size());
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				double v = std::clamp(static_cast<double>(args[i]), 0., static_cast<double>(_value_max));
+				_values[i] = _is_int_only ? std::round(v) : v;
+			}
+
+			publish_state();
+		}
+
+		set_updated();
+	}
+
 	void update_patch_info(int universe, int channel, lx_dimmer_priority priority)
     {
 	    set_patch_info(lxmax::fixture_patch_info("Dimmer", priority == lx_dimmer_priority::htp, 
@@ -177,9 +256,18 @@ public:
         _lxmax_service = get_lxmax_service_and_check_version(*this, lxmax::GIT_VERSION_STR);
 		
 		update_range(attr_input_range, attr_precision);
-		set_manager(get_fixture_manager(*this, _lxmax_service));
+
+		_fixture_manager = get_fixture_manager(*this, _lxmax_service);
+		set_manager(_fixture_manager);
+		update_curve(attr_curve.get());
 		update_patch_info(attr_universe.get(), attr_channel.get(), attr_priority.get());
     }
+
+	~lx_dimmer()
+	{
+		// The output thread must stop using this object before its members are destroyed
+		unregister_from_manager();
+	}
     
     attribute<int, threadsafe::no, limit::clamp> attr_num_dimmers { this, "num_dimmers", 1,
         range { 1, 512 },
@@ -191,14 +279,10 @@ public:
         }},
         setter { MIN_FUNCTION {
 
-			std::lock_guard<std::mutex> lock(_value_mutex);
-        	
-			const int old_size = _values.size();
-        	const int new_size = args[0];
-            _values.resize(new_size);
+			std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
 
-        	for(int i = old_size; i < new_size; i++)
-				_values[i] = 0;
+            _values.resize(static_cast<int>(args[0]), 0.);
+			publish_state();
         	
             return { static_cast<int>(_values.size()) };
         }}
@@ -264,31 +348,51 @@ public:
         }}
     };
     
+	attribute<symbol> attr_curve { this, "curve", "linear",
+		title { "Response Curve" },
+		description { "Response curve applied to dimmer values: linear, square, s_curve or led" },
+		category {"lx.dimmer"}, order { 7 },
+		setter { MIN_FUNCTION {
+
+			if (_fixture_manager && !update_curve(args[0]))
+				return { attr_curve.get() };
+
+			return args;
+		}}
+	};
+    
     attribute<numbers> attr_value { this, "value", { 0 },
         title { "Value" },
         description { "Dimmer value(s)" },
         category {"lx.dimmer"}, order { 6 },
         getter { MIN_GETTER_FUNCTION {
-            return _values;
+
+			std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+            return atoms(std::begin(_values), std::end(_values));
 		}},
         setter { MIN_FUNCTION {
 
-			std::lock_guard<std::mutex> lock(_value_mutex);
-        	
-            for(int i = 0; i < args.size() && i < _values.size(); ++i)
-            {
-                number v = args[i];
-                _values[i] = MIN_CLAMP(v, 0, _value_max);
-                 if (_is_int_only)
-                     _values[i] = round(double(_values[i]));
-            }
+			set_values(args);
 
-        	set_updated();
-            
-            return { _values };
+			// Values are stored in _values and only read back through the getter
+            return {};
         }}
     };
 
+	message<> input_list { this, "list", "Set dimmer values",
+		MIN_FUNCTION {
+			set_values(args);
+			return {};
+		}
+	};
+
+	message<> input_number { this, "number", "Set the first dimmer's value",
+		MIN_FUNCTION {
+			set_values(args);
+			return {};
+		}
+	};
+
 	
 	argument<number> arg_num_dimmers { this, "number of dimmers", "Number of dimmers to control",
         MIN_ARGUMENT_FUNCTION {
@@ -313,51 +417,40 @@ public:
 	bool write_to_buffer(const lxmax::fixture_patch_info& patch_info, lxmax::universe_buffer_map& buffer_map,
 	                     lxmax::universe_updated_list& updated_universes, bool is_force) override
     {
-	    if (!is_force && !is_updated())
-			return false;
-		
-	    const lxmax::universe_address universe = patch_info.channel_range.start_universe();
-    	
-    	updated_universes.push_back(universe);
-
-	    const auto it = buffer_map.find(universe);
-
-    	if (it == std::end(buffer_map))
-			return false;
+		return lxmax::write_universe_fixture(*this, patch_info, buffer_map, updated_universes, is_force);
+    }
 
-    	lxmax::universe_buffer& buffer = it->second;
-		
-		{
-    		std::lock_guard<std::mutex> lock(_value_mutex);
+	lxmax::fixture_batch_writer batch_writer() const override
+	{
+		return &lxmax::write_universe_fixture_batch<lx_dimmer>;
+	}
 
-			int channel = patch_info.channel_range.start_local();
+	/// @brief Writes the fixture's channels to the buffer of its start universe, called for updated or forced writes
+	void write_to_universe(const lxmax::fixture_patch_info& patch_info, lxmax::universe_buffer& buffer)
+	{
+		// Clear first so a version published while writing marks the fixture as updated again
+		clear_updated();
 
-			auto value_it = std::begin(_values);
+		_state.update();
+		const lx_dimmer_state& state = _state.read_buffer();
 
-            if (patch_info.is_htp)
-            {
-	            while(channel + _precision_width <= lxmax::k_universe_length && value_it != std::end(_values))
-				{
-					lxmax::write_with_precision_htp(*value_it, _value_max, &buffer[channel], attr_precision);		
-					++value_it;
-					channel += _precision_width;
-				}
-            }
-            else
-            {
-	            while(channel + _precision_width <= lxmax::k_universe_length && value_it != std::end(_values))
-				{
-					lxmax::write_with_precision_ltp(*value_it, _value_max, &buffer[channel], attr_precision);		
-					++value_it;
-					channel += _precision_width;
-				}
-            }
+		const int start = patch_info.channel_range.start_local();
+		const size_t count = std::min(state.values.size(), static_cast<size_t>((lxmax::k_universe_length - start) / state.precision_width));
+		const double* values = state.values.data();
+		lxmax::dmx_value* data = &buffer[start];
 
-	    	clear_updated(); 
-		}
+        if (patch_info.is_htp)
+        {
+            for (size_t i = 0; i < count; ++i, data += state.precision_width)
+				lxmax::write_with_precision_htp(values[i], state.value_max, data, state.precision, state.curve.get());
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i, data += state.precision_width)
+				lxmax::write_with_precision_ltp(values[i], state.value_max, data, state.precision, state.curve.get());
+        }
 
-    	return true;
-    }
+	}
 };
 
 
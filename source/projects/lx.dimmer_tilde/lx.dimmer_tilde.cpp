@@ -0,0 +1,235 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "version_info.hpp"
+#include "c74_min.h"
+#include "fixture.hpp"
+#include "fixture_manager.hpp"
+#include "precision_helpers.hpp"
+#include "signal_decimator.hpp"
+#include "common.hpp"
+
+using namespace c74;
+using namespace min;
+
+enum_map lx_dimmer_tilde_precision_info = {
+	"8-Bit",
+	"16-Bit",
+	"24-Bit",
+	"32-Bit",
+	"16-Bit (Little Endian)",
+	"24-Bit (Little Endian)",
+	"32-Bit (Little Endian)",
+};
+
+enum_map lx_dimmer_tilde_mode_info = {
+	"Peak",
+	"Mean",
+	"Last"
+};
+
+enum class lx_dimmer_tilde_priority {
+	htp,
+	ltp,
+	enum_count
+};
+
+enum_map lx_dimmer_tilde_priority_info {
+	"HTP (Highest Takes Precedence)",
+	"LTP (Latest Takes Precedence)"
+};
+
+class lx_dimmer_tilde : public object<lx_dimmer_tilde>, public vector_operator<>, public lxmax::fixture {
+
+	instance _lxmax_service { };
+	std::shared_ptr<lxmax::fixture_manager> _fixture_manager;
+
+	std::vector<std::unique_ptr<inlet<>>> _inlets;
+
+	// Written by the audio thread and read by the output thread, neither takes a lock
+	std::unique_ptr<lxmax::signal_decimator> _decimator;
+
+	std::atomic<lxmax::value_precision> _precision { lxmax::value_precision::_8bit };
+
+	void update_patch_info(int universe, int channel, lxmax::value_precision precision, lx_dimmer_tilde_priority priority)
+	{
+		const int channel_count = static_cast<int>(_decimator->channel_count()) * lxmax::precision_helper::get_width(precision);
+
+		set_patch_info(lxmax::fixture_patch_info("Dimmer~", priority == lx_dimmer_tilde_priority::htp,
+			{ universe, channel, channel_count }));
+	}
+
+public:
+
+	MIN_DESCRIPTION	{"Send DMX control data to one or more dimmers from signals."};
+	MIN_TAGS		{"lxmax"};
+	MIN_AUTHOR		{"David Butler"};
+	MIN_RELATED		{"lx.dimmer"};
+
+	lx_dimmer_tilde(const atoms& args = {})
+	{
+		const int dimmer_count = args.empty() ? 1 : std::clamp(int(args[0]), 1, 512);
+
+		for (int i = 0; i < dimmer_count; ++i)
+			_inlets.push_back(std::make_unique<inlet<>>(this, "(signal) dimmer level (0-1)", "signal"));
+
+		_decimator = std::make_unique<lxmax::signal_decimator>(dimmer_count);
+
+		if (dummy())
+			return;
+
+		_lxmax_service = get_lxmax_service_and_check_version(*this, lxmax::GIT_VERSION_STR);
+
+		_fixture_manager = get_fixture_manager(*this, _lxmax_service);
+		set_streaming(true);
+		set_manager(_fixture_manager);
+		update_patch_info(attr_universe.get(), attr_channel.get(), _precision, attr_priority.get());
+	}
+
+	~lx_dimmer_tilde()
+	{
+		// The output thread must stop using this object before its members are destroyed
+		unregister_from_manager();
+	}
+
+	attribute<int, threadsafe::no, limit::clamp> attr_channel { this, "channel", 1,
+		range { 1, 512 },
+		title { "DMX Channel" },
+		description { "DMX start channel for dimmer(s)" },
+		category {"lx.dimmer~"}, order { 1 },
+		setter { MIN_FUNCTION {
+
+			if (_decimator)
+				update_patch_info(attr_universe.get(), args[0], _precision, attr_priority.get());
+			return { args[0] };
+		}}
+	};
+
+	attribute<int, threadsafe::no, limit::clamp> attr_universe { this, "universe", 1,
+		range { lxmax::k_universe_min, lxmax::k_universe_max },
+		title { "DMX Universe" },
+		description { "DMX universe number" },
+		category {"lx.dimmer~"}, order { 2 },
+		setter { MIN_FUNCTION {
+
+			if (_decimator)
+				update_patch_info(args[0], attr_channel.get(), _precision, attr_priority.get());
+			return { args[0] };
+		}}
+	};
+
+	attribute<lxmax::value_precision> attr_precision { this, "precision",
+		lxmax::value_precision::_8bit, lx_dimmer_tilde_precision_info,
+		title { "Precision" },
+		description { "Output value precision" },
+		category {"lx.dimmer~"}, order { 3 },
+		setter { MIN_FUNCTION {
+
+			_precision = static_cast<lxmax::value_precision>(args[0]);
+			if (_decimator)
+				update_patch_info(attr_universe.get(), attr_channel.get(), _precision, attr_priority.get());
+			return { args[0] };
+		}}
+	};
+
+	attribute<lx_dimmer_tilde_priority> attr_priority { this, "priority",
+		lx_dimmer_tilde_priority::htp, lx_dimmer_tilde_priority_info,
+		title { "Priority" },
+		description { "Priority mode when merging with other LXMax object's data" },
+		category {"lx.dimmer~"}, order { 4 },
+		setter { MIN_FUNCTION {
+
+			if (_decimator)
+				update_patch_info(attr_universe.get(), attr_channel.get(), _precision, static_cast<lx_dimmer_tilde_priority>(args[0]));
+			return { args[0] };
+		}}
+	};
+
+	attribute<lxmax::decimation_mode> attr_mode { this, "mode",
+		lxmax::decimation_mode::peak, lx_dimmer_tilde_mode_info,
+		title { "Mode" },
+		description { "How the samples received during each DMX frame are reduced to one level" },
+		category {"lx.dimmer~"}, order { 5 },
+		setter { MIN_FUNCTION {
+
+			if (_decimator)
+				_decimator->set_mode(static_cast<lxmax::decimation_mode>(args[0]));
+			return { args[0] };
+		}}
+	};
+
+	argument<number> arg_num_dimmers { this, "number of dimmers", "Number of dimmers to control, each has a signal inlet",
+		MIN_ARGUMENT_FUNCTION {
+			// Inlets are created by the constructor
+		}
+	};
+
+	argument<number> arg_channel { this, "channel", "DMX start channel for dimmer(s)",
+		MIN_ARGUMENT_FUNCTION {
+			attr_channel = arg;
+		}
+	};
+
+	argument<number> arg_universe { this, "universe", "DMX universe number",
+		MIN_ARGUMENT_FUNCTION {
+			attr_universe = arg;
+		}
+	};
+
+	void operator()(audio_bundle input, audio_bundle output)
+	{
+		_decimator->begin_vector();
+
+		const size_t channel_count = std::min(static_cast<size_t>(input.channel_count()), _decimator->channel_count());
+
+		for (size_t c = 0; c < channel_count; ++c)
+			_decimator->process(c, input.samples(c), input.frame_count());
+
+		_decimator->end_vector();
+	}
+
+	bool write_to_buffer(const lxmax::fixture_patch_info& patch_info, lxmax::universe_buffer_map& buffer_map,
+	                     lxmax::universe_updated_list& updated_universes, bool is_force) override
+	{
+		// Ending the frame before reading it means a vector finishing during the read is carried into the next frame
+		const bool has_samples = _decimator->end_frame();
+
+		if (!is_force && !has_samples)
+			return false;
+
+		const lxmax::universe_address universe = patch_info.channel_range.start_universe();
+
+		const auto it = buffer_map.find(universe);
+
+		if (it == std::end(buffer_map))
+			return false;
+
+		lxmax::universe_buffer& buffer = it->second;
+
+		const lxmax::value_precision precision = _precision;
+		const int width = lxmax::precision_helper::get_width(precision);
+
+		int channel = patch_info.channel_range.start_local();
+
+		for (size_t i = 0; i < _decimator->channel_count() && channel + width <= lxmax::k_universe_length; ++i)
+		{
+			const double value = std::clamp(static_cast<double>(_decimator->value(i)), 0., 1.);
+
+			if (patch_info.is_htp)
+				lxmax::write_with_precision_htp(value, 1., &buffer[channel], precision);
+			else
+				lxmax::write_with_precision_ltp(value, 1., &buffer[channel], precision);
+
+			channel += width;
+		}
+
+		updated_universes.push_back(universe);
+
+		return true;
+	}
+};
+
+
+MIN_EXTERNAL(lx_dimmer_tilde);
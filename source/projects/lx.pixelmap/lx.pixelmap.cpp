@@ -0,0 +1,310 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "version_info.hpp"
+#include "c74_min.h"
+#include "fixture.hpp"
+#include "fixture_manager.hpp"
+#include "instrumented_mutex.hpp"
+#include "pixel_map.hpp"
+#include "triple_buffer.hpp"
+#include "common.hpp"
+
+using namespace c74;
+using namespace min;
+
+enum_map lx_pixelmap_layout_info = {
+	"Progressive",
+	"Snake",
+	"Zigzag"
+};
+
+enum class lx_pixelmap_priority {
+	htp,
+	ltp,
+	enum_count
+};
+
+enum_map lx_pixelmap_priority_info {
+	"HTP (Highest Takes Precedence)",
+	"LTP (Latest Takes Precedence)"
+};
+
+/// @brief Channel image passed to the output thread
+struct lx_pixelmap_state
+{
+	std::vector<lxmax::dmx_value> image;
+	int layout_version { 0 };
+};
+
+class lx_pixelmap : public object<lx_pixelmap>, public lxmax::fixture {
+
+	instance _lxmax_service { };
+	std::shared_ptr<lxmax::fixture_manager> _fixture_manager;
+
+	// Only taken by Max threads, the output thread reads the image they publish
+	lxmax::instrumented_mutex _value_mutex { "fixture value" };
+
+	lxmax::pixel_map _map { lxmax::pixel_map_config { 0, 0 } };
+	int _layout_version { 0 };
+	lxmax::triple_buffer<lx_pixelmap_state> _state;
+
+	/// @brief Gets the image to fill, cleared if it was last filled with a different layout
+	lxmax::dmx_value* get_write_image()
+	{
+		lx_pixelmap_state& state = _state.write_buffer();
+
+		if (state.layout_version != _layout_version)
+		{
+			state.image.assign(_map.channel_range().channel_count(), 0);
+			state.layout_version = _layout_version;
+		}
+
+		return state.image.data();
+	}
+
+	/// @brief Rebuilds the index table if the layout has changed and patches the map's channel range
+	void update_map(const lxmax::pixel_map_config& config, bool is_htp)
+	{
+		lxmax::fixture_patch_info patch_info("Pixel Map", is_htp, lxmax::dmx_channel_range());
+
+		{
+			std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+
+			if (_map.set_config(config))
+			{
+				++_layout_version;
+				get_write_image();
+				_state.publish();
+			}
+
+			// Stay unpatched until the first matrix arrives
+			if (_map.channel_range().channel_count() > 0)
+			{
+				patch_info.channel_range = _map.channel_range();
+
+				// The unused end of each universe but the last is left out of the patch
+				if (_map.universe_spans().size() > 1)
+					patch_info.spans = _map.universe_spans();
+			}
+		}
+
+		// Patch outside the value lock, the fixture manager holds its own lock while writing fixtures
+		set_patch_info(std::move(patch_info));
+		set_updated();
+	}
+
+	lxmax::pixel_map_config get_map_config()
+	{
+		std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+		return _map.config();
+	}
+
+	bool is_priority_htp() const
+	{
+		return attr_priority.get() == lx_pixelmap_priority::htp;
+	}
+
+public:
+
+	MIN_DESCRIPTION	{"Map a Jitter matrix to DMX pixels."};
+	MIN_TAGS		{"lxmax"};
+	MIN_AUTHOR		{"David Butler"};
+	MIN_RELATED		{"lx.dimmer, lx.colorfixture"};
+
+	inlet<>  input	{ this, "(matrix) char or float32 matrix with 3 (RGB) or 4 (ARGB) planes" };
+
+	lx_pixelmap(const atoms& args = {})
+	{
+		if (dummy())
+			return;
+
+		_lxmax_service = get_lxmax_service_and_check_version(*this, lxmax::GIT_VERSION_STR);
+
+		_fixture_manager = get_fixture_manager(*this, _lxmax_service);
+		set_manager(_fixture_manager);
+		update_map(get_map_config(), is_priority_htp());
+	}
+
+	~lx_pixelmap()
+	{
+		// The output thread must stop using this object before its members are destroyed
+		unregister_from_manager();
+	}
+
+	attribute<int, threadsafe::no, limit::clamp> attr_channel { this, "channel", 1,
+		range { 1, 512 },
+		title { "DMX Channel" },
+		description { "DMX start channel of the first pixel" },
+		category {"lx.pixelmap"}, order { 1 },
+		setter { MIN_FUNCTION {
+
+			auto config = get_map_config();
+			config.start_channel = args[0];
+			update_map(config, is_priority_htp());
+			return { args[0] };
+		}}
+	};
+
+	attribute<int, threadsafe::no, limit::clamp> attr_universe { this, "universe", 1,
+		range { lxmax::k_universe_min, lxmax::k_universe_max },
+		title { "DMX Universe" },
+		description { "DMX universe of the first pixel" },
+		category {"lx.pixelmap"}, order { 2 },
+		setter { MIN_FUNCTION {
+
+			auto config = get_map_config();
+			config.start_universe = args[0];
+			update_map(config, is_priority_htp());
+			return { args[0] };
+		}}
+	};
+
+	attribute<lxmax::pixel_map_layout> attr_layout { this, "layout",
+		lxmax::pixel_map_layout::progressive, lx_pixelmap_layout_info,
+		title { "Layout" },
+		description { "Order the pixel chain is wired through the matrix" },
+		category {"lx.pixelmap"}, order { 3 },
+		setter { MIN_FUNCTION {
+
+			auto config = get_map_config();
+			config.layout = static_cast<lxmax::pixel_map_layout>(args[0]);
+			update_map(config, is_priority_htp());
+			return { args[0] };
+		}}
+	};
+
+	attribute<int, threadsafe::no, limit::clamp> attr_channels_per_pixel { this, "channels_per_pixel", 3,
+		range { 3, 4 },
+		title { "Channels per Pixel" },
+		description { "3 for RGB pixels, 4 for RGBW pixels driven from the alpha plane" },
+		category {"lx.pixelmap"}, order { 4 },
+		setter { MIN_FUNCTION {
+
+			auto config = get_map_config();
+			config.channels_per_pixel = args[0];
+			update_map(config, is_priority_htp());
+			return { args[0] };
+		}}
+	};
+
+	attribute<int, threadsafe::no, limit::clamp> attr_pixels_per_universe { this, "pixels_per_universe", 0,
+		range { 0, 170 },
+		title { "Pixels per Universe" },
+		description { "Maximum number of pixels in each universe, 0 to fill each universe" },
+		category {"lx.pixelmap"}, order { 5 },
+		setter { MIN_FUNCTION {
+
+			auto config = get_map_config();
+			config.pixels_per_universe = args[0];
+			update_map(config, is_priority_htp());
+			return { args[0] };
+		}}
+	};
+
+	attribute<lx_pixelmap_priority> attr_priority { this, "priority",
+		lx_pixelmap_priority::ltp, lx_pixelmap_priority_info,
+		title { "Priority" },
+		description { "Priority mode when merging with other LXMax object's data" },
+		category {"lx.pixelmap"}, order { 6 },
+		setter { MIN_FUNCTION {
+
+			update_map(get_map_config(), static_cast<lx_pixelmap_priority>(args[0]) == lx_pixelmap_priority::htp);
+			return { args[0] };
+		}}
+	};
+
+	argument<number> arg_channel { this, "channel", "DMX start channel of the first pixel",
+		MIN_ARGUMENT_FUNCTION {
+			attr_channel = arg;
+		}
+	};
+
+	argument<number> arg_universe { this, "universe", "DMX universe of the first pixel",
+		MIN_ARGUMENT_FUNCTION {
+			attr_universe = arg;
+		}
+	};
+
+	message<> jit_matrix { this, "jit_matrix", "Map a matrix to the pixels",
+		MIN_FUNCTION {
+
+			const symbol name = args[0];
+
+			void* matrix = max::jit_object_findregistered(name);
+			if (!matrix)
+			{
+				cerr << "Unable to find matrix '" << name << "'" << endl;
+				return {};
+			}
+
+			void* saved_lock = max::jit_object_method(matrix, max::_jit_sym_lock, reinterpret_cast<void*>(1));
+
+			max::t_jit_matrix_info info;
+			max::jit_object_method(matrix, max::_jit_sym_getinfo, &info);
+
+			char* data = nullptr;
+			max::jit_object_method(matrix, max::_jit_sym_getdata, &data);
+
+			const bool is_char = info.type == max::_jit_sym_char;
+			const bool is_float = info.type == max::_jit_sym_float32;
+
+			if (!data || (!is_char && !is_float) || info.dimcount > 2 || info.planecount < 3 || info.planecount > 4)
+			{
+				max::jit_object_method(matrix, max::_jit_sym_lock, saved_lock);
+				cerr << "Matrix must be 1 or 2 dimensional char or float32 with 3 or 4 planes" << endl;
+				return {};
+			}
+
+			const int width = static_cast<int>(info.dim[0]);
+			const int height = info.dimcount > 1 ? static_cast<int>(info.dim[1]) : 1;
+
+			auto config = get_map_config();
+			config.width = width;
+			config.height = height;
+			update_map(config, is_priority_htp());
+
+			{
+				std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+
+				const lxmax::pixel_source source { data, static_cast<int>(info.planecount),
+					static_cast<ptrdiff_t>(info.dimstride[0]), info.dimcount > 1 ? static_cast<ptrdiff_t>(info.dimstride[1]) : 0 };
+
+				if (is_char)
+					_map.fill(source, get_write_image());
+				else
+					_map.fill_float(source, get_write_image());
+
+				_state.publish();
+			}
+
+			max::jit_object_method(matrix, max::_jit_sym_lock, saved_lock);
+
+			set_updated();
+			return {};
+		}
+	};
+
+	bool write_to_buffer(const lxmax::fixture_patch_info& patch_info, lxmax::universe_buffer_map& buffer_map,
+	                     lxmax::universe_updated_list& updated_universes, bool is_force) override
+	{
+		if (!is_force && !is_updated())
+			return false;
+
+		// Clear first so an image published while writing marks the fixture as updated again
+		clear_updated();
+
+		_state.update();
+		const lx_pixelmap_state& state = _state.read_buffer();
+
+		// Only the spans are written, so fixtures patched after the last pixel in a universe keep their channels
+		lxmax::write_channel_image(patch_info, state.image.data(), state.image.size(), buffer_map, updated_universes);
+
+		return true;
+	}
+};
+
+
+MIN_EXTERNAL(lx_pixelmap);
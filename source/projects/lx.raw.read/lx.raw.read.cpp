@@ -0,0 +1,194 @@
+/// @file
+/// @ingroup	lxmax
+/// @copyright	Copyright 2020 David Butler. All rights reserved.
+/// @license	Use of this source code is governed by the MIT License found in the License.md file.
+
+#include "version_info.hpp"
+#include "c74_min.h"
+#include "dmx_buffer_manager.hpp"
+#include "universe_diff.hpp"
+#include "universe_monitor.hpp"
+#include "common.hpp"
+
+using namespace c74::min;
+
+enum class lx_raw_read_mode {
+	list,
+	delta,
+	enum_count
+};
+
+enum_map lx_raw_read_mode_info {
+	"List of all channel values",
+	"Changed channel and value pairs"
+};
+
+class lx_raw_read : public object<lx_raw_read> {
+
+	instance _lxmax_service { };
+	std::shared_ptr<lxmax::dmx_buffer_manager> _buffer_manager;
+	std::unique_ptr<lxmax::universe_monitor> _monitor;
+
+	// Only used from the main thread
+	lxmax::universe_buffer _last_frame { };
+	std::vector<int> _changed_channels;
+
+	void set_monitored_universe(int universe)
+	{
+		if (!_monitor)
+			return;
+
+		_buffer_manager->remove_monitor(_monitor.get());
+		_monitor->set_universe(universe);
+		_last_frame.fill(0);
+		_buffer_manager->add_monitor(_monitor.get());
+	}
+
+	void output_frame(const lxmax::universe_buffer& frame, bool is_delta, bool is_force)
+	{
+		const int start = attr_channel.get() - 1;
+		const int count = std::min(attr_num_channels.get(), lxmax::k_universe_length - start);
+
+		atoms values;
+
+		if (is_delta)
+		{
+			_changed_channels.clear();
+
+			if (is_force)
+			{
+				for (int i = 0; i < count; ++i)
+					_changed_channels.push_back(i);
+			}
+			else if (lxmax::find_changed_channels(&_last_frame[start], &frame[start], count, _changed_channels) == 0)
+			{
+				return;
+			}
+
+			values.reserve(_changed_channels.size() * 2);
+
+			for (int i : _changed_channels)
+			{
+				values.push_back(start + i + 1);
+				values.push_back(frame[start + i]);
+			}
+		}
+		else
+		{
+			values.reserve(count);
+
+			for (int i = 0; i < count; ++i)
+				values.push_back(frame[start + i]);
+		}
+
+		_last_frame = frame;
+		output.send(values);
+	}
+
+public:
+
+	MIN_DESCRIPTION	{"Read raw DMX data from an LXMax universe"};
+	MIN_TAGS		{"lxmax"};
+	MIN_AUTHOR		{"David Butler"};
+	MIN_RELATED		{"lx.raw.write"};
+
+	inlet<>  input	{ this, "(bang) output the current values" };
+	outlet<> output	{ this, "(list) channel values, or channel and value pairs in delta mode" };
+
+	lx_raw_read(const atoms& args = {})
+    {
+        if (dummy())
+			return;
+
+        _lxmax_service = get_lxmax_service_and_check_version(*this, lxmax::GIT_VERSION_STR);
+
+		_buffer_manager = get_dmx_buffer_manager(*this, _lxmax_service);
+
+		// Frames arriving faster than the main thread empties the queue are coalesced into a single output
+		_monitor = std::make_unique<lxmax::universe_monitor>(attr_universe.get(), [this]() { frame_queue.set(); });
+		_buffer_manager->add_monitor(_monitor.get());
+    }
+
+	~lx_raw_read()
+	{
+		if (_monitor)
+			_buffer_manager->remove_monitor(_monitor.get());
+	}
+
+    attribute<int, threadsafe::no, limit::clamp> attr_num_channels { this, "num_channels", lxmax::k_universe_length,
+        range { 1, lxmax::k_universe_length },
+        title { "Number of Channels" },
+        description { "Number of channels to read" },
+        category {"lx.raw.read"}, order { 1 }
+    };
+
+    attribute<int, threadsafe::no, limit::clamp> attr_channel { this, "channel", 1,
+        range { 1, lxmax::k_universe_length },
+        title { "DMX Channel" },
+		description { "DMX start channel to read data from" },
+        category {"lx.raw.read"}, order { 2 }
+	};
+
+    attribute<int, threadsafe::no, limit::clamp> attr_universe { this, "universe", 1,
+        range { lxmax::k_universe_min, lxmax::k_universe_max },
+        title { "DMX Universe" },
+        description { "DMX universe number" },
+        category {"lx.raw.read"}, order { 3 },
+    	setter { MIN_FUNCTION {
+
+            set_monitored_universe(args[0]);
+            return { args[0] };
+        }}
+    };
+
+	attribute<lx_raw_read_mode> attr_mode { this, "mode",
+		lx_raw_read_mode::list, lx_raw_read_mode_info,
+        title { "Output Mode" },
+        description { "Output a list of every channel value, or only the channels which have changed as channel and value pairs" },
+        category {"lx.raw.read"}, order { 4 }
+    };
+
+	argument<number> arg_num_channels { this, "number of channels", "Number of channels to read",
+        MIN_ARGUMENT_FUNCTION {
+            attr_num_channels = arg;
+        }
+    };
+
+	argument<number> arg_channel { this, "channel", "DMX start channel to read data from",
+		MIN_ARGUMENT_FUNCTION {
+			attr_channel = arg;
+		}
+	};
+
+	argument<number> arg_universe { this, "universe", "DMX universe number",
+        MIN_ARGUMENT_FUNCTION {
+            attr_universe = arg;
+        }
+    };
+
+	queue<> frame_queue { this,
+		MIN_FUNCTION {
+
+			if (_monitor && _monitor->update())
+				output_frame(_monitor->frame(), attr_mode.get() == lx_raw_read_mode::delta, false);
+
+			return {};
+		}
+	};
+
+	message<> bang { this, "bang", "Output the current values, all monitored channels are sent in delta mode",
+		MIN_FUNCTION {
+
+			if (!_monitor)
+				return {};
+
+			_monitor->update();
+			output_frame(_monitor->frame(), attr_mode.get() == lx_raw_read_mode::delta, true);
+
+			return {};
+		}
+	};
+};
+
+
+MIN_EXTERNAL(lx_raw_read);
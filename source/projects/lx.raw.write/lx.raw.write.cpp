@@ -5,20 +5,65 @@
 
 #include "version_info.hpp"
 #include "c74_min.h"
+#include "channel_image.hpp"
 #include "fixture.hpp"
-#include "precision_helpers.hpp"
+#include "fixture_manager.hpp"
+#include "instrumented_mutex.hpp"
+#include "triple_buffer.hpp"
 #include "common.hpp"
 
-using namespace c74::min;
+using namespace c74;
+using namespace min;
 
-class lx_raw_write : public object<lx_raw_write> {
+enum class lx_raw_write_priority {
+	htp,
+	ltp,
+	enum_count
+};
+
+enum_map lx_raw_write_priority_info {
+	"HTP (Highest Takes Precedence)",
+	"LTP (Latest Takes Precedence)"
+};
+
+// Enough for a matrix covering 128 universes
+const int k_raw_write_max_channels = lxmax::k_universe_length * 128;
+
+class lx_raw_write : public object<lx_raw_write>, public lxmax::fixture {
 
 	instance _lxmax_service { };
-	
-	std::mutex _value_mutex;
-    atoms _values;
+	std::shared_ptr<lxmax::fixture_manager> _fixture_manager;
+
+	// Only taken by Max threads, the output thread reads the image they publish
+	lxmax::instrumented_mutex _value_mutex { "fixture value" };
+	std::vector<lxmax::dmx_value> _values = std::vector<lxmax::dmx_value>(1, 0);
+	lxmax::triple_buffer<std::vector<lxmax::dmx_value>> _state;
+
+	/// @brief Publishes the current values to the output thread, call with the value lock held
+	void publish_values()
+	{
+		_state.write_buffer().assign(std::begin(_values), std::end(_values));
+		_state.publish();
+	}
+
+	void update_patch_info(int universe, int channel, int channel_count, lx_raw_write_priority priority)
+	{
+		set_patch_info(lxmax::fixture_patch_info("Raw Write", priority == lx_raw_write_priority::htp,
+			{ universe, channel, channel_count }));
+		set_updated();
+	}
 
-	int _channel_count { 0 };
+	void resize(int channel_count)
+	{
+		{
+			std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+
+			_values.resize(channel_count, 0);
+			publish_values();
+		}
+
+		update_patch_info(attr_universe.get(), attr_channel.get(), channel_count, attr_priority.get());
+	}
 
 public:
 
@@ -27,70 +72,194 @@ public:
 	MIN_AUTHOR		{"David Butler"};
 	MIN_RELATED		{"lx.raw.read"};
 
-	inlet<>  input	{ this, "(list) list of dimmer values" };
+	inlet<>  input	{ this, "(list) channel values (0-255), (matrix) char matrix of channel values" };
 
 	lx_raw_write(const atoms& args = {})
     {
         if (dummy())
 			return;
-		
+
         _lxmax_service = get_lxmax_service_and_check_version(*this, lxmax::GIT_VERSION_STR);
+
+		_fixture_manager = get_fixture_manager(*this, _lxmax_service);
+		set_manager(_fixture_manager);
+		resize(attr_num_channels.get());
     }
-    
+
+	~lx_raw_write()
+	{
+		// The output thread must stop using this object before its members are destroyed
+		unregister_from_manager();
+	}
+
     attribute<int, threadsafe::no, limit::clamp> attr_num_channels { this, "num_channels", 1,
-        range { 1, 512 },
+        range { 1, k_raw_write_max_channels },
         title { "Number of Channels" },
-        description { "Number of channels to write" },
+        description { "Number of channels to write, set automatically from the size of matrices" },
         category {"lx.raw.write"}, order { 1 },
         getter { MIN_GETTER_FUNCTION {
-            return { (int)_values.size() };
+
+			std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+            return { static_cast<int>(_values.size()) };
         }},
         setter { MIN_FUNCTION {
 
-			std::lock_guard<std::mutex> lock(_value_mutex);
-        	
-			const int old_size = _values.size();
-        	const int new_size = args[0];
-            _values.resize(new_size);
-
-        	for(int i = old_size; i < new_size; i++)
-				_values[i] = 0;
-        	
-            return { (int)_values.size() };
+			resize(args[0]);
+            return { args[0] };
         }}
     };
-    
+
     attribute<int, threadsafe::no, limit::clamp> attr_channel { this, "channel", 1,
         range { 1, 512 },
         title { "DMX Channel" },
 		description { "DMX start channel to write starting data from" },
-        category {"lx.raw.write"}, order { 2 }
+        category {"lx.raw.write"}, order { 2 },
+    	setter { MIN_FUNCTION {
+
+            update_patch_info(attr_universe.get(), args[0], attr_num_channels.get(), attr_priority.get());
+            return { args[0] };
+        }}
 	};
-    
+
     attribute<int, threadsafe::no, limit::clamp> attr_universe { this, "universe", 1,
         range { lxmax::k_universe_min, lxmax::k_universe_max },
         title { "DMX Universe" },
         description { "DMX universe number" },
-        category {"lx.raw.write"}, order { 3 }
+        category {"lx.raw.write"}, order { 3 },
+    	setter { MIN_FUNCTION {
+
+            update_patch_info(args[0], attr_channel.get(), attr_num_channels.get(), attr_priority.get());
+            return { args[0] };
+        }}
     };
-	
+
+	attribute<lx_raw_write_priority> attr_priority { this, "priority",
+		lx_raw_write_priority::ltp, lx_raw_write_priority_info,
+        title { "Priority" },
+        description { "Priority mode when merging with other LXMax object's data" },
+        category {"lx.raw.write"}, order { 4 },
+		setter { MIN_FUNCTION {
+
+            update_patch_info(attr_universe.get(), attr_channel.get(), attr_num_channels.get(), static_cast<lx_raw_write_priority>(args[0]));
+            return { args[0] };
+        }}
+    };
+
 	argument<number> arg_num_channels { this, "number of channels", "Number of channels write data to",
         MIN_ARGUMENT_FUNCTION {
             attr_num_channels = arg;
         }
     };
-    
+
 	argument<number> arg_channel { this, "channel", "DMX start channel to start writing data from",
 		MIN_ARGUMENT_FUNCTION {
 			attr_channel = arg;
 		}
 	};
-    
+
     argument<number> arg_universe { this, "universe", "DMX universe number",
         MIN_ARGUMENT_FUNCTION {
             attr_universe = arg;
         }
     };
+
+	message<> input_list { this, "list", "Set channel values starting from the first channel",
+		MIN_FUNCTION {
+
+			{
+				std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+
+				const size_t count = std::min({ args.size(), _values.size(), static_cast<size_t>(lxmax::k_universe_length) });
+
+				for (size_t i = 0; i < count; ++i)
+					_values[i] = static_cast<lxmax::dmx_value>(std::clamp(static_cast<int>(args[i]), 0, 255));
+
+				publish_values();
+			}
+
+			set_updated();
+			return {};
+		}
+	};
+
+	message<> jit_matrix { this, "jit_matrix", "Set channel values from a char matrix, read in row order with planes interleaved",
+		MIN_FUNCTION {
+
+			const symbol name = args[0];
+
+			void* matrix = max::jit_object_findregistered(name);
+			if (!matrix)
+			{
+				cerr << "Unable to find matrix '" << name << "'" << endl;
+				return {};
+			}
+
+			void* saved_lock = max::jit_object_method(matrix, max::_jit_sym_lock, reinterpret_cast<void*>(1));
+
+			max::t_jit_matrix_info info;
+			max::jit_object_method(matrix, max::_jit_sym_getinfo, &info);
+
+			char* data = nullptr;
+			max::jit_object_method(matrix, max::_jit_sym_getdata, &data);
+
+			if (!data || info.type != max::_jit_sym_char || info.dimcount > 2)
+			{
+				max::jit_object_method(matrix, max::_jit_sym_lock, saved_lock);
+				cerr << "Matrix must be 1 or 2 dimensional char" << endl;
+				return {};
+			}
+
+			const size_t row_length = static_cast<size_t>(info.dim[0] * info.planecount);
+			const size_t row_count = info.dimcount > 1 ? static_cast<size_t>(info.dim[1]) : 1;
+			const int channel_count = static_cast<int>(std::min(row_length * row_count, static_cast<size_t>(k_raw_write_max_channels)));
+
+			if (channel_count != attr_num_channels.get())
+				attr_num_channels = channel_count;
+
+			{
+				std::lock_guard<lxmax::instrumented_mutex> lock(_value_mutex);
+
+				// Rows may be padded, so each is copied separately
+				std::vector<lxmax::dmx_value>& image = _state.write_buffer();
+				image.resize(_values.size());
+
+				for (size_t row = 0, offset = 0; row < row_count && offset < image.size(); ++row, offset += row_length)
+					std::memcpy(&image[offset], data + row * info.dimstride[1], std::min(row_length, image.size() - offset));
+
+				std::copy(std::begin(image), std::end(image), std::begin(_values));
+				_state.publish();
+			}
+
+			max::jit_object_method(matrix, max::_jit_sym_lock, saved_lock);
+
+			set_updated();
+			return {};
+		}
+	};
+
+	bool write_to_buffer(const lxmax::fixture_patch_info& patch_info, lxmax::universe_buffer_map& buffer_map,
+	                     lxmax::universe_updated_list& updated_universes, bool is_force) override
+	{
+		if (!is_force && !is_updated())
+			return false;
+
+		// Clear first so values published while writing mark the fixture as updated again
+		clear_updated();
+
+		_state.update();
+		const std::vector<lxmax::dmx_value>& image = _state.read_buffer();
+
+		lxmax::write_channel_image(patch_info.channel_range, image.data(), image.size(), patch_info.is_htp,
+			buffer_map, updated_universes);
+
+		return true;
+	}
+
+	/// @brief Images can span universes, so batches call write_to_buffer directly rather than sharing a buffer lookup
+	lxmax::fixture_batch_writer batch_writer() const override
+	{
+		return &lxmax::write_fixture_batch<lx_raw_write>;
+	}
 };
 
 
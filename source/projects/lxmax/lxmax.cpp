@@ -7,6 +7,8 @@
 #include "dmx_output_service.hpp"
 #include "fixture_manager.hpp"
 
+#include <fstream>
+
 #include <Poco/Logger.h>
 #include <Poco/Delegate.h>
 #include <Poco/Net/NetException.h>
@@ -17,8 +19,10 @@
 #include "common.hpp"
 
 #include "dict_edit.hpp"
+#include "instrumented_mutex.hpp"
 #include "max_console_channel.hpp"
 #include "preferences_manager.hpp"
+#include "trace.hpp"
 
 using namespace c74;
 using namespace min;
@@ -31,6 +35,7 @@ void on_max_quit(void* a)
 class lxmax_service : public object<lxmax_service>
 {
 	static const inline string k_preferences_filename { "lxmaxpreferences.json" };
+	static const inline string k_trace_filename { "lxmaxtrace.json" };
 	static const inline string k_universes_dict_name { "___lxmax_universes" };
 
 	const vector<dict_edit_column> k_editor_columns
@@ -54,13 +59,13 @@ class lxmax_service : public object<lxmax_service>
 	std::unique_ptr<lxmax::dmx_output_service> _dmx_output_service;
 	
 
-	static std::string get_preference_path()
+	static std::string get_preference_path(const string& filename = k_preferences_filename)
 	{
 		short pref_path;
 		max::preferences_path(nullptr, true, &pref_path);
 
 		char file_path[MAX_PATH_CHARS];
-		max::path_toabsolutesystempath(pref_path, k_preferences_filename.c_str(), file_path);
+		max::path_toabsolutesystempath(pref_path, filename.c_str(), file_path);
 
 		return file_path;
 	}
@@ -202,7 +207,7 @@ public:
 	MIN_DESCRIPTION { "LXMax service object." };
 	MIN_TAGS { "lxmax" };
 	MIN_AUTHOR { "David Butler" };
-	MIN_RELATED { "lx.config, lx.dimmer, lx.colorfixture, lx.raw.write" };
+	MIN_RELATED { "lx.config, lx.dimmer, lx.colorfixture, lx.raw.write, lx.raw.read" };
 
 	MIN_FLAGS { behavior_flags::nobox };
 
@@ -210,6 +215,8 @@ public:
 	{
 		if (dummy())
 			return;
+
+		LXMAX_TRACE_THREAD_NAME("Max Main");
 		
 		Poco::Logger& root_logger = Poco::Logger::root();
 		root_logger.setChannel(Poco::AutoPtr<max_console_channel>(new max_console_channel(maxobj())));
@@ -426,6 +433,16 @@ public:
 		}
 	};
 
+	message<> get_dmx_buffer_manager {
+		this, "get_dmx_buffer_manager", "Gets a pointer to the DMX buffer manager", message_type::gimmeback,
+		MIN_FUNCTION
+		{
+			const auto obj = reinterpret_cast<max::t_object*>(&_dmx_buffer_manager);
+
+			return { obj };
+		}
+	};
+
 	message<> get_global_preferences {
 		this, "get_global_preferences", "Gets a dictionary containing the global preferences", message_type::gimmeback,
 		MIN_FUNCTION
@@ -548,6 +565,111 @@ public:
 		}
 	};
 
+	message<> get_output_stats {
+		this, "get_output_stats", "Gets a dictionary containing the DMX output service counters", message_type::gimmeback,
+		MIN_FUNCTION
+		{
+			const lxmax::dmx_output_stats stats = _dmx_output_service->get_stats();
+
+			const dict output_stats(symbol(true));
+
+			output_stats["frames_sent"] = static_cast<max::t_atom_long>(stats.frames_sent);
+			output_stats["packets_sent"] = static_cast<max::t_atom_long>(stats.packets_sent);
+			output_stats["packets_deferred"] = static_cast<max::t_atom_long>(stats.packets_deferred);
+			output_stats["pacing_overruns"] = static_cast<max::t_atom_long>(stats.pacing_overruns);
+			output_stats["send_errors"] = static_cast<max::t_atom_long>(stats.send_errors);
+			output_stats["wakeups"] = static_cast<max::t_atom_long>(stats.wakeups);
+
+			// Only recorded in builds with lock stats enabled
+			const auto lock_stats = lxmax::get_all_lock_stats();
+
+			if (!lock_stats.empty())
+			{
+				const auto histogram_to_atoms = [](const lxmax::lock_histogram& histogram)
+				{
+					atoms a;
+					for (const auto count : histogram)
+						a.push_back(static_cast<max::t_atom_long>(count));
+
+					return a;
+				};
+
+				dict locks;
+
+				for (const auto& s : lock_stats)
+				{
+					dict lock;
+					lock["acquisitions"] = static_cast<max::t_atom_long>(s.acquisitions);
+					lock["contended_acquisitions"] = static_cast<max::t_atom_long>(s.contended_acquisitions);
+					lock["wait_nanoseconds"] = static_cast<max::t_atom_long>(s.wait_nanoseconds);
+					lock["hold_nanoseconds"] = static_cast<max::t_atom_long>(s.hold_nanoseconds);
+					lock["wait_histogram"] = histogram_to_atoms(s.wait_histogram);
+					lock["hold_histogram"] = histogram_to_atoms(s.hold_histogram);
+
+					max::dictionary_appenddictionary(locks, symbol(s.name), lock);
+				}
+
+				max::dictionary_appenddictionary(output_stats, symbol("locks"), locks);
+			}
+
+			max::t_dictionary* d = output_stats;
+
+			return { d };
+		}
+	};
+
+	message<> trace_dump {
+		this, "trace_dump", "Writes recorded frame timeline events to a Chrome trace JSON file, in the preferences folder unless a path is given",
+		MIN_FUNCTION
+		{
+#ifdef LXMAX_ENABLE_TRACING
+			const std::string path = args.empty() ? get_preference_path(k_trace_filename) : std::string(args[0]);
+
+			std::ofstream stream(path);
+			const size_t event_count = lxmax::trace_dump(stream);
+			stream.flush();
+
+			if (stream.good())
+				Poco::Logger::root().information("Wrote %z trace events to '%s'", event_count, path);
+			else
+				Poco::Logger::root().error("Failed to write trace events to '%s'", path);
+#else
+			Poco::Logger::root().warning("Tracing is not enabled in this build of LXMax");
+#endif
+
+			return { };
+		}
+	};
+
+	message<> get_artnet_nodes {
+		this, "get_artnet_nodes", "Gets a dictionary containing the Art-Net nodes found by discovery", message_type::gimmeback,
+		MIN_FUNCTION
+		{
+			const dict artnet_nodes(symbol(true));
+
+			int index = 0;
+			for (const auto& entry : _dmx_output_service->get_artnet_nodes())
+			{
+				atoms universes;
+				for (const auto u : entry.second.output_universes)
+					universes.push_back(u);
+
+				dict node;
+				node["address"] = entry.second.address.toString();
+				node["bind_index"] = entry.second.bind_index;
+				node["short_name"] = entry.second.short_name;
+				node["long_name"] = entry.second.long_name;
+				node["output_universes"] = universes;
+
+				max::dictionary_appenddictionary(artnet_nodes, symbol(index++), node);
+			}
+
+			max::t_dictionary* d = artnet_nodes;
+
+			return { d };
+		}
+	};
+
 	message<> notify {
 		this, "notify",
 		MIN_FUNCTION
@@ -11,6 +11,7 @@
 namespace lxmax
 {
 	class fixture_manager;
+	class dmx_buffer_manager;
 }
 
 const c74::min::symbol k_lxmax_service_registration { "___lxmax_service" };
@@ -73,4 +74,20 @@ inline std::shared_ptr<lxmax::fixture_manager> get_fixture_manager(c74::min::obj
 	}
 
 	return *fixture_manager_ptr;
-}
\ No newline at end of file
+}
+
+inline std::shared_ptr<lxmax::dmx_buffer_manager> get_dmx_buffer_manager(c74::min::object_base& x, c74::min::instance& lxmax_service)
+{
+	assert(lxmax_service);
+
+	void* value = lxmax_service(c74::min::symbol("get_dmx_buffer_manager"), 0);
+
+	std::shared_ptr<lxmax::dmx_buffer_manager>* buffer_manager_ptr = static_cast<std::shared_ptr<lxmax::dmx_buffer_manager>*>(value);
+	if (buffer_manager_ptr == nullptr)
+	{
+		assert(false);
+		c74::max::object_error(x,"Failed to get reference to LXMax DMX buffer manager. Please delete the LXMax package and reinstall.");
+	}
+
+	return *buffer_manager_ptr;
+}